@@ -0,0 +1,110 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+// Este header no incluye raylib.h: asset_pack.cpp necesita <windows.h> en Windows
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Archivo mapeado en memoria de solo lectura (mmap / MapViewOfFile)
+class MappedFile {
+private:
+    const unsigned char* data;
+    size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return data != nullptr; }
+    const unsigned char* GetData() const { return data; }
+    size_t GetSize() const { return size; }
+};
+
+// Recurso dentro del pack: apunta directamente a las páginas mapeadas
+struct PackEntry {
+    const unsigned char* data;
+    size_t size;
+    const char* fileType;   // ".png", ".ogg", ".wav"...
+};
+
+// Recursos por nombre: carpeta de archivos sueltos, prefijo de su clave en el
+// pack y extensiones en orden de fallback (nullptr de relleno). La misma tabla
+// la usan ResourceManager, nxpack y nxcheck.
+struct AssetFolder {
+    const char* folder;
+    const char* keyPrefix;
+    const char* extensions[2];
+};
+
+extern const AssetFolder BACKGROUND_ASSETS;
+extern const AssetFolder CG_ASSETS;
+extern const AssetFolder MUSIC_ASSETS;
+extern const AssetFolder SOUND_ASSETS;
+extern const AssetFolder GUI_ASSETS;
+extern const AssetFolder VOICE_ASSETS;   // Con subcarpetas <idioma>/<capítulo>/
+
+struct PackTocEntry;
+
+// Pack de recursos (resources.pak)
+//
+// Formato (little-endian):
+//   cabecera (32 bytes) | tabla de contenidos ordenada por clave (32 bytes/entrada)
+//   | claves | datos (alineados a 16 bytes)
+//
+// Claves lógicas: bg_<nombre>, cg_<nombre>, music_<nombre>, sfx_<nombre>, gui_<nombre>,
+// <personaje>/<emocion>, atlas_<pagina>, atlas/<indice>, font/<archivo>,
+// dialogue/<idioma>/<archivo>
+class AssetPack {
+private:
+    MappedFile file;
+    const PackTocEntry* toc;
+    uint32_t entryCount;
+    const char* keys;
+
+public:
+    static const uint32_t VERSION = 1;
+
+    AssetPack();
+    ~AssetPack();
+
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return file.IsOpen(); }
+
+    // Búsqueda binaria sobre la tabla de contenidos
+    bool Find(std::string_view key, PackEntry& out) const;
+    size_t GetEntryCount() const { return entryCount; }
+};
+
+// Generador de packs (herramienta nxpack)
+class AssetPackWriter {
+private:
+    struct PendingEntry {
+        std::string key;
+        std::string fileType;
+        std::string sourcePath;
+    };
+    std::vector<PendingEntry> entries;
+
+public:
+    bool Add(const std::string& key, const std::string& sourcePath);
+    bool Write(const std::string& path);
+    size_t GetEntryCount() const { return entries.size(); }
+};
+
+#endif // ASSET_PACK_H
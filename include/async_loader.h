@@ -0,0 +1,97 @@
+#ifndef ASYNC_LOADER_H
+#define ASYNC_LOADER_H
+
+#include "raylib.h"
+#include "string_interner.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+
+enum class AssetKind {
+    TEXTURE,
+    SOUND,
+    MUSIC
+};
+
+enum class AssetState {
+    PENDING,     // En cola o decodificándose en un worker
+    DECODED,     // Datos en CPU, esperando subida en el hilo principal
+    READY,       // Recurso disponible en el ResourceManager
+    FAILED,      // Archivo no encontrado o no decodificable
+    CANCELLED
+};
+
+// Petición de carga asíncrona. Los workers solo tocan image/wave/path;
+// texture/sound/music se rellenan en el hilo principal al pasar a READY.
+struct AssetRequest {
+    Symbol key;                           // Clave de caché en el ResourceManager
+    AssetKind kind;
+    std::vector<std::string> candidates;  // Rutas a probar en orden (.ogg/.mp3, .wav/.ogg)
+    std::string path;                     // Ruta resuelta por el worker
+    
+    // Si el recurso está en el pack se decodifica desde las páginas mapeadas
+    const unsigned char* packData;
+    size_t packSize;
+    std::string fileType;
+    std::atomic<AssetState> state;
+    size_t sizeBytes;
+    int interested;                       // Peticiones sin cancelar (solo hilo principal)
+
+    Image image;
+    Wave wave;
+
+    Texture2D texture;
+    Sound sound;
+    Music music;
+
+    AssetRequest(Symbol assetKey, AssetKind assetKind);
+
+    bool IsReady() const { return state.load() == AssetState::READY; }
+    bool IsDone() const;
+};
+
+using AssetHandle = std::shared_ptr<AssetRequest>;
+
+// Pool de hilos que resuelve rutas, lee y decodifica (LoadImage/LoadWave)
+// fuera del hilo de render. Las subidas a GPU/audio las hace el ResourceManager.
+class AsyncLoader {
+private:
+    std::vector<std::thread> workers;
+    std::deque<AssetHandle> decodeQueue;
+    std::deque<AssetHandle> uploadQueue;
+    std::deque<std::function<void()>> jobQueue;   // Van detrás de las decodificaciones
+    std::mutex decodeMutex;
+    std::mutex uploadMutex;
+    std::condition_variable decodeCondition;
+    bool stopping;
+
+    void WorkerLoop();
+
+public:
+    AsyncLoader();
+    ~AsyncLoader();
+
+    void Start(int threadCount = 0);   // 0: núcleos disponibles - 1
+    void Stop();
+    bool IsRunning() const { return !workers.empty(); }
+
+    void Submit(const AssetHandle& request);
+    bool PopDecoded(AssetHandle& request);
+
+    // Trabajo de CPU para un worker (compilar un capítulo, leer un archivo).
+    // Lo que no haya empezado al llamar a Stop se descarta sin ejecutar.
+    void SubmitJob(std::function<void()> job);
+
+    // Resuelve la ruta y decodifica en CPU (PENDING -> DECODED/FAILED)
+    static void Decode(AssetRequest& request);
+    // Libera los datos de CPU de una petición que no llegó a subirse
+    static void ReleaseDecoded(AssetRequest& request);
+};
+
+#endif // ASYNC_LOADER_H
@@ -0,0 +1,68 @@
+#ifndef BRANCH_PREFETCHER_H
+#define BRANCH_PREFETCHER_H
+
+#include "script_bytecode.h"
+#include "async_loader.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+
+class DialogueParser;
+class DialogueSystem;
+
+// Prepara los destinos de la próxima salida del capítulo (@jump o menú de
+// @choice) antes de llegar a ella: los capítulos de destino se leen y
+// compilan en los workers del cargador y se piden los recursos de las
+// primeras líneas de cada destino. Al elegir una opción el capítulo ya está
+// en memoria.
+class BranchPrefetcher {
+private:
+    struct PreparedChapter {
+        std::string fileName;           // "ch1.txt"
+        std::string path;               // Ruta completa (historial de lectura)
+        std::vector<Symbol> labels;     // Destinos dentro de él (NO_SYMBOL: inicio)
+        ScriptChapter chapter;          // Lo escribe el worker hasta que parsed está listo
+        std::future<bool> parsed;
+        bool loaded;
+        bool scanned;                   // Recursos de sus destinos ya pedidos
+    };
+
+    size_t lookahead;
+    uint32_t preparedGeneration;        // Capítulo del DialogueSystem ya preparado
+    size_t preparedExit;                // y su salida
+    // El trabajo de compilación tiene su propia referencia: uno descartado
+    // a medias se libera al terminar
+    std::vector<std::shared_ptr<PreparedChapter>> chapters;
+    std::vector<AssetHandle> requests;
+
+    void Prepare(const ScriptChapter& chapter, const ScriptExit& exit);
+    PreparedChapter* FindOrStart(const std::string& fileName,
+                                 std::vector<std::shared_ptr<PreparedChapter>>& previous);
+    void RequestLines(const ScriptChapter& chapter, size_t firstLine);
+    void CancelRequests();
+
+    static bool IsParsed(const PreparedChapter& prepared);
+    static void Collect(PreparedChapter& prepared);   // Espera si aún compila
+
+public:
+    static const size_t TARGET_LINES = 4;   // Líneas de cada destino cuyos recursos se piden
+
+    BranchPrefetcher(size_t lines = 8);
+    ~BranchPrefetcher();
+
+    void SetLookahead(size_t lines) { lookahead = lines; }
+
+    // Llamar cada frame: prepara la próxima salida si está a menos de
+    // lookahead líneas y pide los recursos de lo que ya terminó de compilar
+    void Update(const DialogueSystem& dialogue);
+
+    // Carga el capítulo de destino (el preparado si lo hay, si no del disco)
+    // y entra en la etiqueta. false si no se pudo abrir el capítulo.
+    bool Enter(const std::string& fileName, Symbol label, DialogueParser& parser,
+               DialogueSystem& dialogue);
+
+    void Reset();
+};
+
+#endif // BRANCH_PREFETCHER_H
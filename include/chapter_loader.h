@@ -0,0 +1,64 @@
+#ifndef CHAPTER_LOADER_H
+#define CHAPTER_LOADER_H
+
+#include "chapter_manifest.h"
+#include "async_loader.h"
+#include "scene_manager.h"
+#include <string>
+#include <vector>
+
+class DialogueParser;
+class DialogueSystem;
+
+// Fase de carga de un capítulo (splash y cambios de capítulo): abre el
+// capítulo, pide en paralelo todos los recursos de su manifiesto y va
+// subiéndolos cada frame. El progreso es el trabajo real hecho, no tiempo.
+//
+// Lo que se ve al terminar (la escena guardada y las primeras líneas) se
+// pide primero y queda fijado hasta el final: si el manifiesto no cabe en
+// el presupuesto de la caché, lo que se expulsa es el resto.
+class ChapterLoader {
+private:
+    ChapterManifest manifest;
+    std::vector<AssetHandle> requests;
+    std::vector<Symbol> pinnedKeys;     // PinGroup::LOADING mientras carga
+    size_t completedRequests;
+    size_t failedRequests;
+    bool loading;
+    size_t savedUploadBudget;
+
+    // Del pack, del .manifest junto al script o, si no hay, del bytecode ya compilado
+    void LoadManifest(const std::string& fileName, const ScriptChapter& chapter);
+    void RequestPinned(const AssetHandle& request);
+    void RequestLines(const ScriptChapter& chapter, size_t firstLine);
+    void Finish();
+
+public:
+    // Sin nada que dibujar detrás de la barra se sube más por frame
+    static const size_t LOADING_UPLOAD_BUDGET = 64 * 1024 * 1024;
+    static const size_t FIRST_LINES = 4;   // Líneas desde la de entrada cuyos recursos se fijan
+
+    ChapterLoader();
+    ~ChapterLoader();
+
+    // Carga el capítulo en el DialogueSystem y empieza a pedir sus recursos.
+    // Con scene (partida guardada) se piden primero los de esa escena y los
+    // de las líneas desde firstLine. false si el capítulo no se pudo abrir
+    // (no queda nada cargando).
+    bool Begin(const std::string& fileName, DialogueParser& parser, DialogueSystem& dialogue,
+               const SceneState* scene = nullptr, size_t firstLine = 0);
+
+    // Llamar una vez por frame mientras IsLoading()
+    void Update();
+
+    bool IsLoading() const { return loading; }
+    float GetProgress() const;
+    size_t GetFailedCount() const { return failedRequests; }
+
+    // Existe el capítulo en el idioma actual (texto, bytecode o pack)
+    static bool ChapterExists(const std::string& fileName);
+    // ch0.txt -> ch1.txt ("" si el nombre no lleva número)
+    static std::string GetNextChapterName(const std::string& fileName);
+};
+
+#endif // CHAPTER_LOADER_H
@@ -0,0 +1,55 @@
+#ifndef CHAPTER_MANIFEST_H
+#define CHAPTER_MANIFEST_H
+
+#include "script_bytecode.h"
+#include "string_interner.h"
+#include <string>
+#include <vector>
+#include <set>
+#include <tuple>
+
+enum class ManifestAsset {
+    BACKGROUND,
+    MUSIC,
+    SOUND,
+    SPRITE
+};
+
+struct ManifestEntry {
+    ManifestAsset type;
+    Symbol name;       // Fondo, pista, sonido o personaje
+    Symbol emotion;    // Solo SPRITE
+};
+
+// Recursos que necesita un capítulo, en orden de primer uso. Lo genera nxbc
+// a partir del script (ch0.txt -> ch0.manifest) y la pantalla de carga lo
+// pide entero antes de mostrar la primera línea.
+//
+// Formato texto, una entrada por línea ('#' comenta):
+//   bg <fondo> | music <pista> | sfx <sonido> | sprite <personaje> <emocion>
+class ChapterManifest {
+private:
+    std::vector<ManifestEntry> entries;
+    std::set<std::tuple<int, Symbol, Symbol>> seen;
+
+    void Add(ManifestAsset type, Symbol name, Symbol emotion = NO_SYMBOL);
+
+public:
+    void Clear();
+
+    // Recorre el bytecode compilado (sin ejecutar nada)
+    void CollectFrom(const ScriptChapter& chapter);
+
+    bool LoadFromText(const char* text, size_t size);
+    bool LoadFromFile(const std::string& path);
+    bool SaveToFile(const std::string& path) const;
+
+    const std::vector<ManifestEntry>& GetEntries() const { return entries; }
+    size_t Size() const { return entries.size(); }
+    bool Empty() const { return entries.empty(); }
+
+    // ch0.txt -> ch0.manifest
+    static std::string GetManifestPath(const std::string& scriptPath);
+};
+
+#endif // CHAPTER_MANIFEST_H
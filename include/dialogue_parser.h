@@ -3,43 +3,74 @@
 
 #include "dialogue_system.h"
 #include "scene_manager.h"
+#include "script_bytecode.h"
 #include <string>
-#include <vector>
+#include <string_view>
+
+struct PackEntry;
 
 enum class CommandType {
     NONE,
     BACKGROUND,    // @bg
     MUSIC,        // @music
     SFX,          // @sfx
+    LABEL,        // @label nombre
+    JUMP,         // @jump destino
+    CHOICE,       // @choice "texto" -> destino
     CHARACTER,    // Nombre emocion posicion
     DIALOGUE,     // Nombre: "texto"
     NARRATION,    // "texto" sin nombre
     COMMENT       // # comentario
 };
 
+// Los valores son vistas sobre la línea parseada (válidos mientras ella lo sea)
 struct ParsedCommand {
     CommandType type;
-    std::string value1;  // nombre personaje, comando, etc
-    std::string value2;  // emocion, texto, etc
-    std::string value3;  // posicion, etc
+    std::string_view value1;  // nombre personaje, comando, etc
+    std::string_view value2;  // emocion, texto, etc
+    std::string_view value3;  // posicion, etc
 };
 
+// Destinos de @jump y @choice: "etiqueta", "ch1.txt" o "ch1.txt:etiqueta".
+// En los comandos parseados el capítulo y la etiqueta van por separado:
+//   JUMP:   value1 = capítulo, value2 = etiqueta
+//   CHOICE: value1 = texto, value2 = capítulo, value3 = etiqueta
+
 class DialogueParser {
 private:
     SceneManager* sceneManager;
     
-    std::string Trim(const std::string& str);
-    std::vector<std::string> Split(const std::string& str, char delimiter);
-    ParsedCommand ParseLine(const std::string& line);
-    CharacterPosition ParsePosition(const std::string& pos);
+    static std::string_view Trim(std::string_view str);
+    static bool EqualsIgnoreCase(std::string_view str, const char* lower);
+    CharacterPosition ParsePosition(std::string_view pos);
+    static bool LoadCompiledChapter(const std::string& path, const PackEntry* packed,
+                                    ScriptChapter& chapter);
 
 public:
     DialogueParser(SceneManager* scene);
     ~DialogueParser();
     
-    // Cargar archivo de diálogo
+    // Cargar archivo de diálogo (usa el .nxb precompilado si está al día)
     bool LoadDialogueFile(const std::string& fileName, DialogueSystem& dialogue);
     
+    // Compilar un script de texto a bytecode (también lo usa la herramienta nxbc)
+    bool CompileDialogueFile(const std::string& path, ScriptChapter& chapter);
+    // Compila una línea de texto (sin copiarla) al final del capítulo
+    void CompileLine(std::string_view line, ScriptChapter& chapter);
+    
+    // Capítulo entero sin tocar el ResourceManager (bytecode del pack, .nxb
+    // al día o compilado del texto): path y packed se resuelven antes en el
+    // hilo principal y esto puede ir en otro hilo
+    bool ReadChapter(const std::string& path, const PackEntry* packed, ScriptChapter& chapter);
+    
+    // Parsear una línea sin compilarla (también la usa el validador nxcheck)
+    ParsedCommand ParseLine(std::string_view line);
+    // false si la posición no es ninguna de las conocidas (se usa el centro)
+    static bool TryParsePosition(std::string_view pos, CharacterPosition& out);
+    // false si el destino está vacío
+    static bool SplitBranchTarget(std::string_view target, std::string_view& chapter,
+                                  std::string_view& label);
+    
     // Ejecutar comando inmediatamente (para comandos @)
     void ExecuteCommand(const ParsedCommand& cmd);
 };
@@ -2,10 +2,19 @@
 #define DIALOGUE_SYSTEM_H
 
 #include "raylib.h"
+#include "script_bytecode.h"
+#include "script_prefetcher.h"
+#include "scene_timeline.h"
+#include "read_history.h"
+#include "text_layout.h"
+#include "glyph_cache.h"
 #include <string>
 #include <vector>
 #include <memory>
 
+class SceneManager;
+class ScriptStream;
+
 struct DialogueLine {
     std::string character;
     std::string text;
@@ -15,16 +24,81 @@ struct DialogueLine {
 
 class DialogueSystem {
 private:
-    std::vector<DialogueLine> dialogueLines;
+    // Escena desde la que se reconstruye un tramo leído en orden
+    struct SceneEntry {
+        size_t line;                // Primera línea del tramo (NO_LINE: el capítulo desde el principio)
+        SceneState scene;           // La que había antes de los comandos de line...
+        bool applied;               // ...o ya con ellos (partida cargada)
+    };
+    
+    struct BranchStep {
+        size_t origin;
+        SceneEntry target;          // Destino del salto con la escena real al saltar
+    };
+    
+    ScriptChapter chapter;          // Bytecode del capítulo actual
+    std::unique_ptr<ScriptStream> stream;   // Texto aún sin compilar (null si ya está entero)
+    ScriptInstruction currentLine;  // SAY decodificado de la línea actual
     size_t currentLineIndex;
+    SceneManager* sceneManager;
+    SceneTimeline timeline;         // Checkpoints de escena para rebobinar/saltar
+    size_t sceneLine;               // Línea cuyo estado muestra la escena (NO_LINE: ninguna)
+    
+    // Líneas leídas: del historial persistente o, sin nombre de capítulo, solo de esta sesión
+    ReadHistory* readHistory;
+    LineBitset sessionReadLines;
+    LineBitset* readLines;
+    ScriptPrefetcher prefetcher;    // Carga anticipada de las próximas líneas
     bool isDisplaying;
-    float textRevealSpeed;
-    std::string displayedText;
+    float textRevealSpeed;          // Codepoints por segundo
+    size_t lineLength;              // Codepoints del texto de la línea actual
+    size_t revealedCount;           // Codepoints ya visibles (efecto máquina de escribir)
     float displayTimer;
+    bool dirty;                     // Cambió algo visible desde el último render
+    uint32_t chapterGeneration;     // Cambia con cada capítulo cargado
     
-    Font dialogueFont;
-    Font nameFont;
+    // Saltos y menús de opciones (tabla de saltos del capítulo)
+    bool choosing;                  // Menú de opciones en pantalla
+    int selectedChoice;
+    bool enteringBranch;            // La línea llega por un salto: sus comandos se aplican como al avanzar
+    std::vector<BranchStep> branchTrail;   // Para retroceder y reconstruir por el camino seguido
+    SceneEntry sceneBase;           // Entrada sin saltos detrás (JumpToLabel)
+    bool hasChapterBranch;          // Salto a otro capítulo pendiente (lo carga main)
+    Symbol branchChapter;
+    Symbol branchLabel;
+    Symbol choiceIdleKey;
+    Symbol choiceHoverKey;
+    
+    // Una sola fuente (del ResourceManager) rasterizada en los dos tamaños
+    GlyphCache* fontCache;
+    uint32_t fontGeneration;
     bool customFontsLoaded;
+    TextLayoutCache layoutCache;    // Word wrap por línea (fuente, tamaño, ancho)
+    
+    static const int TEXT_FONT_SIZE = 24;
+    static const int NAME_FONT_SIZE = 28;
+    static const int DIALOGUE_BOX_HEIGHT = 200;
+    static const int CHOICE_HEIGHT = 52;      // Alto de choice_*_background.png
+    static const int CHOICE_MAX_WIDTH = 1185;
+    static const int CHOICE_SPACING = 16;
+    
+    static const size_t NO_LINE = (size_t)-1;
+    
+    void BeginLine();
+    void RestoreScene(size_t line);
+    void BuildScene(size_t line, SceneState& out);   // Por el camino seguido hasta line
+    void RunTail();
+    void MarkCurrentRead();
+    void PrefillGlyphs(size_t fromOffset = 0);
+    void EnsureLines(size_t count);   // Compila del stream hasta tener count líneas
+    void ExecuteSceneCommand(const ScriptInstruction& inst);
+    void ResetLineState();
+    void OpenChoice();
+    void FollowBranch(ScriptBranch branch);
+    void EnterLine(size_t line);    // Destino de un salto: la escena sigue desde la actual
+    void CaptureEntry(size_t line, SceneEntry& entry);
+    uint32_t ResolveLocalBranch(const ScriptBranch& branch);   // Compila del stream si hace falta
+    Rectangle GetChoiceBounds(size_t index, int screenWidth, int screenHeight) const;
 
 public:
     DialogueSystem();
@@ -32,25 +106,63 @@ public:
     
     void LoadFonts(const std::string& fontName);
     
+    // Escena sobre la que se aplican los @bg/@music/@sfx y personajes de cada línea
+    void SetSceneManager(SceneManager* scene) { sceneManager = scene; }
+    void SetReadHistory(ReadHistory* history) { readHistory = history; }
+    
     void AddLine(const std::string& character, const std::string& text, 
                  const std::string& emotion = "neutral", Color color = WHITE);
     void AddLines(const std::vector<DialogueLine>& lines);
+    void LoadChapter(ScriptChapter&& compiled, const std::string& chapterName = "");
+    // Capítulo compilado por tramos por delante de la línea actual
+    void LoadChapter(std::unique_ptr<ScriptStream> source, const std::string& chapterName = "");
     
     void Update(float deltaTime);
     void Render(int screenWidth, int screenHeight);
     
     void NextLine();
     void PreviousLine();
+    void JumpToLine(size_t line);   // Reconstruye la escena de esa línea
+    // Partida cargada: scene (ya puesta en el SceneManager) es la de la
+    // línea; no se reconstruye ni se vuelven a ejecutar sus comandos
+    void ResumeAt(size_t line, const SceneState& scene);
+    // Entra en la etiqueta como por un @jump (false si no existe)
+    bool JumpToLabel(Symbol label);
+    
+    // Menú de opciones: se abre al terminar de revelarse la línea que lo lleva
+    bool IsChoosing() const { return choosing; }
+    size_t GetChoiceCount() const;
+    int GetSelectedChoice() const { return selectedChoice; }
+    void SetSelectedChoice(int index);
+    int GetChoiceAt(Vector2 point, int screenWidth, int screenHeight) const;   // -1 si ninguna
+    void Choose(size_t index);
+    
+    // Salto a otro capítulo elegido o alcanzado: lo recoge main una vez
+    bool TakeChapterBranch(std::string& chapterName, Symbol& label);
+    
+    // Avance rápido: salta de una vez a la primera línea no leída sin
+    // renderizar ni cargar las intermedias. Sigue los saltos y se para en los
+    // menús de opciones. false si la actual no está leída.
+    bool SkipReadLines();
+    bool IsLineRead(size_t line) const { return readLines->Test(line); }
     void SkipToEnd();
     
     bool IsFinished() const;
     bool IsLineFinished() const;
     
+    // Texto revelándose o línea nueva (el indicador de continuar no cuenta)
+    bool IsDirty() const { return dirty; }
+    void ClearDirty() { dirty = false; }
+    
     void Clear();
     void SetTextSpeed(float speed) { textRevealSpeed = speed; }
+    void SetPrefetchDistance(size_t lines) { prefetcher.SetLookahead(lines); }
     
-    size_t GetTotalLines() const { return dialogueLines.size(); }
+    size_t GetTotalLines() const { return chapter.GetLineCount(); }   // Compiladas hasta ahora
+    bool IsStreaming() const { return stream != nullptr; }
     size_t GetCurrentLineIndex() const { return currentLineIndex; }
+    const ScriptChapter& GetChapter() const { return chapter; }
+    uint32_t GetChapterGeneration() const { return chapterGeneration; }
 };
 
 #endif // DIALOGUE_SYSTEM_H
\ No newline at end of file
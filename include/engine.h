@@ -11,6 +11,15 @@ private:
     std::string gameTitle;
     bool isRunning;
     bool isFullscreen;
+    
+    // Modo reposo: con la pantalla estática se baja a idleFPS. No se deja de
+    // dibujar (el doble buffer necesita un frame completo en cada swap). La
+    // música no depende de este ritmo: la rellena el hilo del MusicPlayer.
+    int targetFPS;
+    int idleFPS;          // 0: sin modo reposo
+    float idleDelay;      // Segundos sin cambios antes de entrar en reposo
+    float quietTime;
+    bool isIdle;
 
 public:
     Engine(int width = 1280, int height = 720, const std::string& title = "PotatoCake - DDLC Engine", bool fullscreen = false);
@@ -25,6 +34,11 @@ public:
     void SetRunning(bool running);
     void SetFullscreen(bool fullscreen);
     
+    // Una vez por frame: changed indica si algo visible cambió o hubo entrada
+    void UpdateIdleState(bool changed, float deltaTime);
+    void SetIdleFPS(int fps);
+    bool IsIdle() const { return isIdle; }
+    
     int GetScreenWidth() const { return screenWidth; }
     int GetScreenHeight() const { return screenHeight; }
     bool IsFullscreen() const { return isFullscreen; }
@@ -0,0 +1,75 @@
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include "raylib.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+
+// Caché dinámica de glifos de una fuente TTF/OTF
+//
+// El archivo de la fuente se lee una sola vez; cada tamaño tiene su propio
+// atlas que se rasteriza bajo demanda (codepoints nuevos se añaden por lotes)
+// y crece en altura hasta MAX_ATLAS_HEIGHT.
+class GlyphCache {
+private:
+    struct Face {
+        int fontSize;
+        std::vector<GlyphInfo> glyphs;
+        std::vector<Rectangle> recs;
+        std::unordered_map<int, int> glyphIndex;   // codepoint -> índice en glyphs
+        std::vector<int> pending;                  // Codepoints por rasterizar
+
+        Image atlas;          // Copia en CPU (GRAY_ALPHA) para añadir glifos
+        Texture2D texture;
+        int shelfX;
+        int shelfY;
+        int shelfHeight;
+    };
+
+    const unsigned char* fontData;   // Páginas del pack o ownedData
+    int fontDataSize;
+    unsigned char* ownedData;
+    std::vector<std::unique_ptr<Face>> faces;
+    uint32_t generation;
+
+    Face& GetFace(int fontSize);
+    void RequestCodepoint(Face& face, int codepoint);
+    void Rasterize(Face& face);
+    bool PlaceGlyph(Face& face, const Image& glyph, Rectangle& rec);
+
+public:
+    static const int ATLAS_WIDTH = 1024;
+    static const int MAX_ATLAS_HEIGHT = 4096;
+    static const int GLYPH_PADDING = 2;
+
+    GlyphCache();
+    ~GlyphCache();
+
+    GlyphCache(const GlyphCache&) = delete;
+    GlyphCache& operator=(const GlyphCache&) = delete;
+
+    // Sin copia: data debe seguir válido mientras viva la caché (pack mapeado)
+    bool LoadFromMemory(const unsigned char* data, int dataSize);
+    bool LoadFromFile(const std::string& path);
+    void Unload();
+    bool IsLoaded() const { return fontData != nullptr; }
+
+    // Encola los codepoints de text que falten en ese tamaño; Flush los
+    // rasteriza en un solo lote por tamaño y sube cada atlas una vez
+    void Request(std::string_view text, int fontSize);
+    void Flush();
+    void Prefill(std::string_view text, int fontSize);
+
+    // Font de raylib sobre la caché. Válido hasta el próximo Flush.
+    Font GetFont(int fontSize);
+
+    // Cambia al añadir glifos o recrear un atlas (para invalidar layouts)
+    uint32_t GetGeneration() const { return generation; }
+    size_t GetGlyphCount(int fontSize);
+};
+
+#endif // GLYPH_CACHE_H
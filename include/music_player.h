@@ -0,0 +1,112 @@
+#ifndef MUSIC_PLAYER_H
+#define MUSIC_PLAYER_H
+
+#include "raylib.h"
+#include "string_interner.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+struct MusicStats {
+    uint64_t refills;     // Pasadas del hilo con alguna pista sonando
+    uint64_t underruns;   // Pasadas tardías: lo decodificado por delante pudo agotarse
+    float maxGapMs;       // Mayor hueco entre dos pasadas
+    float bufferMs;       // Audio decodificado por delante de lo que suena
+};
+
+// Música en su propio hilo
+//
+// UpdateMusicStream decodifica y rellena los sub-buffers del stream. Llamado
+// desde el bucle de render, un frame largo (una textura cargada en síncrono
+// con @bg) los dejaba vaciarse y la música se cortaba. Aquí lo llama un hilo
+// cada UPDATE_INTERVAL_MS sobre sub-buffers de BUFFER_FRAMES (~190 ms a
+// 44.1 kHz), así que los parones del hilo principal no llegan al audio.
+//
+// Dos pistas a la vez para los fundidos cruzados: la que entra sube mientras
+// la anterior baja y se detiene al llegar a cero. Las pistas pertenecen al
+// ResourceManager; quien llama mantiene fijadas las de CollectTracks para
+// que no se expulsen mientras suenan.
+//
+// Un tercer stream para la voz de la línea (VoicePlayer, que es su dueño):
+// mientras suena, la música baja a duckLevel y vuelve al terminar.
+class MusicPlayer {
+private:
+    struct Track {
+        Music music;
+        Symbol name;
+        float gain;         // 0..1 sobre el volumen general
+        float target;       // 1: entrando o sonando, 0: saliendo
+        float fadeSpeed;    // Ganancia por segundo
+        bool active;
+    };
+
+    Track tracks[2];
+    int primary;                    // La pista actual; la otra es la que sale
+    float volume;
+
+    Music voice;
+    bool voiceActive;
+    float voiceVolume;
+    float duck;                     // Multiplicador de la música por la voz
+    float duckTarget;
+    float duckLevel;
+
+    std::thread worker;
+    mutable std::mutex mutex;       // Toda llamada a raylib sobre las pistas va con él
+    std::condition_variable wake;
+    bool stopping;
+    std::atomic<uint32_t> trackRevision;   // Sube al soltar una pista
+    std::atomic<bool> voicePlaying;
+
+    std::atomic<uint64_t> refills;
+    std::atomic<uint64_t> underruns;
+    std::atomic<uint32_t> maxGapMicros;
+    std::atomic<uint32_t> bufferMicros;
+
+    void WorkerLoop();
+    void Refill(float elapsed);
+    void StartFade(Track& track, float target, float seconds);
+    void ApplyVolume(Track& track);
+    void Release(Track& track);
+
+public:
+    static const int BUFFER_FRAMES = 8192;      // Por sub-buffer (el stream tiene dos)
+    static const int UPDATE_INTERVAL_MS = 10;
+    static const int DUCK_FADE_MS = 150;
+
+    MusicPlayer();
+    ~MusicPlayer();
+
+    // Para el hilo y detiene las pistas: llamar antes de liberar la música
+    // del ResourceManager y de cerrar el dispositivo de audio
+    void Shutdown();
+
+    // Empieza music (ya cargada) en start segundos; la que sonaba sale en
+    // fadeSeconds (0: corte). Si name ya suena o está saliendo, sigue por
+    // donde iba en vez de empezar de nuevo.
+    void Play(Music music, Symbol name, bool loop, float fadeSeconds, float start = 0.0f);
+    void Stop(float fadeSeconds);
+    void SetVolume(float newVolume);
+
+    // Voz: clip abierto por quien llama, que no lo libera hasta StopVoice.
+    // Sustituye a la que sonara; al acabar se suelta sola.
+    void PlayVoice(Music clip);
+    void StopVoice();
+    bool IsVoicePlaying() const { return voicePlaying.load(); }
+    void SetVoiceVolume(float newVolume);
+    void SetDuckLevel(float level);   // Volumen relativo de la música bajo la voz (1: sin bajar)
+
+    float GetPosition() const;      // Segundos de la pista actual (-1 si no suena nada)
+    bool IsCrossfading() const;
+
+    // Pistas que el hilo sigue usando (la actual y la que sale)
+    void CollectTracks(std::vector<Symbol>& names) const;
+    uint32_t GetTrackRevision() const { return trackRevision.load(); }
+
+    MusicStats GetStats() const;
+};
+
+#endif // MUSIC_PLAYER_H
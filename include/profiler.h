@@ -0,0 +1,150 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Compilar con -DNIRYX_PROFILE=0 para eliminar las zonas del binario
+#ifndef NIRYX_PROFILE
+#define NIRYX_PROFILE 1
+#endif
+
+// Zona medida (tiempos en ns desde que se creó el profiler)
+struct ProfileEvent {
+    const char* name;   // Literal: solo se guarda el puntero
+    uint64_t start;
+    uint64_t end;
+    uint32_t depth;     // Anidamiento dentro del hilo (0 = etapa del frame)
+};
+
+// Profiler jerárquico de CPU
+//
+// Cada hilo escribe en su propio buffer circular sin locks (un solo
+// escritor); el hilo principal agrega sus zonas al cerrar cada frame para
+// la gráfica y ExportChromeTrace vuelca todos los hilos en formato JSON de
+// Chrome/Perfetto (chrome://tracing, ui.perfetto.dev).
+class Profiler {
+public:
+    struct ThreadBuffer {
+        static const size_t CAPACITY = 16384;   // Potencia de 2
+
+        ProfileEvent events[CAPACITY];
+        std::atomic<uint64_t> written;          // Total escrito (no se reinicia)
+        uint32_t depth;
+        int threadId;
+        std::string threadName;
+
+        ThreadBuffer() : written(0), depth(0), threadId(0) {}
+    };
+
+    static const int HISTORY_FRAMES = 240;
+    static const int MAX_STAGES = 8;        // La última agrupa el resto
+    static const int MAX_ZONES = 64;
+    static const int ZONE_WINDOW = 60;      // Frames por ventana de la tabla
+
+private:
+    struct FrameSample {
+        float totalMs;
+        float stageMs[MAX_STAGES];
+    };
+
+    // Tiempo acumulado por nombre en el hilo principal (todas las profundidades)
+    struct ZoneStats {
+        const char* name;
+        float frameMs;
+        float windowMs;
+        float windowPeakMs;
+        uint32_t windowCalls;
+        float averageMs;    // Media por frame de la última ventana
+        float peakMs;       // Peor frame de la última ventana
+        uint32_t calls;
+    };
+
+    std::chrono::steady_clock::time_point epoch;
+    std::atomic<bool> enabled;
+
+    std::mutex threadsMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads;
+    std::vector<ThreadBuffer*> freeBuffers;    // De hilos que ya terminaron
+    int nextThreadId;
+    ThreadBuffer* mainThread;
+
+    uint64_t frameStart;
+    uint64_t frameFirstEvent;
+
+    FrameSample history[HISTORY_FRAMES];
+    int historyIndex;
+    const char* stageNames[MAX_STAGES];
+    int stageCount;
+
+    ZoneStats zones[MAX_ZONES];
+    int zoneCount;
+    int windowFrames;
+
+    Profiler();
+
+    int FindStage(const char* name);
+    ZoneStats* FindZone(const char* name);
+    void Record(ThreadBuffer& buffer, const char* name, uint64_t start, uint64_t end, uint32_t depth);
+
+public:
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    static Profiler* GetInstance();
+
+    uint64_t Now() const;
+
+    void SetEnabled(bool value) { enabled = value; }
+    bool IsEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Buffer del hilo actual (se registra la primera vez)
+    ThreadBuffer* GetThreadBuffer();
+    void SetThreadName(const std::string& name);
+    // Al terminar un hilo: su buffer queda libre para el siguiente
+    void ReleaseThreadBuffer(ThreadBuffer* buffer);
+
+    void Begin(ThreadBuffer& buffer);
+    void End(ThreadBuffer& buffer, const char* name, uint64_t start);
+
+    // Solo desde el hilo principal, una vez por iteración del bucle
+    void BeginFrame();
+    void EndFrame();
+
+    // Gráfica de tiempo por frame con desglose por etapa y tabla de zonas
+    void RenderOverlay(int x, int y, int width);
+
+    bool ExportChromeTrace(const std::string& path);
+};
+
+// Mide desde su construcción hasta el final del ámbito
+class ProfileScope {
+private:
+    Profiler::ThreadBuffer* buffer;
+    const char* name;
+    uint64_t start;
+
+public:
+    explicit ProfileScope(const char* zoneName);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#if NIRYX_PROFILE
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,57 @@
+#ifndef READ_HISTORY_H
+#define READ_HISTORY_H
+
+#include "script_bytecode.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Bitset de líneas de un capítulo
+class LineBitset {
+private:
+    std::vector<uint64_t> words;
+    size_t count;
+
+public:
+    LineBitset() : count(0) {}
+
+    void Resize(size_t lines);
+    void Clear() { words.clear(); count = 0; }
+    size_t GetCount() const { return count; }
+
+    bool Test(size_t line) const;
+    void Set(size_t line);   // Crece si hace falta (líneas añadidas con AddLine)
+
+    // Primera línea >= from sin marcar (GetCount() si no hay ninguna)
+    size_t FindNextUnset(size_t from) const;
+
+    const std::vector<uint64_t>& GetWords() const { return words; }
+    void SetWords(std::vector<uint64_t>&& data, size_t lines);
+};
+
+// Líneas leídas de cada capítulo, persistentes entre partidas
+//
+// Formato en disco (little-endian):
+//   "NXRL" | versión u16 | capítulos u32 |
+//   por capítulo: longitud del nombre u16 | nombre | hash u64 | líneas u32 | palabras u64
+class ReadHistory {
+private:
+    struct ChapterEntry {
+        uint64_t hash;     // Contenido del capítulo: si cambia el script se olvida lo leído
+        LineBitset lines;
+    };
+
+    std::unordered_map<std::string, ChapterEntry> chapters;
+
+public:
+    static const uint16_t VERSION = 1;
+
+    bool LoadFromFile(const std::string& path);
+    bool SaveToFile(const std::string& path) const;
+
+    // Bitset del capítulo; la referencia es estable mientras viva el historial
+    LineBitset& GetChapter(const std::string& name, const ScriptChapter& chapter);
+};
+
+#endif // READ_HISTORY_H
@@ -2,21 +2,132 @@
 #define RESOURCE_MANAGER_H
 
 #include "raylib.h"
+#include "async_loader.h"
+#include "asset_pack.h"
+#include "sprite_atlas.h"
+#include "glyph_cache.h"
+#include "string_interner.h"
 #include <string>
 #include <unordered_map>
+#include <list>
 #include <memory>
+#include <functional>
+#include <cstdint>
+
+// Clases de recurso con presupuesto de memoria propio
+enum class CacheClass {
+    TEXTURE = 0,
+    SOUND,
+    MUSIC,
+    COUNT
+};
+
+// Grupos de recursos que no se pueden expulsar
+enum class PinGroup {
+    SCENE = 0,    // En pantalla / sonando (SceneManager)
+    PREFETCH,     // Ventana de carga anticipada (ScriptPrefetcher)
+    SOUNDS,       // Efectos del capítulo y los que suenan (SoundMixer)
+    LOADING,      // Primera pantalla del capítulo mientras carga (ChapterLoader)
+    COUNT
+};
+
+struct CacheStats {
+    size_t bytesUsed;
+    size_t budgetBytes;
+    size_t entries;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+};
 
 class ResourceManager {
 private:
-    // Cache de recursos
-    std::unordered_map<std::string, Texture2D> textures;
-    std::unordered_map<std::string, Music> musicTracks;
-    std::unordered_map<std::string, Sound> sounds;
-    std::unordered_map<std::string, Font> fonts;
+    // Cache de recursos, indexada por el símbolo de la clave ("bg_<nombre>", ...)
+    SymbolTable<Texture2D> textures;
+    SymbolTable<Music> musicTracks;
+    SymbolTable<Sound> sounds;
+    // Fuentes: un archivo por nombre, rasterizado bajo demanda en cada tamaño
+    std::unordered_map<std::string, std::unique_ptr<GlyphCache>> fonts;
     
     std::string resourcePath;
     std::string currentLanguage;
     
+    // Pack mapeado en memoria; si no existe se usan los archivos sueltos
+    AssetPack pack;
+    bool AllowLooseFiles() const;
+    
+    // Atlas de sprites de personajes (nxatlas); sin índice se usan sprites sueltos
+    SpriteAtlasIndex atlas;
+    void LoadAtlasIndex();
+    std::string AtlasPageKey(int page) const;
+    
+    // Dónde está cada sprite (personaje -> emoción), resuelto una vez con strings
+    struct SpriteSource {
+        Symbol textureKey;   // Página de atlas o sprite suelto
+        bool inAtlas;
+        AtlasFrame frame;
+        std::string packKey;
+        std::string path;
+    };
+    SymbolTable<SymbolTable<SpriteSource>> spriteSources;
+    const SpriteSource& ResolveSprite(Symbol character, Symbol emotion);
+    
+    // Nombre -> clave de caché con prefijo, una tabla por tipo de recurso
+    enum class KeyTable {
+        BACKGROUND = 0,
+        CG,
+        MUSIC,
+        SOUND,
+        GUI,
+        COUNT
+    };
+    SymbolTable<Symbol> prefixedKeys[(int)KeyTable::COUNT];
+    Symbol PrefixedKey(KeyTable table, const AssetFolder& type, Symbol name);
+    // Rutas sueltas de un recurso por nombre, en orden de fallback
+    std::vector<std::string> LooseCandidates(const AssetFolder& type, const std::string& name) const;
+    
+    // Carga asíncrona: decodificación en workers, subida con presupuesto por frame
+    AsyncLoader loader;
+    SymbolTable<AssetHandle> pendingRequests;
+    size_t uploadBudgetBytes;
+    
+    // Pendiente o ya en caché: solo búsquedas por Symbol, sin rutas ni
+    // strings (null si hay que cargarlo)
+    AssetHandle FindRequest(Symbol key, AssetKind kind);
+    AssetHandle StartRequest(Symbol key, AssetKind kind, const std::string& packKey,
+                             const std::vector<std::string>& candidates);
+    AssetHandle TakePending(Symbol key);
+    bool CompleteRequest(const AssetHandle& request);
+    Texture2D LoadTextureAsset(Symbol key, const std::string& packKey,
+                               const std::string& path, const char* label);
+    
+    // LRU por clase de recurso (frente = uso más reciente)
+    struct LruEntry {
+        size_t bytes;
+        std::list<Symbol>::iterator position;
+        AssetHandle ready;      // Handle ya listo que se devuelve a cada Request* (se crea al primero)
+    };
+    struct LruCache {
+        std::list<Symbol> order;
+        SymbolTable<LruEntry> entries;
+        CacheStats stats;
+    };
+    LruCache caches[(int)CacheClass::COUNT];
+    // Claves fijadas por grupo y máscara de grupos por símbolo (bit = PinGroup)
+    std::vector<Symbol> pinnedKeys[(int)PinGroup::COUNT];
+    std::vector<uint8_t> pinMasks;
+    uint32_t evictionEpoch;
+    
+    void TrackResource(CacheClass cls, Symbol key, size_t bytes);
+    void TouchResource(CacheClass cls, Symbol key);
+    void ForgetResource(CacheClass cls, Symbol key);
+    void EnforceBudget(CacheClass cls);
+    bool IsPinned(Symbol key) const { return key < pinMasks.size() && pinMasks[key] != 0; }
+    
+    static size_t EstimateTextureSize(Texture2D texture);
+    static size_t EstimateSoundSize(Sound sound);
+    static size_t EstimateMusicSize(Music music);
+    
     // Singleton
     static ResourceManager* instance;
     ResourceManager();
@@ -32,28 +143,92 @@ public:
     void SetLanguage(const std::string& lang);
     std::string GetLanguage() const { return currentLanguage; }
     
-    // Carga de recursos
-    Texture2D LoadCharacterSprite(const std::string& character, const std::string& emotion);
-    Texture2D LoadBackground(const std::string& bgName);
-    Texture2D LoadCG(const std::string& cgName);
-    Music LoadMusic(const std::string& musicName);
-    Sound LoadSound(const std::string& soundName);
-    Font LoadFont(const std::string& fontName);
+    // Pack de recursos (Initialize abre <resPath>.pak si existe)
+    bool OpenPack(const std::string& packPath);
+    bool IsPackOpen() const { return pack.IsOpen(); }
+    bool FindPackedAsset(const std::string& packKey, PackEntry& out) const;
+    
+    // Claves de caché de cada tipo de recurso ("bg_<nombre>", "music_<nombre>", ...)
+    Symbol BackgroundKey(Symbol bgName) { return PrefixedKey(KeyTable::BACKGROUND, BACKGROUND_ASSETS, bgName); }
+    Symbol CGKey(Symbol cgName) { return PrefixedKey(KeyTable::CG, CG_ASSETS, cgName); }
+    Symbol MusicKey(Symbol musicName) { return PrefixedKey(KeyTable::MUSIC, MUSIC_ASSETS, musicName); }
+    Symbol SoundKey(Symbol soundName) { return PrefixedKey(KeyTable::SOUND, SOUND_ASSETS, soundName); }
+    Symbol GUIKey(Symbol guiName) { return PrefixedKey(KeyTable::GUI, GUI_ASSETS, guiName); }
+    // Textura que contiene el sprite: la página de atlas o el sprite suelto
+    Symbol CharacterTextureKey(Symbol character, Symbol emotion) {
+        return ResolveSprite(character, emotion).textureKey;
+    }
+    // Región de la textura (devuelta por LoadCharacterSprite/RequestCharacterSprite) para dibujar el sprite
+    SpriteFrame GetCharacterFrame(Symbol character, Symbol emotion, Texture2D texture);
+    
+    // Carga de recursos (por símbolo; las versiones con string internan el nombre)
+    Texture2D LoadCharacterSprite(Symbol character, Symbol emotion);
+    Texture2D LoadBackground(Symbol bgName);
+    Texture2D LoadCG(Symbol cgName);
+    Texture2D LoadGUI(Symbol guiName);   // resources/gui (menús, cuadros de texto)
+    Music LoadMusic(Symbol musicName);
+    Sound LoadSound(Symbol soundName);
+    Texture2D LoadCharacterSprite(const std::string& character, const std::string& emotion) {
+        return LoadCharacterSprite(Intern(character), Intern(emotion));
+    }
+    Texture2D LoadBackground(const std::string& bgName) { return LoadBackground(Intern(bgName)); }
+    Texture2D LoadCG(const std::string& cgName) { return LoadCG(Intern(cgName)); }
+    Music LoadMusic(const std::string& musicName) { return LoadMusic(Intern(musicName)); }
+    Sound LoadSound(const std::string& soundName) { return LoadSound(Intern(soundName)); }
+    Font LoadFont(const std::string& fontName);   // Tamaño base 32
+    GlyphCache* LoadGlyphCache(const std::string& fontName);
+    
+    // Carga asíncrona: devuelve un handle que pasa a READY tras ProcessUploads
+    AssetHandle RequestCharacterSprite(Symbol character, Symbol emotion);
+    AssetHandle RequestBackground(Symbol bgName);
+    AssetHandle RequestCG(Symbol cgName);
+    AssetHandle RequestMusic(Symbol musicName);
+    AssetHandle RequestSound(Symbol soundName);
+    
+    // Retira una petición hecha con Request*: la carga se cancela cuando
+    // todas las que la pidieron la han retirado
+    void CancelRequest(const AssetHandle& request);
+    
+    // Trabajo para los workers del cargador (sin workers se ejecuta aquí mismo)
+    void RunInBackground(std::function<void()> job);
+    
+    // Llamar una vez por frame desde el hilo principal
+    void ProcessUploads();
+    void SetUploadBudget(size_t bytesPerFrame) { uploadBudgetBytes = bytesPerFrame; }
+    size_t GetUploadBudget() const { return uploadBudgetBytes; }
+    bool HasPendingLoads() const { return !pendingRequests.Empty(); }
+    
+    // Presupuesto de memoria y expulsión LRU
+    void SetCacheBudget(CacheClass cls, size_t bytes);
+    void SetPinnedKeys(PinGroup group, const std::vector<Symbol>& keys);
+    CacheStats GetCacheStats(CacheClass cls) const { return caches[(int)cls].stats; }
+    // Cambia cada vez que se expulsa algo (para invalidar copias de texturas)
+    uint32_t GetEvictionEpoch() const { return evictionEpoch; }
+    bool IsTextureLoaded(Symbol key) const { return textures.Contains(key); }
     
     // Obtener recursos cargados
-    Texture2D GetTexture(const std::string& key);
-    Music GetMusic(const std::string& key);
-    Sound GetSound(const std::string& key);
+    Texture2D GetTexture(Symbol key);
+    Music GetMusic(Symbol key);
+    Sound GetSound(Symbol key);
     Font GetFont(const std::string& key);
     
     // Liberar recursos
-    void UnloadTexture(const std::string& key);
-    void UnloadMusic(const std::string& key);
-    void UnloadSound(const std::string& key);
+    void UnloadTexture(Symbol key);
+    void UnloadMusic(Symbol key);
+    void UnloadSound(Symbol key);
     void UnloadAll();
     
     // Rutas de diálogos
     std::string GetDialoguePath(const std::string& fileName);
+    std::string GetDialoguePackKey(const std::string& fileName) const;
+    
+    // Voces por línea: voice/<idioma>/<capítulo>/<línea> (ch0.txt, línea 12
+    // contando desde 1 -> voice/spa-spa/ch0/12.ogg). Sin archivos sueltos
+    // permitidos las rutas vienen vacías.
+    std::string GetVoicePackKey(const std::string& fileName, size_t line) const;
+    std::vector<std::string> GetVoiceCandidates(const std::string& fileName, size_t line) const;
+    // Si el capítulo tiene carpeta de voces sueltas (se comprueba una vez por capítulo)
+    bool HasLooseVoices(const std::string& fileName) const;
 };
 
 #endif // RESOURCE_MANAGER_H
\ No newline at end of file
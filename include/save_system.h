@@ -0,0 +1,109 @@
+#ifndef SAVE_SYSTEM_H
+#define SAVE_SYSTEM_H
+
+#include "raylib.h"
+#include "scene_manager.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+class DialogueSystem;
+
+// Partida guardada. En memoria la escena usa símbolos; en disco van los
+// nombres (los ids del interner cambian de una sesión a otra).
+struct SaveData {
+    std::string language;
+    std::string chapter;          // "ch0.txt"
+    uint64_t chapterHash;         // Contenido del capítulo al guardar
+    uint32_t line;
+    int64_t timestamp;            // time(nullptr)
+    SceneState scene;
+    std::vector<unsigned char> thumbnail;   // PNG (vacío si no hay)
+
+    SaveData() : chapterHash(0), line(0), timestamp(0) {}
+};
+
+// Guardado y carga de partidas (slots y guardado rápido)
+//
+// En el hilo principal solo se copia el estado y se lee la miniatura de la
+// GPU (una textura pequeña); invertirla, codificarla a PNG, serializar y
+// escribir lo hace un hilo aparte. Se escribe en <slot>.tmp y se renombra,
+// así un cierre a medias nunca deja un slot corrupto.
+//
+// Formato (.nxs, little-endian):
+//   "NXSV" | versión u16 | línea u32 | hash u64 | fecha i64 |
+//   strings (u16 longitud + bytes): idioma, capítulo, fondo, música |
+//   posición de la música f32 | personajes u8 |
+//   por personaje: nombre, emoción, posición u8, alpha u8 |
+//   miniatura: tamaño u32 + PNG
+class SaveSystem {
+private:
+    struct SaveJob {
+        std::string path;
+        SaveData data;
+        Image thumbnail;          // Copia en CPU, todavía invertida en Y
+    };
+
+    std::string saveDirectory;
+    RenderTexture2D thumbnailTarget;
+
+    std::thread worker;
+    std::deque<SaveJob> jobs;
+    std::mutex jobsMutex;
+    std::condition_variable jobsCondition;
+    bool stopping;
+    std::atomic<uint32_t> completedSaves;
+    std::atomic<uint32_t> failedSaves;
+    std::atomic<uint32_t> pendingSaves;
+
+    void WorkerLoop();
+    bool WriteSave(SaveJob& job);
+    Image CaptureThumbnail(SceneManager& scene);
+
+public:
+    static const uint16_t VERSION = 1;
+    static const int THUMBNAIL_WIDTH = 256;
+    static const int THUMBNAIL_HEIGHT = 144;
+    static const int QUICK_SLOT = -1;
+
+    SaveSystem(const std::string& directory = "saves/");
+    ~SaveSystem();
+
+    // Termina los guardados en cola antes de volver
+    void Shutdown();
+
+    // Copia el estado actual y lo encola; vuelve sin esperar al disco
+    bool Save(int slot, const std::string& chapterName, const DialogueSystem& dialogue,
+              SceneManager& scene);
+    bool QuickSave(const std::string& chapterName, const DialogueSystem& dialogue, SceneManager& scene) {
+        return Save(QUICK_SLOT, chapterName, dialogue, scene);
+    }
+
+    // Lectura síncrona (unas decenas de KB con la miniatura)
+    bool Load(int slot, SaveData& out) const;
+    bool QuickLoad(SaveData& out) const { return Load(QUICK_SLOT, out); }
+    bool SlotExists(int slot) const;
+
+    // Tras cargar el capítulo de la partida: misma línea y misma escena
+    // (música en su posición) que al guardar
+    static void Resume(const SaveData& data, DialogueSystem& dialogue, SceneManager& scene);
+
+    // Miniatura del slot como textura (la libera quien la pide)
+    static Texture2D LoadThumbnail(const SaveData& data);
+
+    bool IsSaving() const { return pendingSaves.load() > 0; }
+    uint32_t GetCompletedSaves() const { return completedSaves.load(); }
+    uint32_t GetFailedSaves() const { return failedSaves.load(); }
+
+    std::string GetSlotPath(int slot) const;
+
+    static bool Serialize(const SaveData& data, std::vector<unsigned char>& out);
+    static bool Deserialize(const unsigned char* bytes, size_t size, SaveData& out);
+};
+
+#endif // SAVE_SYSTEM_H
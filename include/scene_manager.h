@@ -0,0 +1,214 @@
+#ifndef SCENE_MANAGER_H
+#define SCENE_MANAGER_H
+
+#include "raylib.h"
+#include "async_loader.h"
+#include "sprite_atlas.h"
+#include "string_interner.h"
+#include "music_player.h"
+#include "sound_mixer.h"
+#include <string>
+#include <vector>
+#include <memory>
+
+enum class CharacterPosition {
+    LEFT,
+    CENTER,
+    RIGHT,
+    OFFSCREEN   // Posición personalizada (x, y)
+};
+
+// Estado completo de la escena para rebobinar o saltar a otra línea
+struct CharacterState {
+    Symbol name;
+    Symbol emotion;
+    CharacterPosition position;
+    float alpha;
+};
+
+struct SceneState {
+    Symbol background;                        // NO_SYMBOL: sin fondo
+    Symbol music;                             // NO_SYMBOL: en silencio
+    float musicPosition;                      // Segundos (< 0: desde el principio)
+    std::vector<CharacterState> characters;   // Solo los visibles
+};
+
+class Character {
+private:
+    Symbol name;
+    Symbol currentEmotion;
+    CharacterPosition position;
+    float xPos;
+    float yPos;
+    float alpha;
+    bool isVisible;
+    
+    // Sprites por emoción: región del atlas o sprite suelto (las texturas pertenecen al ResourceManager)
+    SymbolTable<SpriteFrame> sprites;
+    
+    // Sprite pedido en segundo plano; se mantiene la emoción actual hasta que llegue
+    Symbol pendingEmotion;
+    AssetHandle pendingSprite;
+    uint32_t spritesEpoch;   // Época de expulsión del ResourceManager al validar sprites
+    // Sube con cada cambio visible (sprite, posición, alpha, visibilidad)
+    uint32_t revision;
+    uint32_t cleanRevision;  // Revisión en el último ClearDirty
+
+public:
+    Character(Symbol charName);
+    ~Character();
+    
+    void LoadSprite(Symbol emotion);
+    void SetEmotion(Symbol emotion);
+    void SetPosition(CharacterPosition pos);
+    void SetPosition(float x, float y);
+    void SetAlpha(float a);
+    
+    void Show();
+    void Hide();
+    
+    bool Update();   // true si cambió el sprite visible
+    uint32_t GetRevision() const { return revision; }
+    bool IsDirty() const { return revision != cleanRevision; }
+    void ClearDirty() { cleanRevision = revision; }
+    void CollectPinnedKeys(std::vector<Symbol>& keys) const;
+    void Render(int screenWidth, int screenHeight);
+    unsigned int GetTextureId() const;   // Textura que dibuja Render (0 si nada)
+    
+    Symbol GetNameId() const { return name; }
+    Symbol GetEmotionId() const { return currentEmotion; }
+    const std::string& GetName() const { return SymbolName(name); }
+    const std::string& GetEmotion() const { return SymbolName(currentEmotion); }
+    CharacterPosition GetPosition() const { return position; }
+    float GetAlpha() const { return alpha; }
+    bool IsVisible() const { return isVisible; }
+};
+
+class SceneManager {
+private:
+    Texture2D currentBackground;
+    Symbol currentBgName;
+    AssetHandle pendingBackground;  // El fondo anterior sigue visible hasta que llegue
+    Symbol shownBgName;             // El de currentBackground (fijado mientras se vea)
+    
+    // La música suena desde su propio hilo; aquí solo el nombre de la actual
+    MusicPlayer musicPlayer;
+    Symbol currentMusicName;
+    float musicVolume;
+    float musicFade;                 // Segundos del fundido cruzado entre pistas
+    uint32_t musicTracksRevision;    // Pistas del reproductor ya fijadas
+    void StartMusic(Symbol musicName, bool loop, float start);
+    
+    // Efectos con varias voces a la vez
+    SoundMixer soundMixer;
+    
+    SymbolTable<std::unique_ptr<Character>> characters;
+    
+    float transitionAlpha;
+    bool isTransitioning;
+    uint32_t revision;        // Sube al cambiar el fondo o terminar una transición
+    uint32_t cleanRevision;   // Revisión en el último ClearDirty
+    
+    // Cambios de textura en el último render de la escena (fondo + personajes)
+    int textureBinds;
+    unsigned int lastTextureId;
+    void CountTextureBind(unsigned int textureId);
+    
+    // Publica al ResourceManager lo que está en pantalla para que no se expulse
+    void PublishPins();
+    
+    // Capa compuesta (fondo + personajes) fuera de pantalla: se vuelve a
+    // componer solo cuando cambia su revisión o el tamaño de la ventana
+    RenderTexture2D sceneLayer;
+    uint32_t layerRevision;
+    bool layerValid;
+    bool useSceneLayer;
+    int layerCompositions;
+    uint32_t GetLayerRevision() const;
+    void UnloadSceneLayer();
+
+public:
+    SceneManager();
+    ~SceneManager();
+    
+    // Para el hilo de la música y suelta las voces: antes de liberar los
+    // recursos y cerrar el audio
+    void Shutdown();
+    
+    // Fondos (las versiones con string internan el nombre y delegan)
+    void SetBackground(Symbol bgName);
+    void SetBackground(const std::string& bgName) { SetBackground(Intern(bgName)); }
+    void ClearBackground();
+    
+    // Música y sonidos
+    void PlayMusic(Symbol musicName, bool loop = true);
+    void PlayMusic(const std::string& musicName, bool loop = true) { PlayMusic(Intern(musicName), loop); }
+    void StopMusic();
+    void SetMusicVolume(float volume);
+    void SetMusicFade(float seconds) { musicFade = seconds; }
+    float GetMusicFade() const { return musicFade; }
+    
+    // Voz de la línea (la abre y la libera el VoicePlayer); baja la música mientras suena
+    void PlayVoice(Music clip) { musicPlayer.PlayVoice(clip); }
+    void StopVoice() { musicPlayer.StopVoice(); }
+    bool IsVoicePlaying() const { return musicPlayer.IsVoicePlaying(); }
+    void SetVoiceVolume(float volume) { musicPlayer.SetVoiceVolume(volume); }
+    void SetMusicDucking(float level) { musicPlayer.SetDuckLevel(level); }
+    void PlaySound(Symbol soundName, float volume = 1.0f, float pan = 0.5f,
+                   int priority = SoundMixer::PRIORITY_NORMAL);
+    void PlaySound(const std::string& soundName) { PlaySound(Intern(soundName)); }
+    void SetSoundVolume(float volume) { soundMixer.SetVolume(volume); }
+    // Efectos del capítulo decodificados antes de que suenen (ver SoundMixer::Preload)
+    void PreloadSounds(const ScriptChapter& chapter, size_t fromOffset = 0) {
+        soundMixer.Preload(chapter, fromOffset);
+    }
+    
+    // Personajes
+    Character* GetCharacter(Symbol name);
+    Character* GetCharacter(const std::string& name) { return GetCharacter(Intern(name)); }
+    void ShowCharacter(Symbol name, Symbol emotion, CharacterPosition pos = CharacterPosition::CENTER);
+    void ShowCharacter(const std::string& name, const std::string& emotion,
+                       CharacterPosition pos = CharacterPosition::CENTER) {
+        ShowCharacter(Intern(name), Intern(emotion), pos);
+    }
+    void HideCharacter(Symbol name);
+    void HideCharacter(const std::string& name) { HideCharacter(Intern(name)); }
+    void ClearAllCharacters();
+    
+    // Lleva la escena a state cambiando solo lo que difiere: la música que ya
+    // suena sigue sin cortes y no se repiten los efectos de sonido
+    void RestoreState(const SceneState& state);
+    // Estado actual (lo que se ve y suena) para guardar partida
+    void CaptureState(SceneState& out) const;
+    
+    void Update(float deltaTime);
+    void RenderBackground(int screenWidth, int screenHeight);
+    void RenderCharacters(int screenWidth, int screenHeight);
+    
+    // Fondo + personajes: un solo quad desde la capa cacheada
+    void RenderScene(int screenWidth, int screenHeight);
+    void SetSceneLayerEnabled(bool enabled);
+    void InvalidateSceneLayer() { layerValid = false; }
+    int GetLayerCompositions() const { return layerCompositions; }
+    // Escena reducida a width x height en el render target activo (miniaturas)
+    void RenderThumbnail(int width, int height);
+    
+    // Transiciones
+    void StartTransition();
+    bool IsTransitioning() const { return isTransitioning; }
+    
+    // Algo visible cambió (fondo, personajes, transición en curso)
+    bool IsDirty() const;
+    void ClearDirty();
+    
+    const std::string& GetBackgroundName() const { return SymbolName(currentBgName); }
+    const std::string& GetMusicName() const { return SymbolName(currentMusicName); }
+    Symbol GetBackgroundId() const { return currentBgName; }
+    Symbol GetMusicId() const { return currentMusicName; }
+    float GetMusicPosition() const;   // Segundos (-1 si no suena nada)
+    MusicStats GetMusicStats() const { return musicPlayer.GetStats(); }
+    SoundStats GetSoundStats() const { return soundMixer.GetStats(); }
+    int GetTextureBinds() const { return textureBinds; }
+};
+
+#endif // SCENE_MANAGER_H
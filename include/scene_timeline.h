@@ -0,0 +1,75 @@
+#ifndef SCENE_TIMELINE_H
+#define SCENE_TIMELINE_H
+
+#include "script_bytecode.h"
+#include "scene_manager.h"
+#include <vector>
+#include <cstdint>
+
+// Estado de la escena en una línea, con ids de la tabla de strings del capítulo
+struct SceneSnapshot {
+    struct CharacterEntry {
+        uint32_t name;
+        uint32_t emotion;
+        CharacterPosition position;
+    };
+
+    static const uint32_t NONE = UINT32_MAX;
+
+    uint32_t background;
+    uint32_t music;
+    std::vector<CharacterEntry> characters;   // Visibles, en orden de aparición
+
+    SceneSnapshot() : background(NONE), music(NONE) {}
+};
+
+// Línea de tiempo de la escena de un capítulo
+//
+// Cada CHECKPOINT_INTERVAL líneas se guarda el estado completo; entre dos
+// checkpoints los deltas son los propios bloques de bytecode de cada línea
+// (@bg, @music, personajes). Reconstruir cualquier línea cuesta como mucho
+// CHECKPOINT_INTERVAL bloques, sin importar lo lejos que esté.
+//
+// Los checkpoints suponen que se leyó desde el principio en orden. Tras un
+// @jump o una opción la escena viene de otro sitio: Replay parte de la que
+// había al saltar y aplica solo las líneas recorridas, con los cambios de
+// cada tramo entero ya acumulados (los comandos solo fijan valores, así que
+// componerlos da lo mismo que ejecutarlos uno a uno).
+class SceneTimeline {
+private:
+    std::vector<SceneSnapshot> checkpoints;   // Estado antes de la línea i * CHECKPOINT_INTERVAL
+    std::vector<SceneSnapshot> changes;       // Lo que fija cada tramo (NONE: no lo toca)
+    std::vector<float> musicPositions;        // Posición de la música al mostrar cada línea (-1: nunca)
+    SceneSnapshot buildState;                 // Estado tras la última línea procesada
+    size_t lineCount;
+
+    static void ApplyLine(const ScriptChapter& chapter, size_t line, SceneSnapshot& state);
+    static void SetCharacter(SceneSnapshot& state, uint32_t name, uint32_t emotion,
+                             CharacterPosition position);
+
+public:
+    static const size_t CHECKPOINT_INTERVAL = 32;
+
+    SceneTimeline();
+
+    // Incremental: si el capítulo solo creció (AddLine, compilación por
+    // tramos) se continúa desde la última línea procesada
+    void Build(const ScriptChapter& chapter);
+    void Clear();
+    bool IsBuiltFor(const ScriptChapter& chapter) const { return lineCount == chapter.GetLineCount(); }
+
+    // Estado tras ejecutar los comandos de la línea (el que se ve con su texto)
+    void Reconstruct(const ScriptChapter& chapter, size_t line, SceneSnapshot& out) const;
+    void ToSceneState(const ScriptChapter& chapter, const SceneSnapshot& snapshot, size_t line,
+                      SceneState& out) const;
+    // state: la escena antes de los comandos de fromLine; queda la de line
+    // llegando a ella en orden desde fromLine (fromLine > line: sin cambios)
+    void Replay(const ScriptChapter& chapter, size_t fromLine, size_t line, SceneState& state) const;
+
+    void RecordMusicPosition(size_t line, float seconds);
+    float GetMusicPosition(size_t line) const;
+
+    size_t GetCheckpointCount() const { return checkpoints.size(); }
+};
+
+#endif // SCENE_TIMELINE_H
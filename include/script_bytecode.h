@@ -0,0 +1,156 @@
+#ifndef SCRIPT_BYTECODE_H
+#define SCRIPT_BYTECODE_H
+
+#include "raylib.h"
+#include "scene_manager.h"
+#include "string_interner.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+// Instrucciones del bytecode de capítulos
+enum class OpCode : uint8_t {
+    END = 0,      // Fin del código (no se emite, se devuelve al pasar del final)
+    BACKGROUND,   // @bg      <fondo>
+    MUSIC,        // @music   <pista>
+    SFX,          // @sfx     <sonido>
+    CHARACTER,    // Nombre emocion posicion
+    SAY           // Línea de diálogo/narración (cierra el bloque de la línea)
+};
+
+struct ScriptInstruction {
+    OpCode op;
+    uint32_t arg1;   // índice en la tabla de strings (nombre, fondo, pista...)
+    uint32_t arg2;   // emoción (CHARACTER) o texto (SAY)
+    uint32_t arg3;   // emoción (SAY)
+    CharacterPosition position;
+    Color color;
+};
+
+// Etiqueta (@label): línea de diálogo que sigue a su definición
+struct ScriptLabel {
+    uint32_t name;     // Índice en la tabla de strings
+    uint32_t line;     // == número de líneas si no la sigue ninguna (fin del capítulo)
+};
+
+// Destino de un salto o de una opción de menú
+struct ScriptBranch {
+    uint32_t text;     // Texto de la opción (0 en los saltos)
+    uint32_t chapter;  // Capítulo de destino (0: este mismo)
+    uint32_t label;    // Etiqueta de destino (0: inicio del capítulo)
+    uint32_t line;     // Línea ya resuelta si es de este capítulo (UNRESOLVED_LINE si no)
+};
+
+// Salida de una línea: salto (@jump) o menú de opciones (@choice). Las
+// salidas se guardan ordenadas por línea, fuera del código: avanzar, saltar
+// y rebobinar la escena siguen recorriendo los mismos bloques.
+struct ScriptExit {
+    uint32_t line;
+    uint32_t firstBranch;
+    uint32_t branchCount;
+    uint32_t choice;   // 1: menú de opciones, 0: salto
+};
+
+// Capítulo compilado: stream de opcodes, tabla de strings internados e
+// índice de offsets por línea. Cada línea de diálogo es un bloque que
+// empieza tras el SAY anterior y termina en su propio SAY.
+//
+// Formato en disco (.nxb, little-endian):
+//   cabecera | offsets de strings (u32) | datos de strings ('\0') | código | offsets de líneas (u32)
+//   | etiquetas | destinos | salidas
+class ScriptChapter {
+private:
+    std::vector<uint8_t> code;
+    std::vector<uint32_t> lineOffsets;
+    std::vector<uint32_t> stringOffsets;
+    std::vector<char> stringData;
+    // Símbolo global de cada string que nombra algo (personaje, emoción,
+    // recurso); NO_SYMBOL para los textos de diálogo
+    std::vector<Symbol> symbols;
+
+    // Tabla de saltos: etiquetas, destinos y salidas por línea. Los destinos
+    // de este capítulo se resuelven a número de línea al compilar, así que
+    // seguir un salto es un acceso a vector.
+    std::vector<ScriptLabel> labels;
+    std::vector<ScriptBranch> branches;
+    std::vector<ScriptExit> exits;
+    SymbolTable<uint32_t> labelLines;                  // Etiqueta -> línea
+    SymbolTable<std::vector<uint32_t>> pendingBranches;   // Saltos hacia delante sin resolver
+
+    // Índice de los nombres para no repetirlos: ids en una tabla abierta
+    // con el hash de su contenido, sin copias del string. Los textos de
+    // diálogo no pasan por él (se añaden tal cual). Solo se usa al
+    // compilar; se reconstruye si hace falta tras cargar
+    std::vector<uint32_t> nameSlots;   // id + 1 (0: libre), tamaño potencia de 2
+    size_t nameCount;
+    size_t blockStart;
+    uint64_t sourceHash;     // Hash del texto fuente (0: no compilado desde texto)
+
+    void WriteVarUInt(uint32_t value);
+    uint32_t InternName(std::string_view str);
+    uint32_t AddString(std::string_view str);
+    uint32_t AddText(std::string_view text);   // Sin buscar repetidos ("" es el 0)
+    void IndexName(uint32_t id);
+    void ResolveSymbols();
+    uint32_t AddBranch(std::string_view text, std::string_view chapterName, std::string_view label);
+
+public:
+    static const uint16_t VERSION = 3;
+    static const uint32_t UNRESOLVED_LINE = 0xFFFFFFFF;
+    static const size_t NO_EXIT = (size_t)-1;
+
+    ScriptChapter();
+
+    void Clear();
+    uint32_t InternString(std::string_view str);
+
+    // Emisión de instrucciones (compilador)
+    void EmitBackground(std::string_view bgName);
+    void EmitMusic(std::string_view musicName);
+    void EmitSound(std::string_view soundName);
+    void EmitCharacter(std::string_view name, std::string_view emotion, CharacterPosition pos);
+    void EmitLine(std::string_view character, std::string_view text,
+                  std::string_view emotion, Color color);
+    // Etiquetas y saltos: chapterName vacío es este capítulo, label vacía su
+    // inicio. Los saltos y opciones salen de la última línea emitida.
+    void EmitLabel(std::string_view name);
+    void EmitJump(std::string_view chapterName, std::string_view label);
+    void EmitChoice(std::string_view text, std::string_view chapterName, std::string_view label);
+
+    // Lectura: Decode devuelve el offset de la siguiente instrucción
+    size_t Decode(size_t offset, ScriptInstruction& out) const;
+    std::string_view GetString(uint32_t id) const;  // Siempre terminado en '\0'
+    Symbol GetSymbol(uint32_t id) const { return (id < symbols.size()) ? symbols[id] : NO_SYMBOL; }
+
+    size_t GetLineCount() const { return lineOffsets.size(); }
+    size_t GetLineOffset(size_t line) const { return lineOffsets[line]; }
+    size_t GetCodeSize() const { return code.size(); }
+    size_t GetStringCount() const { return stringOffsets.size(); }
+
+    // Salida de la línea (NO_EXIT si sigue a la siguiente) y primera salida
+    // desde una línea en adelante; búsqueda binaria sobre las salidas
+    size_t FindExit(size_t line) const;
+    size_t FindNextExit(size_t fromLine) const;
+    const ScriptExit& GetExit(size_t index) const { return exits[index]; }
+    const ScriptBranch& GetBranch(size_t index) const { return branches[index]; }
+    size_t GetExitCount() const { return exits.size(); }
+    // UNRESOLVED_LINE si la etiqueta no está (o aún no se ha compilado)
+    uint32_t GetLabelLine(Symbol label) const;
+    const std::vector<ScriptLabel>& GetLabels() const { return labels; }
+    // Identifica el contenido para el historial de lectura: el hash del texto
+    // fuente si se compiló desde un script (igual en .txt y .nxb), si no
+    // FNV-1a del código y los strings
+    uint64_t GetContentHash() const;
+    void SetSourceHash(uint64_t hash) { sourceHash = hash; }
+
+    // Serialización
+    bool LoadFromMemory(const unsigned char* data, size_t size);
+    bool LoadFromFile(const std::string& path);
+    bool SaveToFile(const std::string& path) const;
+
+    // ch0.txt -> ch0.nxb
+    static std::string GetCompiledPath(const std::string& scriptPath);
+};
+
+#endif // SCRIPT_BYTECODE_H
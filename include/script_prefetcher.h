@@ -0,0 +1,40 @@
+#ifndef SCRIPT_PREFETCHER_H
+#define SCRIPT_PREFETCHER_H
+
+#include "script_bytecode.h"
+#include "async_loader.h"
+#include <vector>
+#include <deque>
+#include <string>
+
+// Recorre las próximas N líneas del capítulo y pide en segundo plano los
+// fondos, sprites, música y sonidos que van a necesitar.
+class ScriptPrefetcher {
+private:
+    size_t lookahead;        // Líneas por delante de la actual
+    size_t scannedUpTo;      // Primera línea aún no escaneada
+    size_t lastLine;
+    std::vector<AssetHandle> inFlight;
+
+    // Claves de la ventana (línea, clave), fijadas en el ResourceManager
+    std::deque<std::pair<size_t, Symbol>> windowKeys;
+
+    void ScanLine(const ScriptChapter& chapter, size_t line);
+    void PublishWindow();
+
+public:
+    ScriptPrefetcher(size_t lines = 8);
+    ~ScriptPrefetcher();
+
+    void SetLookahead(size_t lines) { lookahead = lines; }
+    size_t GetLookahead() const { return lookahead; }
+
+    // Llamar cada frame con la posición actual del DialogueSystem
+    void Update(const ScriptChapter& chapter, size_t currentLine);
+
+    // Cancela lo que aún no se ha cargado (p. ej. al retroceder)
+    void Cancel();
+    void Reset();
+};
+
+#endif // SCRIPT_PREFETCHER_H
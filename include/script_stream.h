@@ -0,0 +1,45 @@
+#ifndef SCRIPT_STREAM_H
+#define SCRIPT_STREAM_H
+
+#include "asset_pack.h"
+#include "dialogue_parser.h"
+#include "script_bytecode.h"
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+// Script de texto mapeado en memoria y compilado por tramos
+//
+// Las líneas son vistas sobre el mapeo (sin getline ni copias) y se
+// compilan a bytecode solo hasta donde hace falta: abrir una ruta de 50k
+// líneas compila solo el primer tramo, y las páginas del texto ya compilado
+// las puede descartar el sistema (están respaldadas por el archivo).
+class ScriptStream {
+private:
+    MappedFile file;
+    size_t cursor;          // Byte de la próxima línea sin compilar
+    uint64_t sourceHash;
+    DialogueParser parser;
+
+public:
+    static const size_t CHUNK_LINES = 256;   // Líneas de diálogo por tramo
+
+    ScriptStream();
+
+    bool Open(const std::string& path);
+
+    // Siguiente línea sin compilar, como vista sobre el mapeo (sin el '\n';
+    // el '\r' de CRLF se queda). false al llegar al final.
+    bool NextLine(std::string_view& line);
+
+    // Compila hasta que el capítulo tenga lineTarget líneas de diálogo o se
+    // acabe el texto. Devuelve false si ya no queda nada por compilar.
+    bool CompileUpTo(ScriptChapter& chapter, size_t lineTarget);
+
+    bool IsFinished() const { return cursor >= file.GetSize(); }
+    uint64_t GetSourceHash() const { return sourceHash; }
+    size_t GetBytesCompiled() const { return cursor; }
+    size_t GetSize() const { return file.GetSize(); }
+};
+
+#endif // SCRIPT_STREAM_H
@@ -0,0 +1,88 @@
+#ifndef SOUND_MIXER_H
+#define SOUND_MIXER_H
+
+#include "raylib.h"
+#include "async_loader.h"
+#include "string_interner.h"
+#include <vector>
+#include <cstdint>
+
+class ScriptChapter;
+
+struct SoundStats {
+    uint64_t plays;
+    uint64_t stolen;      // Voces cortadas para dar paso a otra
+    uint64_t rejected;    // Sin voz libre ni de menor prioridad
+    uint64_t delayed;     // Disparos que esperaron a la carga en segundo plano
+    uint64_t dropped;     // Llegaron demasiado tarde y no sonaron
+    int activeVoices;
+};
+
+// Efectos de sonido con un número fijo de voces
+//
+// Cada voz es un alias (LoadSoundAlias) del Sound en caché: comparte su PCM
+// ya decodificado, así que el mismo efecto puede sonar varias veces a la vez
+// (pasos, campanillas repetidas) sin cortar la instancia anterior. Sin voz
+// libre se roba la de menor prioridad y, a igual prioridad, la más antigua.
+//
+// Los @sfx de cada capítulo se piden al cargarlo y quedan fijados en la
+// caché mientras el capítulo esté abierto: el primer disparo no decodifica
+// nada en el hilo principal. Lo que no esté cargado se pide en segundo
+// plano y suena al llegar si no ha pasado MAX_DELAY_MS.
+class SoundMixer {
+private:
+    struct Voice {
+        Sound alias;          // Comparte el PCM del sonido de origen
+        Symbol key;           // Clave del sonido en caché (NO_SYMBOL: libre)
+        int priority;
+        uint64_t order;       // Orden de disparo: entre iguales se roba la más vieja
+    };
+
+    struct PendingPlay {
+        AssetHandle handle;
+        float volume;
+        float pan;
+        int priority;
+        float age;
+    };
+
+    std::vector<Voice> voices;
+    std::vector<PendingPlay> pending;
+    std::vector<Symbol> chapterSounds;   // Claves de los @sfx del capítulo (fijadas)
+    float volume;
+    uint64_t nextOrder;
+    bool pinsDirty;
+    SoundStats stats;
+
+    Voice* AcquireVoice(Symbol key, int priority);
+    void Start(Voice& voice, Symbol key, Sound source, float gain, float pan, int priority);
+    void ReleaseVoice(Voice& voice);
+    void PublishPins();
+
+public:
+    static const int VOICE_COUNT = 16;
+    static const int PRIORITY_NORMAL = 0;
+    static const int MAX_DELAY_MS = 250;   // Lo que puede esperar un disparo a su carga
+
+    SoundMixer(int voiceCount = VOICE_COUNT);
+    ~SoundMixer();
+
+    // Detiene las voces y suelta sus alias: antes de liberar los sonidos de la caché
+    void Shutdown();
+
+    // Pide y fija los @sfx del bytecode desde fromOffset (0: capítulo nuevo,
+    // se sueltan los del anterior)
+    void Preload(const ScriptChapter& chapter, size_t fromOffset = 0);
+
+    // pan: 0 izquierda, 0.5 centro, 1 derecha
+    void Play(Symbol soundName, float gain = 1.0f, float pan = 0.5f, int priority = PRIORITY_NORMAL);
+    void StopAll();
+    void SetVolume(float newVolume);
+
+    // Libera las voces que terminaron y dispara lo que llegó de los workers
+    void Update(float deltaTime);
+
+    SoundStats GetStats() const;
+};
+
+#endif // SOUND_MIXER_H
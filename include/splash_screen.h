@@ -7,9 +7,8 @@
 class SplashScreen {
 private:
     float alpha;
-    float loadingProgress;      // 0.0f a 1.0f
+    float loadingProgress;      // 0.0f a 1.0f (trabajo real de la fase de carga)
     float elapsedTime;
-    float totalLoadTime;        // Tiempo total de carga simulada
     bool isFinished;
     bool showLoadingBar;        // Mostrar barra de carga
     Texture2D splashTexture;
@@ -25,7 +24,8 @@ public:
     bool IsFinished() const { return isFinished; }
     void Reset();
     
-    void SetLoadingTime(float totalTime = 3.0f);
+    // Progreso de la carga; el splash termina en cuanto llega a 1
+    void SetProgress(float progress) { loadingProgress = progress; }
     void SetShowLoadingBar(bool show) { showLoadingBar = show; }
 };
 
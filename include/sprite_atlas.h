@@ -0,0 +1,70 @@
+#ifndef SPRITE_ATLAS_H
+#define SPRITE_ATLAS_H
+
+#include "raylib.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Sprite listo para dibujar: región de una textura (atlas o sprite suelto).
+// offset/size describen el sprite original antes de recortar el borde transparente.
+struct SpriteFrame {
+    Texture2D texture;
+    Rectangle source;
+    Vector2 offset;    // Posición del recorte dentro del sprite original
+    Vector2 size;      // Tamaño original del sprite
+};
+
+struct AtlasFrame {
+    int page;
+    Rectangle source;
+    Vector2 offset;
+    Vector2 size;
+};
+
+// Índice de atlas de personajes (<nombre>.atlas), formato texto:
+//   page <archivo.png>
+//   <personaje> <emocion> <x> <y> <ancho> <alto> <offsetX> <offsetY> <anchoOriginal> <altoOriginal>
+// Los frames pertenecen a la última página declarada.
+class SpriteAtlasIndex {
+private:
+    std::vector<std::string> pages;
+    std::unordered_map<std::string, AtlasFrame> frames;   // "personaje/emocion"
+
+public:
+    bool LoadFromText(const char* text);
+    void Clear();
+
+    bool Find(const std::string& character, const std::string& emotion, AtlasFrame& out) const;
+    const std::string& GetPageName(int page) const { return pages[page]; }
+    size_t GetPageCount() const { return pages.size(); }
+    bool IsEmpty() const { return frames.empty(); }
+};
+
+// Empaquetador de atlas (herramienta nxatlas): recorta el borde transparente
+// de cada sprite y los coloca por estantes en páginas de tamaño fijo.
+class SpriteAtlasBuilder {
+private:
+    struct Input {
+        std::string character;
+        std::string emotion;
+        Image image;         // Ya recortada
+        Vector2 offset;
+        Vector2 size;
+        int page;
+        Vector2 position;
+    };
+    std::vector<Input> inputs;
+    int pageSize;
+    int padding;
+
+public:
+    SpriteAtlasBuilder(int maxPageSize = 4096, int spritePadding = 2);
+    ~SpriteAtlasBuilder();
+
+    bool Add(const std::string& character, const std::string& emotion, const std::string& path);
+    // Escribe <outputDir>/<name>_<n>.png y <outputDir>/<name>.atlas
+    bool Build(const std::string& outputDir, const std::string& name);
+};
+
+#endif // SPRITE_ATLAS_H
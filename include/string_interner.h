@@ -0,0 +1,107 @@
+#ifndef STRING_INTERNER_H
+#define STRING_INTERNER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <utility>
+
+// Identificador de un string internado (nombres, emociones, claves de recursos)
+typedef uint32_t Symbol;
+const Symbol NO_SYMBOL = 0;   // El string vacío
+
+// Tabla global de strings internados. Cada string distinto recibe un id
+// pequeño y consecutivo una sola vez (al compilar o cargar el capítulo);
+// a partir de ahí el código caliente compara y busca por id.
+class StringInterner {
+private:
+    std::deque<std::string> strings;                   // Direcciones estables
+    std::unordered_map<std::string_view, Symbol> ids;  // Vistas sobre strings
+    mutable std::mutex mutex;                          // Se puede internar desde cualquier hilo
+
+    StringInterner();
+
+public:
+    static StringInterner* GetInstance();
+
+    Symbol Intern(std::string_view str);
+    // Referencia estable mientras viva el interner
+    const std::string& GetString(Symbol id) const;
+    size_t GetCount() const;
+};
+
+inline Symbol Intern(std::string_view str) {
+    return StringInterner::GetInstance()->Intern(str);
+}
+
+inline const std::string& SymbolName(Symbol id) {
+    return StringInterner::GetInstance()->GetString(id);
+}
+
+// Tabla plana indexada por símbolo: la búsqueda son dos accesos a vector y
+// el recorrido es denso. Borrar mueve el último elemento al hueco.
+template <typename T>
+class SymbolTable {
+private:
+    std::vector<uint32_t> slots;                 // Símbolo -> posición en entries + 1 (0: ausente)
+    std::vector<std::pair<Symbol, T>> entries;
+
+public:
+    typedef typename std::vector<std::pair<Symbol, T>>::iterator iterator;
+    typedef typename std::vector<std::pair<Symbol, T>>::const_iterator const_iterator;
+
+    T* Find(Symbol id) {
+        if (id >= slots.size() || slots[id] == 0) return nullptr;
+        return &entries[slots[id] - 1].second;
+    }
+
+    const T* Find(Symbol id) const {
+        if (id >= slots.size() || slots[id] == 0) return nullptr;
+        return &entries[slots[id] - 1].second;
+    }
+
+    bool Contains(Symbol id) const { return id < slots.size() && slots[id] != 0; }
+
+    // Inserta un valor por defecto si no existe
+    T& operator[](Symbol id) {
+        if (id >= slots.size()) {
+            slots.resize(id + 1, 0);
+        }
+        if (slots[id] == 0) {
+            entries.emplace_back(id, T());
+            slots[id] = (uint32_t)entries.size();
+        }
+        return entries[slots[id] - 1].second;
+    }
+
+    bool Erase(Symbol id) {
+        if (!Contains(id)) return false;
+        uint32_t index = slots[id] - 1;
+        if (index != entries.size() - 1) {
+            entries[index] = std::move(entries.back());
+            slots[entries[index].first] = index + 1;
+        }
+        entries.pop_back();
+        slots[id] = 0;
+        return true;
+    }
+
+    void Clear() {
+        slots.clear();
+        entries.clear();
+    }
+
+    size_t Size() const { return entries.size(); }
+    bool Empty() const { return entries.empty(); }
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+};
+
+#endif // STRING_INTERNER_H
@@ -0,0 +1,78 @@
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include "raylib.h"
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Glifo ya colocado: rectángulos de origen (textura de la fuente) y destino
+// (relativo al origen del texto) listos para DrawTexturePro
+struct LayoutGlyph {
+    Rectangle source;
+    Rectangle dest;
+    uint32_t textIndex;    // Codepoint del texto al que corresponde el glifo
+};
+
+// Word wrap de un texto con una fuente, tamaño y ancho dados. Los espacios y
+// saltos de línea no generan glifos.
+class TextLayout {
+private:
+    std::vector<LayoutGlyph> glyphs;
+    Texture2D fontTexture;
+    float height;
+
+public:
+    TextLayout();
+
+    void Build(std::string_view text, const Font& font, float fontSize, float spacing,
+               float lineSpacing, float maxWidth);
+
+    // Glifos de los primeros N codepoints del texto (prefijo visible)
+    size_t CountGlyphsBefore(size_t codepoints) const;
+    void Draw(Vector2 position, size_t glyphCount, Color tint) const;
+
+    size_t GetGlyphCount() const { return glyphs.size(); }
+    float GetHeight() const { return height; }
+};
+
+// Layouts por línea de diálogo: se calculan una vez y se reutilizan mientras
+// no cambien la fuente, el tamaño o el ancho disponible
+class TextLayoutCache {
+private:
+    struct Key {
+        uint32_t textId;
+        unsigned int fontTexture;
+        int fontSize;
+        int maxWidth;
+
+        bool operator==(const Key& other) const {
+            return textId == other.textId && fontTexture == other.fontTexture &&
+                   fontSize == other.fontSize && maxWidth == other.maxWidth;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            size_t h = key.textId;
+            h = h * 31 + key.fontTexture;
+            h = h * 31 + (size_t)key.fontSize;
+            h = h * 31 + (size_t)key.maxWidth;
+            return h;
+        }
+    };
+
+    std::unordered_map<Key, TextLayout, KeyHash> layouts;
+    size_t capacity;
+
+public:
+    TextLayoutCache(size_t maxLayouts = 64);
+
+    // textId identifica el texto (id de string del capítulo)
+    const TextLayout& Get(uint32_t textId, std::string_view text, const Font& font,
+                          float fontSize, float spacing, float lineSpacing, float maxWidth);
+    void Clear() { layouts.clear(); }
+    size_t GetSize() const { return layouts.size(); }
+};
+
+#endif // TEXT_LAYOUT_H
@@ -0,0 +1,89 @@
+#ifndef VOICE_PLAYER_H
+#define VOICE_PLAYER_H
+
+#include "raylib.h"
+#include "asset_pack.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+#include <cstdint>
+
+class DialogueSystem;
+class SceneManager;
+
+struct VoiceStats {
+    uint64_t played;
+    uint64_t late;          // La línea avanzó antes de que su clip estuviera listo
+    int windowClips;        // Clips con voz abiertos ahora mismo
+    size_t windowBytes;     // Datos comprimidos en memoria de esos clips
+};
+
+// Voces por línea (voice/<idioma>/<capítulo>/<línea>.ogg, ver ResourceManager)
+//
+// Los clips se reproducen como streams: se decodifican mientras suenan desde
+// sus bytes comprimidos, nunca enteros en memoria. Solo se tienen abiertos
+// los de la línea actual y las lookahead siguientes: los sueltos los leen
+// del disco los workers del cargador y los del pack ya están mapeados. Da
+// igual cuántas líneas con voz tenga un capítulo, la memoria es la de esa
+// ventana. Las líneas sin voz se recuerdan y no se vuelven a buscar.
+//
+// Al avanzar (o volver atrás) se corta la voz anterior y empieza la de la
+// nueva línea; la música baja mientras suena (SceneManager::SetMusicDucking).
+class VoicePlayer {
+private:
+    struct VoiceClip {
+        size_t line;
+        std::string fileType;                 // ".ogg", ".wav"
+        PackEntry entry;                      // Del pack: datos mapeados
+        std::vector<unsigned char> bytes;     // Suelto: lo escribe el worker hasta que read esté listo
+        std::future<bool> read;
+        Music music;                          // Stream abierto sobre entry o bytes
+        bool packed;
+    };
+
+    static const size_t NO_LINE = (size_t)-1;
+
+    size_t lookahead;
+    std::string chapterName;
+    uint32_t chapterGeneration;
+    bool looseVoices;           // El capítulo tiene carpeta de voces sueltas
+    std::vector<bool> silent;   // Líneas ya buscadas sin voz, por índice
+    size_t shownLine;           // Línea cuya voz ya se pidió
+    bool waiting;               // Su clip aún no estaba abierto
+    float waitTime;
+    // La lectura en marcha guarda su propia referencia: un clip que sale de
+    // la ventana a medio leer se libera al terminar
+    std::vector<std::shared_ptr<VoiceClip>> clips;
+    VoiceStats stats;
+
+    VoiceClip* Find(size_t line);
+    bool IsSilent(size_t line) const;
+    void MarkSilent(size_t line);
+    void Start(size_t line);
+    bool Open(VoiceClip& clip);    // Ya leído; false si la línea no tiene voz
+    void Close(VoiceClip& clip);   // La voz tiene que estar ya parada si era este clip
+    void CloseAll(SceneManager& scene);
+
+    static bool IsRead(const VoiceClip& clip);
+
+public:
+    static const int MAX_WAIT_MS = 300;   // Lo que puede llegar tarde una voz y seguir sonando
+
+    VoicePlayer(size_t lines = 3);
+    ~VoicePlayer();
+
+    void SetLookahead(size_t lines) { lookahead = lines; }
+
+    // Llamar cada frame después de procesar la entrada: mueve la ventana a la
+    // línea actual y empieza su voz si acaba de mostrarse
+    void Update(const DialogueSystem& dialogue, const std::string& chapter, SceneManager& scene,
+                float deltaTime);
+
+    // Corta la voz y cierra todos los clips (antes de liberar el audio)
+    void Reset(SceneManager& scene);
+
+    VoiceStats GetStats() const;
+};
+
+#endif // VOICE_PLAYER_H
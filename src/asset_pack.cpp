@@ -0,0 +1,314 @@
+// Sin headers de raylib: <windows.h> choca con sus nombres (Rectangle, DrawText...)
+#include "asset_pack.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#define NOUSER
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+struct PackHeader {
+    char magic[4];          // "NXPK"
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t tocOffset;
+    uint64_t keysOffset;
+};
+static_assert(sizeof(PackHeader) == 32, "PackHeader debe ocupar 32 bytes");
+
+struct PackTocEntry {
+    uint32_t keyOffset;     // Relativo al bloque de claves
+    uint32_t keyLength;
+    uint64_t dataOffset;    // Relativo al inicio del archivo
+    uint64_t dataSize;
+    char fileType[8];       // Extensión con punto, terminada en '\0'
+};
+static_assert(sizeof(PackTocEntry) == 32, "PackTocEntry debe ocupar 32 bytes");
+
+const AssetFolder BACKGROUND_ASSETS = { "backgrounds", "bg_", { ".png", nullptr } };
+const AssetFolder CG_ASSETS = { "cgs", "cg_", { ".png", nullptr } };
+const AssetFolder MUSIC_ASSETS = { "music", "music_", { ".ogg", ".mp3" } };
+const AssetFolder SOUND_ASSETS = { "sfx", "sfx_", { ".wav", ".ogg" } };
+const AssetFolder GUI_ASSETS = { "gui", "gui_", { ".png", nullptr } };
+const AssetFolder VOICE_ASSETS = { "voice", "voice/", { ".ogg", ".wav" } };
+
+static const char PACK_MAGIC[4] = { 'N', 'X', 'P', 'K' };
+static const size_t PACK_DATA_ALIGNMENT = 16;
+
+//------------------------------------------------------------------------------
+// MappedFile
+//------------------------------------------------------------------------------
+
+MappedFile::MappedFile()
+    : data(nullptr), size(0),
+#ifdef _WIN32
+      fileHandle(nullptr), mappingHandle(nullptr) {
+#else
+      fd(-1) {
+#endif
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(handle);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+
+    fileHandle = handle;
+    mappingHandle = mapping;
+    data = (const unsigned char*)view;
+    size = (size_t)fileSize.QuadPart;
+#else
+    int handle = open(path.c_str(), O_RDONLY);
+    if (handle < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(handle, &info) != 0 || info.st_size == 0) {
+        close(handle);
+        return false;
+    }
+
+    void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+    if (view == MAP_FAILED) {
+        close(handle);
+        return false;
+    }
+
+    fd = handle;
+    data = (const unsigned char*)view;
+    size = (size_t)info.st_size;
+#endif
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data == nullptr) return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle((HANDLE)mappingHandle);
+    CloseHandle((HANDLE)fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    munmap((void*)data, size);
+    close(fd);
+    fd = -1;
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+//------------------------------------------------------------------------------
+// AssetPack
+//------------------------------------------------------------------------------
+
+AssetPack::AssetPack() : toc(nullptr), entryCount(0), keys(nullptr) {
+}
+
+AssetPack::~AssetPack() {
+    Close();
+}
+
+bool AssetPack::Open(const std::string& path) {
+    Close();
+    if (!file.Open(path)) {
+        return false;
+    }
+
+    const unsigned char* base = file.GetData();
+    size_t fileSize = file.GetSize();
+
+    PackHeader header;
+    if (fileSize < sizeof(header)) {
+        Close();
+        return false;
+    }
+    memcpy(&header, base, sizeof(header));
+
+    if (memcmp(header.magic, PACK_MAGIC, 4) != 0 || header.version != VERSION ||
+        header.tocOffset + (uint64_t)header.entryCount * sizeof(PackTocEntry) > fileSize ||
+        header.keysOffset > fileSize) {
+        std::cerr << "Warning: Invalid asset pack: " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    toc = (const PackTocEntry*)(base + header.tocOffset);
+    entryCount = header.entryCount;
+    keys = (const char*)(base + header.keysOffset);
+
+    for (uint32_t i = 0; i < entryCount; i++) {
+        if (header.keysOffset + toc[i].keyOffset + toc[i].keyLength > fileSize ||
+            toc[i].dataOffset + toc[i].dataSize > fileSize) {
+            std::cerr << "Warning: Corrupt asset pack entry in: " << path << std::endl;
+            Close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void AssetPack::Close() {
+    file.Close();
+    toc = nullptr;
+    entryCount = 0;
+    keys = nullptr;
+}
+
+bool AssetPack::Find(std::string_view key, PackEntry& out) const {
+    if (!IsOpen()) {
+        return false;
+    }
+
+    uint32_t low = 0;
+    uint32_t high = entryCount;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        std::string_view midKey(keys + toc[mid].keyOffset, toc[mid].keyLength);
+        int cmp = midKey.compare(key);
+        if (cmp == 0) {
+            out.data = file.GetData() + toc[mid].dataOffset;
+            out.size = (size_t)toc[mid].dataSize;
+            out.fileType = toc[mid].fileType;
+            return true;
+        }
+        if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// AssetPackWriter
+//------------------------------------------------------------------------------
+
+bool AssetPackWriter::Add(const std::string& key, const std::string& sourcePath) {
+    size_t dot = sourcePath.find_last_of('.');
+    std::string fileType = (dot != std::string::npos) ? sourcePath.substr(dot) : "";
+    if (fileType.size() >= sizeof(PackTocEntry::fileType)) {
+        std::cerr << "Warning: Extension too long, skipping: " << sourcePath << std::endl;
+        return false;
+    }
+
+    for (auto& entry : entries) {
+        if (entry.key == key) {
+            // La primera ruta añadida tiene prioridad (mismo orden que los fallbacks)
+            return false;
+        }
+    }
+
+    entries.push_back({ key, fileType, sourcePath });
+    return true;
+}
+
+bool AssetPackWriter::Write(const std::string& path) {
+    std::sort(entries.begin(), entries.end(),
+              [](const PendingEntry& a, const PendingEntry& b) { return a.key < b.key; });
+
+    std::string keyBlob;
+    for (const auto& entry : entries) {
+        keyBlob += entry.key;
+    }
+
+    PackHeader header;
+    memcpy(header.magic, PACK_MAGIC, 4);
+    header.version = AssetPack::VERSION;
+    header.entryCount = (uint32_t)entries.size();
+    header.reserved = 0;
+    header.tocOffset = sizeof(PackHeader);
+    header.keysOffset = header.tocOffset + entries.size() * sizeof(PackTocEntry);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not write asset pack: " << path << std::endl;
+        return false;
+    }
+
+    // Reservar cabecera y tabla; se reescriben al final con los offsets reales
+    std::vector<PackTocEntry> tocEntries(entries.size());
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)tocEntries.data(), tocEntries.size() * sizeof(PackTocEntry));
+    out.write(keyBlob.data(), keyBlob.size());
+
+    uint64_t offset = header.keysOffset + keyBlob.size();
+    uint32_t keyOffset = 0;
+    std::vector<char> buffer;
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        std::ifstream in(entries[i].sourcePath, std::ios::binary | std::ios::ate);
+        if (!in.is_open()) {
+            std::cerr << "Error: Could not read: " << entries[i].sourcePath << std::endl;
+            return false;
+        }
+        std::streamsize fileSize = in.tellg();
+        in.seekg(0);
+        buffer.resize((size_t)fileSize);
+        in.read(buffer.data(), fileSize);
+
+        // Alinear los datos para que los decodificadores lean directamente
+        while (offset % PACK_DATA_ALIGNMENT != 0) {
+            out.put('\0');
+            offset++;
+        }
+
+        PackTocEntry& toc = tocEntries[i];
+        memset(&toc, 0, sizeof(toc));
+        toc.keyOffset = keyOffset;
+        toc.keyLength = (uint32_t)entries[i].key.size();
+        toc.dataOffset = offset;
+        toc.dataSize = (uint64_t)fileSize;
+        memcpy(toc.fileType, entries[i].fileType.c_str(), entries[i].fileType.size() + 1);
+
+        out.write(buffer.data(), fileSize);
+        offset += (uint64_t)fileSize;
+        keyOffset += toc.keyLength;
+    }
+
+    out.seekp((std::streamoff)header.tocOffset);
+    out.write((const char*)tocEntries.data(), tocEntries.size() * sizeof(PackTocEntry));
+    return out.good();
+}
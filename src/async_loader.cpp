@@ -0,0 +1,197 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "profiler.h"
+#include "async_loader.h"
+
+AssetRequest::AssetRequest(Symbol assetKey, AssetKind assetKind)
+    : key(assetKey), kind(assetKind), packData(nullptr), packSize(0),
+      state(AssetState::PENDING), sizeBytes(0), interested(0) {
+    image = (Image){ 0 };
+    wave = (Wave){ 0 };
+    texture = (Texture2D){ 0 };
+    sound = (Sound){ 0 };
+    music = (Music){ 0 };
+}
+
+bool AssetRequest::IsDone() const {
+    AssetState s = state.load();
+    return s == AssetState::READY || s == AssetState::FAILED || s == AssetState::CANCELLED;
+}
+
+AsyncLoader::AsyncLoader() : stopping(false) {
+}
+
+AsyncLoader::~AsyncLoader() {
+    Stop();
+}
+
+void AsyncLoader::Start(int threadCount) {
+    if (!workers.empty()) return;
+
+    if (threadCount <= 0) {
+        int cores = (int)std::thread::hardware_concurrency();
+        threadCount = (cores > 1) ? cores - 1 : 1;
+        if (threadCount > 4) threadCount = 4;
+    }
+
+    stopping = false;
+    for (int i = 0; i < threadCount; i++) {
+        workers.emplace_back(&AsyncLoader::WorkerLoop, this);
+    }
+}
+
+void AsyncLoader::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(decodeMutex);
+        stopping = true;
+    }
+    decodeCondition.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+
+    // Liberar lo que quedó a medias
+    std::lock_guard<std::mutex> decodeLock(decodeMutex);
+    std::lock_guard<std::mutex> uploadLock(uploadMutex);
+    for (auto& request : decodeQueue) {
+        request->state = AssetState::CANCELLED;
+    }
+    for (auto& request : uploadQueue) {
+        ReleaseDecoded(*request);
+        request->state = AssetState::CANCELLED;
+    }
+    decodeQueue.clear();
+    uploadQueue.clear();
+    jobQueue.clear();
+}
+
+void AsyncLoader::Submit(const AssetHandle& request) {
+    {
+        std::lock_guard<std::mutex> lock(decodeMutex);
+        decodeQueue.push_back(request);
+    }
+    decodeCondition.notify_one();
+}
+
+void AsyncLoader::SubmitJob(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(decodeMutex);
+        jobQueue.push_back(std::move(job));
+    }
+    decodeCondition.notify_one();
+}
+
+bool AsyncLoader::PopDecoded(AssetHandle& request) {
+    std::lock_guard<std::mutex> lock(uploadMutex);
+    if (uploadQueue.empty()) {
+        return false;
+    }
+    request = uploadQueue.front();
+    uploadQueue.pop_front();
+    return true;
+}
+
+void AsyncLoader::WorkerLoop() {
+    Profiler::GetInstance()->SetThreadName("AsyncLoader");
+
+    while (true) {
+        AssetHandle request;
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(decodeMutex);
+            decodeCondition.wait(lock, [this] {
+                return stopping || !decodeQueue.empty() || !jobQueue.empty();
+            });
+            if (stopping) return;
+            // Las decodificaciones primero: son las que espera la pantalla
+            if (!decodeQueue.empty()) {
+                request = decodeQueue.front();
+                decodeQueue.pop_front();
+            } else {
+                job = std::move(jobQueue.front());
+                jobQueue.pop_front();
+            }
+        }
+
+        if (job) {
+            job();
+            continue;
+        }
+
+        // Cancelada antes de empezar: no tocar el disco
+        if (request->state.load() == AssetState::PENDING) {
+            Decode(*request);
+        }
+
+        std::lock_guard<std::mutex> lock(uploadMutex);
+        uploadQueue.push_back(request);
+    }
+}
+
+void AsyncLoader::Decode(AssetRequest& request) {
+    PROFILE_SCOPE("AsyncLoader::Decode");
+    bool packed = request.packData != nullptr;
+    if (!packed) {
+        for (const auto& candidate : request.candidates) {
+            if (FileExists(candidate.c_str())) {
+                request.path = candidate;
+                break;
+            }
+        }
+    }
+
+    bool ok = packed || !request.path.empty();
+    if (ok) {
+        switch (request.kind) {
+            case AssetKind::TEXTURE:
+                request.image = packed
+                    ? LoadImageFromMemory(request.fileType.c_str(), request.packData, (int)request.packSize)
+                    : LoadImage(request.path.c_str());
+                ok = request.image.data != nullptr;
+                if (ok) {
+                    request.sizeBytes = GetPixelDataSize(request.image.width, request.image.height,
+                                                         request.image.format);
+                }
+                break;
+
+            case AssetKind::SOUND:
+                request.wave = packed
+                    ? LoadWaveFromMemory(request.fileType.c_str(), request.packData, (int)request.packSize)
+                    : LoadWave(request.path.c_str());
+                ok = request.wave.data != nullptr;
+                if (ok) {
+                    request.sizeBytes = (size_t)request.wave.frameCount * request.wave.channels *
+                                        request.wave.sampleSize / 8;
+                }
+                break;
+
+            case AssetKind::MUSIC:
+                // El stream se abre en el hilo principal; aquí solo se resuelve la ruta
+                break;
+        }
+    }
+
+    AssetState expected = AssetState::PENDING;
+    AssetState result = ok ? AssetState::DECODED : AssetState::FAILED;
+    if (!request.state.compare_exchange_strong(expected, result)) {
+        // Se canceló mientras se decodificaba
+        ReleaseDecoded(request);
+    }
+}
+
+void AsyncLoader::ReleaseDecoded(AssetRequest& request) {
+    if (request.image.data != nullptr) {
+        UnloadImage(request.image);
+        request.image = (Image){ 0 };
+    }
+    if (request.wave.data != nullptr) {
+        UnloadWave(request.wave);
+        request.wave = (Wave){ 0 };
+    }
+}
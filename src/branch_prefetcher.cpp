@@ -0,0 +1,224 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "profiler.h"
+#include "branch_prefetcher.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+BranchPrefetcher::BranchPrefetcher(size_t lines)
+    : lookahead(lines), preparedGeneration(0), preparedExit(ScriptChapter::NO_EXIT) {
+}
+
+BranchPrefetcher::~BranchPrefetcher() {
+    CancelRequests();
+}
+
+bool BranchPrefetcher::IsParsed(const PreparedChapter& prepared) {
+    return !prepared.parsed.valid() ||
+           prepared.parsed.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void BranchPrefetcher::Collect(PreparedChapter& prepared) {
+    if (prepared.parsed.valid()) {
+        prepared.loaded = prepared.parsed.get();
+        if (!prepared.loaded) {
+            std::cerr << "Warning: Could not prepare branch chapter: " << prepared.path << std::endl;
+        }
+    }
+}
+
+void BranchPrefetcher::Update(const DialogueSystem& dialogue) {
+    PROFILE_SCOPE("BranchPrefetcher::Update");
+    const ScriptChapter& chapter = dialogue.GetChapter();
+    size_t current = dialogue.GetCurrentLineIndex();
+
+    size_t exit = chapter.FindNextExit(current);
+    if (exit != ScriptChapter::NO_EXIT && chapter.GetExit(exit).line <= current + lookahead &&
+        (exit != preparedExit || dialogue.GetChapterGeneration() != preparedGeneration)) {
+        preparedExit = exit;
+        preparedGeneration = dialogue.GetChapterGeneration();
+        Prepare(chapter, chapter.GetExit(exit));
+    }
+
+    // Capítulos recién compilados: pedir lo que se ve al entrar en cada destino
+    for (auto& prepared : chapters) {
+        if (prepared->scanned || !IsParsed(*prepared)) {
+            continue;
+        }
+        Collect(*prepared);
+        prepared->scanned = true;
+        if (!prepared->loaded) {
+            continue;
+        }
+        for (Symbol label : prepared->labels) {
+            uint32_t line = (label == NO_SYMBOL) ? 0 : prepared->chapter.GetLabelLine(label);
+            if (line != ScriptChapter::UNRESOLVED_LINE) {
+                RequestLines(prepared->chapter, line);
+            }
+        }
+    }
+}
+
+void BranchPrefetcher::Prepare(const ScriptChapter& chapter, const ScriptExit& exit) {
+    PROFILE_SCOPE("BranchPrefetcher::Prepare");
+    CancelRequests();
+
+    // Lo ya compilado para la salida anterior se aprovecha si vuelve a ser destino
+    std::vector<std::shared_ptr<PreparedChapter>> previous;
+    previous.swap(chapters);
+
+    for (uint32_t i = 0; i < exit.branchCount; i++) {
+        const ScriptBranch& branch = chapter.GetBranch(exit.firstBranch + i);
+        if (branch.chapter == 0) {
+            // Destino en este capítulo: ya resuelto al compilar (o aún sin compilar en el stream)
+            if (branch.line != ScriptChapter::UNRESOLVED_LINE) {
+                RequestLines(chapter, branch.line);
+            }
+            continue;
+        }
+
+        PreparedChapter* prepared = FindOrStart(SymbolName(chapter.GetSymbol(branch.chapter)), previous);
+        Symbol label = chapter.GetSymbol(branch.label);
+        if (std::find(prepared->labels.begin(), prepared->labels.end(), label) == prepared->labels.end()) {
+            prepared->labels.push_back(label);
+        }
+    }
+}
+
+BranchPrefetcher::PreparedChapter* BranchPrefetcher::FindOrStart(
+        const std::string& fileName, std::vector<std::shared_ptr<PreparedChapter>>& previous) {
+    for (auto& prepared : chapters) {
+        if (prepared->fileName == fileName) {
+            return prepared.get();
+        }
+    }
+    for (auto& prepared : previous) {
+        if (prepared && prepared->fileName == fileName) {
+            prepared->labels.clear();
+            prepared->scanned = false;
+            chapters.push_back(std::move(prepared));
+            return chapters.back().get();
+        }
+    }
+
+    // Ruta y entrada del pack se resuelven aquí; el worker no toca el ResourceManager
+    ResourceManager* resources = ResourceManager::GetInstance();
+    std::shared_ptr<PreparedChapter> prepared = std::make_shared<PreparedChapter>();
+    prepared->fileName = fileName;
+    prepared->path = resources->GetDialoguePath(fileName);
+    prepared->loaded = false;
+    prepared->scanned = false;
+
+    PackEntry entry;
+    bool packed = resources->FindPackedAsset(
+        resources->GetDialoguePackKey(ScriptChapter::GetCompiledPath(fileName)), entry);
+    auto compile = std::make_shared<std::packaged_task<bool()>>([prepared, packed, entry]() {
+        PROFILE_SCOPE("BranchPrefetcher::Compile");
+        DialogueParser parser(nullptr);
+        return parser.ReadChapter(prepared->path, packed ? &entry : nullptr, prepared->chapter);
+    });
+    prepared->parsed = compile->get_future();
+    resources->RunInBackground([compile]() { (*compile)(); });
+
+    chapters.push_back(prepared);
+    return prepared.get();
+}
+
+void BranchPrefetcher::RequestLines(const ScriptChapter& chapter, size_t firstLine) {
+    ResourceManager* resources = ResourceManager::GetInstance();
+    size_t lineCount = chapter.GetLineCount();
+    size_t end = std::min(firstLine + TARGET_LINES, lineCount);
+    if (firstLine >= end) {
+        return;
+    }
+
+    // Bloques de las primeras líneas del destino, hasta el SAY de la última
+    size_t offset = chapter.GetLineOffset(firstLine);
+    size_t stop = (end < lineCount) ? chapter.GetLineOffset(end) : chapter.GetCodeSize();
+    ScriptInstruction inst;
+    while (offset < stop) {
+        offset = chapter.Decode(offset, inst);
+        switch (inst.op) {
+            case OpCode::BACKGROUND:
+                requests.push_back(resources->RequestBackground(chapter.GetSymbol(inst.arg1)));
+                break;
+
+            case OpCode::MUSIC:
+                requests.push_back(resources->RequestMusic(chapter.GetSymbol(inst.arg1)));
+                break;
+
+            case OpCode::SFX:
+                requests.push_back(resources->RequestSound(chapter.GetSymbol(inst.arg1)));
+                break;
+
+            case OpCode::CHARACTER:
+                requests.push_back(resources->RequestCharacterSprite(chapter.GetSymbol(inst.arg1),
+                                                                     chapter.GetSymbol(inst.arg2)));
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+void BranchPrefetcher::CancelRequests() {
+    // Sin nada en vuelo no se toca el ResourceManager (puede estar ya destruido)
+    requests.erase(std::remove_if(requests.begin(), requests.end(),
+                                  [](const AssetHandle& h) { return h->IsDone(); }),
+                   requests.end());
+    if (requests.empty()) {
+        return;
+    }
+
+    ResourceManager* resources = ResourceManager::GetInstance();
+    for (auto& handle : requests) {
+        resources->CancelRequest(handle);
+    }
+    requests.clear();
+}
+
+bool BranchPrefetcher::Enter(const std::string& fileName, Symbol label, DialogueParser& parser,
+                             DialogueSystem& dialogue) {
+    PROFILE_SCOPE("BranchPrefetcher::Enter");
+    bool loaded = false;
+    for (auto it = chapters.begin(); it != chapters.end(); ++it) {
+        PreparedChapter& prepared = **it;
+        if (prepared.fileName != fileName) {
+            continue;
+        }
+        // Elegido antes de terminar de compilarse: solo se espera lo que falte
+        Collect(prepared);
+        if (prepared.loaded) {
+            dialogue.LoadChapter(std::move(prepared.chapter), prepared.path);
+            loaded = true;
+        }
+        chapters.erase(it);
+        break;
+    }
+
+    // Sin preparar (salida alcanzada sin pasar por la ventana): carga normal
+    if (!loaded && !parser.LoadDialogueFile(fileName, dialogue)) {
+        return false;
+    }
+
+    if (label != NO_SYMBOL && !dialogue.JumpToLabel(label)) {
+        std::cerr << "Warning: Undefined label: " << SymbolName(label) << " in " << fileName << std::endl;
+    }
+
+    // Lo pedido para los destinos sigue en la caché; el resto ya no hace falta
+    chapters.clear();
+    preparedExit = ScriptChapter::NO_EXIT;
+    return true;
+}
+
+void BranchPrefetcher::Reset() {
+    CancelRequests();
+    chapters.clear();
+    preparedExit = ScriptChapter::NO_EXIT;
+}
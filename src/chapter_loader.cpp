@@ -0,0 +1,222 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "profiler.h"
+#include "chapter_loader.h"
+#include <algorithm>
+#include <iostream>
+#include <cctype>
+#include <cstdlib>
+
+ChapterLoader::ChapterLoader()
+    : completedRequests(0), failedRequests(0), loading(false), savedUploadBudget(0) {
+}
+
+ChapterLoader::~ChapterLoader() {
+}
+
+void ChapterLoader::LoadManifest(const std::string& fileName, const ScriptChapter& chapter) {
+    ResourceManager* resources = ResourceManager::GetInstance();
+    std::string manifestName = ChapterManifest::GetManifestPath(fileName);
+
+    PackEntry entry;
+    if (resources->FindPackedAsset(resources->GetDialoguePackKey(manifestName), entry)) {
+        manifest.LoadFromText((const char*)entry.data, entry.size);
+        return;
+    }
+
+    // Igual que con el .nxb: un manifiesto más viejo que el script puede estar incompleto
+    std::string path = resources->GetDialoguePath(fileName);
+    std::string manifestPath = ChapterManifest::GetManifestPath(path);
+    if (FileExists(manifestPath.c_str()) &&
+        (!FileExists(path.c_str()) || GetFileModTime(manifestPath.c_str()) >= GetFileModTime(path.c_str())) &&
+        manifest.LoadFromFile(manifestPath)) {
+        return;
+    }
+
+    // Sin manifiesto: lo que ya esté compilado (el capítulo entero si venía en
+    // bytecode, el primer tramo si se compila del texto; el resto lo trae el prefetcher)
+    manifest.Clear();
+    manifest.CollectFrom(chapter);
+}
+
+void ChapterLoader::RequestPinned(const AssetHandle& request) {
+    requests.push_back(request);
+    pinnedKeys.push_back(request->key);
+}
+
+void ChapterLoader::RequestLines(const ScriptChapter& chapter, size_t firstLine) {
+    ResourceManager* resources = ResourceManager::GetInstance();
+    size_t lineCount = chapter.GetLineCount();
+    size_t end = std::min(firstLine + FIRST_LINES, lineCount);
+    if (firstLine >= end) {
+        return;
+    }
+
+    // Bloques de las primeras líneas, hasta el SAY de la última
+    size_t offset = chapter.GetLineOffset(firstLine);
+    size_t stop = (end < lineCount) ? chapter.GetLineOffset(end) : chapter.GetCodeSize();
+    ScriptInstruction inst;
+    while (offset < stop) {
+        offset = chapter.Decode(offset, inst);
+        switch (inst.op) {
+            case OpCode::BACKGROUND:
+                RequestPinned(resources->RequestBackground(chapter.GetSymbol(inst.arg1)));
+                break;
+
+            case OpCode::MUSIC:
+                RequestPinned(resources->RequestMusic(chapter.GetSymbol(inst.arg1)));
+                break;
+
+            case OpCode::SFX:
+                RequestPinned(resources->RequestSound(chapter.GetSymbol(inst.arg1)));
+                break;
+
+            case OpCode::CHARACTER:
+                RequestPinned(resources->RequestCharacterSprite(chapter.GetSymbol(inst.arg1),
+                                                                chapter.GetSymbol(inst.arg2)));
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+void ChapterLoader::Finish() {
+    ResourceManager* resources = ResourceManager::GetInstance();
+    resources->SetUploadBudget(savedUploadBudget);
+    pinnedKeys.clear();
+    resources->SetPinnedKeys(PinGroup::LOADING, pinnedKeys);
+    loading = false;
+}
+
+bool ChapterLoader::Begin(const std::string& fileName, DialogueParser& parser, DialogueSystem& dialogue,
+                          const SceneState* scene, size_t firstLine) {
+    PROFILE_SCOPE("ChapterLoader::Begin");
+    ResourceManager* resources = ResourceManager::GetInstance();
+
+    // Lo pedido para un capítulo anterior que no terminó de cargar se queda en la caché
+    if (loading) {
+        Finish();
+    }
+    requests.clear();
+    completedRequests = 0;
+    failedRequests = 0;
+
+    if (!parser.LoadDialogueFile(fileName, dialogue)) {
+        return false;
+    }
+    LoadManifest(fileName, dialogue.GetChapter());
+
+    // Todo a la vez: los workers decodifican en paralelo y Update sube lo que esté listo
+    requests.reserve(manifest.Size() + 2);
+    if (scene != nullptr) {
+        // Lo que se ve al reanudar va delante en la cola (repetidos: mismo handle)
+        if (scene->background != NO_SYMBOL) {
+            RequestPinned(resources->RequestBackground(scene->background));
+        }
+        if (scene->music != NO_SYMBOL) {
+            RequestPinned(resources->RequestMusic(scene->music));
+        }
+        for (const CharacterState& character : scene->characters) {
+            RequestPinned(resources->RequestCharacterSprite(character.name, character.emotion));
+        }
+    }
+    RequestLines(dialogue.GetChapter(), firstLine);
+    // Son los primeros en subirse, así que los menos usados: sin fijarlos el
+    // resto del manifiesto los expulsaría si no cabe entero en la caché
+    resources->SetPinnedKeys(PinGroup::LOADING, pinnedKeys);
+    for (const ManifestEntry& entry : manifest.GetEntries()) {
+        switch (entry.type) {
+            case ManifestAsset::BACKGROUND:
+                requests.push_back(resources->RequestBackground(entry.name));
+                break;
+            case ManifestAsset::MUSIC:
+                requests.push_back(resources->RequestMusic(entry.name));
+                break;
+            case ManifestAsset::SOUND:
+                requests.push_back(resources->RequestSound(entry.name));
+                break;
+            case ManifestAsset::SPRITE:
+                requests.push_back(resources->RequestCharacterSprite(entry.name, entry.emotion));
+                break;
+        }
+    }
+
+    savedUploadBudget = resources->GetUploadBudget();
+    resources->SetUploadBudget(LOADING_UPLOAD_BUDGET);
+    loading = true;
+
+    Update();
+    return true;
+}
+
+void ChapterLoader::Update() {
+    if (!loading) {
+        return;
+    }
+
+    ResourceManager* resources = ResourceManager::GetInstance();
+    resources->ProcessUploads();
+
+    completedRequests = 0;
+    failedRequests = 0;
+    for (const AssetHandle& request : requests) {
+        if (request->IsDone()) {
+            completedRequests++;
+            if (!request->IsReady()) {
+                failedRequests++;
+            }
+        }
+    }
+
+    if (completedRequests == requests.size()) {
+        // Los recursos quedan en la caché; el capítulo los fija al usarlos
+        Finish();
+        requests.clear();
+        if (failedRequests > 0) {
+            std::cerr << "Warning: " << failedRequests << " chapter assets failed to load" << std::endl;
+        }
+    }
+}
+
+float ChapterLoader::GetProgress() const {
+    if (!loading) {
+        return 1.0f;
+    }
+    // El capítulo ya abierto cuenta como un paso más
+    return (float)(completedRequests + 1) / (float)(requests.size() + 1);
+}
+
+bool ChapterLoader::ChapterExists(const std::string& fileName) {
+    if (fileName.empty()) {
+        return false;
+    }
+    ResourceManager* resources = ResourceManager::GetInstance();
+    PackEntry entry;
+    if (resources->FindPackedAsset(resources->GetDialoguePackKey(ScriptChapter::GetCompiledPath(fileName)), entry)) {
+        return true;
+    }
+    std::string path = resources->GetDialoguePath(fileName);
+    return FileExists(path.c_str()) || FileExists(ScriptChapter::GetCompiledPath(path).c_str());
+}
+
+std::string ChapterLoader::GetNextChapterName(const std::string& fileName) {
+    size_t end = fileName.find_last_of('.');
+    if (end == std::string::npos) {
+        end = fileName.size();
+    }
+    size_t start = end;
+    while (start > 0 && isdigit((unsigned char)fileName[start - 1])) {
+        start--;
+    }
+    if (start == end) {
+        return "";
+    }
+    int number = atoi(fileName.substr(start, end - start).c_str());
+    return fileName.substr(0, start) + std::to_string(number + 1) + fileName.substr(end);
+}
@@ -0,0 +1,119 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "chapter_manifest.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+void ChapterManifest::Add(ManifestAsset type, Symbol name, Symbol emotion) {
+    if (name == NO_SYMBOL) {
+        return;
+    }
+    if (seen.insert(std::make_tuple((int)type, name, emotion)).second) {
+        entries.push_back({ type, name, emotion });
+    }
+}
+
+void ChapterManifest::Clear() {
+    entries.clear();
+    seen.clear();
+}
+
+void ChapterManifest::CollectFrom(const ScriptChapter& chapter) {
+    ScriptInstruction inst;
+    size_t offset = 0;
+    while (offset < chapter.GetCodeSize()) {
+        offset = chapter.Decode(offset, inst);
+        switch (inst.op) {
+            case OpCode::BACKGROUND:
+                Add(ManifestAsset::BACKGROUND, chapter.GetSymbol(inst.arg1));
+                break;
+
+            case OpCode::MUSIC:
+                Add(ManifestAsset::MUSIC, chapter.GetSymbol(inst.arg1));
+                break;
+
+            case OpCode::SFX:
+                Add(ManifestAsset::SOUND, chapter.GetSymbol(inst.arg1));
+                break;
+
+            case OpCode::CHARACTER:
+                Add(ManifestAsset::SPRITE, chapter.GetSymbol(inst.arg1), chapter.GetSymbol(inst.arg2));
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+bool ChapterManifest::LoadFromText(const char* text, size_t size) {
+    Clear();
+
+    std::istringstream stream(std::string(text, size));
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream fields(line);
+        std::string type, name, emotion;
+        fields >> type >> name;
+        if (name.empty()) continue;
+
+        if (type == "bg") {
+            Add(ManifestAsset::BACKGROUND, Intern(name));
+        } else if (type == "music") {
+            Add(ManifestAsset::MUSIC, Intern(name));
+        } else if (type == "sfx") {
+            Add(ManifestAsset::SOUND, Intern(name));
+        } else if (type == "sprite" && (fields >> emotion)) {
+            Add(ManifestAsset::SPRITE, Intern(name), Intern(emotion));
+        } else {
+            std::cerr << "Warning: Invalid manifest line: " << line << std::endl;
+        }
+    }
+    return true;
+}
+
+bool ChapterManifest::LoadFromFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    std::string data = text.str();
+    return LoadFromText(data.data(), data.size());
+}
+
+bool ChapterManifest::SaveToFile(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Warning: Could not write manifest: " << path << std::endl;
+        return false;
+    }
+
+    static const char* typeNames[] = { "bg", "music", "sfx", "sprite" };
+    file << "# Recursos del capitulo en orden de primer uso (generado por nxbc)\n";
+    for (const ManifestEntry& entry : entries) {
+        file << typeNames[(int)entry.type] << " " << SymbolName(entry.name);
+        if (entry.type == ManifestAsset::SPRITE) {
+            file << " " << SymbolName(entry.emotion);
+        }
+        file << "\n";
+    }
+    return (bool)file;
+}
+
+std::string ChapterManifest::GetManifestPath(const std::string& scriptPath) {
+    size_t dot = scriptPath.find_last_of('.');
+    size_t slash = scriptPath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return scriptPath + ".manifest";
+    }
+    return scriptPath.substr(0, dot) + ".manifest";
+}
@@ -5,65 +5,143 @@
 #include "dialogue_parser.h"
 #include "resource_manager.h"
 
-Character::Character(const std::string& charName)
-    : name(charName), currentEmotion("neutral"), position(CharacterPosition::CENTER),
-      xPos(0), yPos(0), alpha(1.0f), isVisible(false) {
+Character::Character(Symbol charName)
+    : name(charName), currentEmotion(Intern("neutral")), position(CharacterPosition::CENTER),
+      xPos(0), yPos(0), alpha(1.0f), isVisible(false), pendingEmotion(NO_SYMBOL), spritesEpoch(0),
+      revision(1), cleanRevision(0) {
 }
 
 Character::~Character() {
     // Los sprites se liberan en ResourceManager
 }
 
-void Character::LoadSprite(const std::string& emotion) {
-    if (sprites.find(emotion) == sprites.end()) {
-        Texture2D tex = ResourceManager::GetInstance()->LoadCharacterSprite(name, emotion);
+void Character::LoadSprite(Symbol emotion) {
+    if (!sprites.Contains(emotion)) {
+        ResourceManager* resources = ResourceManager::GetInstance();
+        Texture2D tex = resources->LoadCharacterSprite(name, emotion);
         if (tex.id > 0) {
-            sprites[emotion] = tex;
+            sprites[emotion] = resources->GetCharacterFrame(name, emotion, tex);
         }
     }
 }
 
-void Character::SetEmotion(const std::string& emotion) {
-    LoadSprite(emotion);
-    if (sprites.find(emotion) != sprites.end()) {
-        currentEmotion = emotion;
+void Character::SetEmotion(Symbol emotion) {
+    // Si el ResourceManager expulsó texturas, descartar las copias que ya no son
+    // válidas: también las recargadas después, que tienen otro id de GPU
+    ResourceManager* resources = ResourceManager::GetInstance();
+    if (spritesEpoch != resources->GetEvictionEpoch()) {
+        std::vector<Symbol> evicted;
+        for (const auto& pair : sprites) {
+            Symbol key = resources->CharacterTextureKey(name, pair.first);
+            if (resources->GetTexture(key).id != pair.second.texture.id) {
+                evicted.push_back(pair.first);
+            }
+        }
+        for (Symbol stale : evicted) {
+            sprites.Erase(stale);
+        }
+        spritesEpoch = resources->GetEvictionEpoch();
+    }
+    
+    if (sprites.Contains(emotion)) {
+        if (currentEmotion != emotion) {
+            currentEmotion = emotion;
+            revision++;
+        }
+        if (pendingSprite) {
+            resources->CancelRequest(pendingSprite);
+            pendingSprite.reset();
+        }
+        return;
+    }
+    
+    // Cargar en segundo plano para no bloquear el frame (la petición
+    // anterior se retira después: si es la misma, su carga sigue)
+    AssetHandle previous = std::move(pendingSprite);
+    pendingEmotion = emotion;
+    pendingSprite = resources->RequestCharacterSprite(name, emotion);
+    if (previous) {
+        resources->CancelRequest(previous);
+    }
+    Update();
+}
+
+bool Character::Update() {
+    bool changed = false;
+    if (pendingSprite && pendingSprite->IsDone()) {
+        if (pendingSprite->IsReady()) {
+            sprites[pendingEmotion] = ResourceManager::GetInstance()->GetCharacterFrame(
+                name, pendingEmotion, pendingSprite->texture);
+            currentEmotion = pendingEmotion;
+            changed = true;
+            revision++;
+        }
+        pendingSprite.reset();
+    }
+    return changed;
+}
+
+void Character::CollectPinnedKeys(std::vector<Symbol>& keys) const {
+    // Con atlas se fija la página entera
+    ResourceManager* resources = ResourceManager::GetInstance();
+    if (isVisible) {
+        keys.push_back(resources->CharacterTextureKey(name, currentEmotion));
+    }
+    if (pendingSprite) {
+        keys.push_back(resources->CharacterTextureKey(name, pendingEmotion));
     }
 }
 
 void Character::SetPosition(CharacterPosition pos) {
-    position = pos;
+    if (position != pos) {
+        position = pos;
+        revision++;
+    }
 }
 
 void Character::SetPosition(float x, float y) {
     xPos = x;
     yPos = y;
     position = CharacterPosition::OFFSCREEN; // Custom position
+    revision++;
 }
 
 void Character::SetAlpha(float a) {
     alpha = a;
     if (alpha < 0.0f) alpha = 0.0f;
     if (alpha > 1.0f) alpha = 1.0f;
+    revision++;
 }
 
 void Character::Show() {
+    if (!isVisible) revision++;
     isVisible = true;
 }
 
 void Character::Hide() {
+    if (isVisible) revision++;
     isVisible = false;
 }
 
+unsigned int Character::GetTextureId() const {
+    if (!isVisible) return 0;
+    const SpriteFrame* sprite = sprites.Find(currentEmotion);
+    return (sprite != nullptr) ? sprite->texture.id : 0;
+}
+
 void Character::Render(int screenWidth, int screenHeight) {
-    if (!isVisible || sprites.find(currentEmotion) == sprites.end()) {
+    const SpriteFrame* frame = isVisible ? sprites.Find(currentEmotion) : nullptr;
+    if (frame == nullptr) {
         return;
     }
     
-    Texture2D sprite = sprites[currentEmotion];
-    if (sprite.id == 0) return;
+    const SpriteFrame& sprite = *frame;
+    if (sprite.texture.id == 0) return;
     
-    float spriteWidth = (float)sprite.width;
-    float spriteHeight = (float)sprite.height;
+    // El layout usa el tamaño original; en el atlas solo está la parte recortada
+    float spriteWidth = sprite.size.x;
+    float spriteHeight = sprite.size.y;
+    float scale = 1.0f;
     
     // Calcular posición según CharacterPosition
     float renderX = xPos;
@@ -71,7 +149,6 @@ void Character::Render(int screenWidth, int screenHeight) {
     
     if (position != CharacterPosition::OFFSCREEN) {
         // Ajustar escala si el sprite es muy grande
-        float scale = 1.0f;
         float maxHeight = screenHeight * 0.85f; // 85% de la pantalla
         if (spriteHeight > maxHeight) {
             scale = maxHeight / spriteHeight;
@@ -96,16 +173,12 @@ void Character::Render(int screenWidth, int screenHeight) {
             default:
                 break;
         }
-        
-        // Renderizar con escala y alpha
-        Rectangle source = { 0, 0, (float)sprite.width, (float)sprite.height };
-        Rectangle dest = { renderX, renderY, spriteWidth, spriteHeight };
-        Vector2 origin = { 0, 0 };
-        
-        DrawTexturePro(sprite, source, dest, origin, 0.0f, 
-                      Fade(WHITE, alpha));
-    } else {
-        // Posición custom
-        DrawTexture(sprite, (int)renderX, (int)renderY, Fade(WHITE, alpha));
     }
-}
\ No newline at end of file
+    
+    // Renderizar la región recortada con escala y alpha
+    Rectangle dest = { renderX + sprite.offset.x * scale, renderY + sprite.offset.y * scale,
+                       sprite.source.width * scale, sprite.source.height * scale };
+    Vector2 origin = { 0, 0 };
+    
+    DrawTexturePro(sprite.texture, sprite.source, dest, origin, 0.0f, Fade(WHITE, alpha));
+}
@@ -4,9 +4,8 @@
 #include "scene_manager.h"
 #include "dialogue_parser.h"
 #include "resource_manager.h"
-#include <fstream>
-#include <sstream>
-#include <algorithm>
+#include "profiler.h"
+#include "script_stream.h"
 #include <iostream>
 
 DialogueParser::DialogueParser(SceneManager* scene) 
@@ -16,42 +15,67 @@ DialogueParser::DialogueParser(SceneManager* scene)
 DialogueParser::~DialogueParser() {
 }
 
-std::string DialogueParser::Trim(const std::string& str) {
+std::string_view DialogueParser::Trim(std::string_view str) {
     size_t start = str.find_first_not_of(" \t\r\n");
-    if (start == std::string::npos) return "";
+    if (start == std::string_view::npos) return std::string_view();
     size_t end = str.find_last_not_of(" \t\r\n");
     return str.substr(start, end - start + 1);
 }
 
-std::vector<std::string> DialogueParser::Split(const std::string& str, char delimiter) {
-    std::vector<std::string> tokens;
-    std::string token;
-    std::istringstream tokenStream(str);
-    while (std::getline(tokenStream, token, delimiter)) {
-        tokens.push_back(Trim(token));
-    }
-    return tokens;
+bool DialogueParser::EqualsIgnoreCase(std::string_view str, const char* lower) {
+    size_t i = 0;
+    for (; i < str.size() && lower[i] != '\0'; i++) {
+        if (::tolower((unsigned char)str[i]) != lower[i]) return false;
+    }
+    return i == str.size() && lower[i] == '\0';
 }
 
-CharacterPosition DialogueParser::ParsePosition(const std::string& pos) {
-    std::string lower = pos;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-    
-    if (lower == "left" || lower == "izquierda") {
-        return CharacterPosition::LEFT;
-    } else if (lower == "center" || lower == "centro") {
-        return CharacterPosition::CENTER;
-    } else if (lower == "right" || lower == "derecha") {
-        return CharacterPosition::RIGHT;
-    }
-    return CharacterPosition::CENTER;
+bool DialogueParser::TryParsePosition(std::string_view pos, CharacterPosition& out) {
+    if (EqualsIgnoreCase(pos, "left") || EqualsIgnoreCase(pos, "izquierda")) {
+        out = CharacterPosition::LEFT;
+    } else if (EqualsIgnoreCase(pos, "center") || EqualsIgnoreCase(pos, "centro")) {
+        out = CharacterPosition::CENTER;
+    } else if (EqualsIgnoreCase(pos, "right") || EqualsIgnoreCase(pos, "derecha")) {
+        out = CharacterPosition::RIGHT;
+    } else {
+        out = CharacterPosition::CENTER;
+        return false;
+    }
+    return true;
 }
 
-ParsedCommand DialogueParser::ParseLine(const std::string& line) {
+bool DialogueParser::SplitBranchTarget(std::string_view target, std::string_view& chapter,
+                                       std::string_view& label) {
+    target = Trim(target);
+    chapter = std::string_view();
+    label = std::string_view();
+    if (target.empty()) {
+        return false;
+    }
+    
+    size_t colon = target.find(':');
+    if (colon != std::string_view::npos) {
+        chapter = Trim(target.substr(0, colon));
+        label = Trim(target.substr(colon + 1));
+    } else if (target.size() > 4 && EqualsIgnoreCase(target.substr(target.size() - 4), ".txt")) {
+        chapter = target;
+    } else {
+        label = target;
+    }
+    return !chapter.empty() || !label.empty();
+}
+
+CharacterPosition DialogueParser::ParsePosition(std::string_view pos) {
+    CharacterPosition position;
+    TryParsePosition(pos, position);
+    return position;
+}
+
+ParsedCommand DialogueParser::ParseLine(std::string_view line) {
     ParsedCommand cmd;
     cmd.type = CommandType::NONE;
     
-    std::string trimmed = Trim(line);
+    std::string_view trimmed = Trim(line);
     
     // Línea vacía
     if (trimmed.empty()) {
@@ -68,21 +92,36 @@ ParsedCommand DialogueParser::ParseLine(const std::string& line) {
     // Comando @ (background, music, sfx)
     if (trimmed[0] == '@') {
         size_t spacePos = trimmed.find(' ');
-        if (spacePos != std::string::npos) {
-            std::string command = trimmed.substr(1, spacePos - 1);
-            std::string value = Trim(trimmed.substr(spacePos + 1));
-            
-            std::transform(command.begin(), command.end(), command.begin(), ::tolower);
+        if (spacePos != std::string_view::npos) {
+            std::string_view command = trimmed.substr(1, spacePos - 1);
+            std::string_view value = Trim(trimmed.substr(spacePos + 1));
             
-            if (command == "bg" || command == "background") {
+            if (EqualsIgnoreCase(command, "bg") || EqualsIgnoreCase(command, "background")) {
                 cmd.type = CommandType::BACKGROUND;
                 cmd.value1 = value;
-            } else if (command == "music") {
+            } else if (EqualsIgnoreCase(command, "music")) {
                 cmd.type = CommandType::MUSIC;
                 cmd.value1 = value;
-            } else if (command == "sfx" || command == "sound") {
+            } else if (EqualsIgnoreCase(command, "sfx") || EqualsIgnoreCase(command, "sound")) {
                 cmd.type = CommandType::SFX;
                 cmd.value1 = value;
+            } else if (EqualsIgnoreCase(command, "label")) {
+                cmd.type = CommandType::LABEL;
+                cmd.value1 = value;
+            } else if (EqualsIgnoreCase(command, "jump")) {
+                if (SplitBranchTarget(value, cmd.value1, cmd.value2)) {
+                    cmd.type = CommandType::JUMP;
+                }
+            } else if (EqualsIgnoreCase(command, "choice")) {
+                // "texto" -> destino
+                size_t arrow = value.rfind("->");
+                std::string_view text = (arrow != std::string_view::npos) ? Trim(value.substr(0, arrow))
+                                                                          : std::string_view();
+                if (text.size() >= 2 && text.front() == '"' && text.back() == '"' &&
+                    SplitBranchTarget(value.substr(arrow + 2), cmd.value2, cmd.value3)) {
+                    cmd.type = CommandType::CHOICE;
+                    cmd.value1 = text.substr(1, text.size() - 2);
+                }
             }
         }
         return cmd;
@@ -101,9 +140,9 @@ ParsedCommand DialogueParser::ParseLine(const std::string& line) {
     
     // Diálogo con personaje: Nombre: "texto"
     size_t colonPos = trimmed.find(':');
-    if (colonPos != std::string::npos) {
-        std::string beforeColon = Trim(trimmed.substr(0, colonPos));
-        std::string afterColon = Trim(trimmed.substr(colonPos + 1));
+    if (colonPos != std::string_view::npos) {
+        std::string_view beforeColon = Trim(trimmed.substr(0, colonPos));
+        std::string_view afterColon = Trim(trimmed.substr(colonPos + 1));
         
         // Si después del : hay comillas, es diálogo
         if (!afterColon.empty() && afterColon[0] == '"') {
@@ -119,13 +158,21 @@ ParsedCommand DialogueParser::ParseLine(const std::string& line) {
         }
     }
     
-    // Comando de personaje: Nombre emocion posicion
-    std::vector<std::string> parts = Split(trimmed, ' ');
-    if (parts.size() >= 2) {
+    // Comando de personaje: Nombre emocion posicion (separados por espacios)
+    std::string_view parts[3];
+    size_t partCount = 0;
+    size_t tokenStart = 0;
+    while (partCount < 3 && tokenStart <= trimmed.size()) {
+        size_t space = trimmed.find(' ', tokenStart);
+        if (space == std::string_view::npos) space = trimmed.size();
+        parts[partCount++] = Trim(trimmed.substr(tokenStart, space - tokenStart));
+        tokenStart = space + 1;
+    }
+    if (partCount >= 2) {
         cmd.type = CommandType::CHARACTER;
         cmd.value1 = parts[0]; // Nombre
         cmd.value2 = parts[1]; // Emoción
-        if (parts.size() >= 3) {
+        if (partCount >= 3) {
             cmd.value3 = parts[2]; // Posición
         } else {
             cmd.value3 = "center"; // Posición por defecto
@@ -141,19 +188,19 @@ void DialogueParser::ExecuteCommand(const ParsedCommand& cmd) {
     
     switch (cmd.type) {
         case CommandType::BACKGROUND:
-            sceneManager->SetBackground(cmd.value1);
+            sceneManager->SetBackground(Intern(cmd.value1));
             break;
             
         case CommandType::MUSIC:
-            sceneManager->PlayMusic(cmd.value1);
+            sceneManager->PlayMusic(Intern(cmd.value1));
             break;
             
         case CommandType::SFX:
-            sceneManager->PlaySound(cmd.value1);
+            sceneManager->PlaySound(Intern(cmd.value1));
             break;
             
         case CommandType::CHARACTER:
-            sceneManager->ShowCharacter(cmd.value1, cmd.value2, 
+            sceneManager->ShowCharacter(Intern(cmd.value1), Intern(cmd.value2), 
                                       ParsePosition(cmd.value3));
             break;
             
@@ -162,56 +209,123 @@ void DialogueParser::ExecuteCommand(const ParsedCommand& cmd) {
     }
 }
 
-bool DialogueParser::LoadDialogueFile(const std::string& fileName, 
-                                      DialogueSystem& dialogue) {
-    std::string path = ResourceManager::GetInstance()->GetDialoguePath(fileName);
+void DialogueParser::CompileLine(std::string_view line, ScriptChapter& chapter) {
+    ParsedCommand cmd = ParseLine(line);
     
-    std::ifstream file(path);
-    if (!file.is_open()) {
+    switch (cmd.type) {
+        case CommandType::BACKGROUND:
+            chapter.EmitBackground(cmd.value1);
+            break;
+            
+        case CommandType::MUSIC:
+            chapter.EmitMusic(cmd.value1);
+            break;
+            
+        case CommandType::SFX:
+            chapter.EmitSound(cmd.value1);
+            break;
+            
+        case CommandType::CHARACTER:
+            chapter.EmitCharacter(cmd.value1, cmd.value2, ParsePosition(cmd.value3));
+            break;
+            
+        case CommandType::LABEL:
+            chapter.EmitLabel(cmd.value1);
+            break;
+            
+        case CommandType::JUMP:
+            chapter.EmitJump(cmd.value1, cmd.value2);
+            break;
+            
+        case CommandType::CHOICE:
+            chapter.EmitChoice(cmd.value1, cmd.value2, cmd.value3);
+            break;
+            
+        case CommandType::DIALOGUE:
+            // Línea de diálogo
+            chapter.EmitLine(cmd.value1, cmd.value2, "neutral", WHITE);
+            break;
+            
+        case CommandType::NARRATION:
+            // Narración (sin personaje)
+            chapter.EmitLine("", cmd.value1, "neutral", LIGHTGRAY);
+            break;
+            
+        case CommandType::COMMENT:
+            // Los comentarios se ignoran (pero podrían usarse para debug)
+            break;
+            
+        case CommandType::NONE:
+            // Línea vacía o no reconocida
+            break;
+    }
+}
+
+bool DialogueParser::CompileDialogueFile(const std::string& path, ScriptChapter& chapter) {
+    PROFILE_SCOPE("DialogueParser::CompileDialogueFile");
+    ScriptStream stream;
+    if (!stream.Open(path)) {
         std::cerr << "Error: Could not open dialogue file: " << path << std::endl;
         return false;
     }
     
-    dialogue.Clear();
-    std::string currentCharacter = "";
+    chapter.Clear();
+    chapter.SetSourceHash(stream.GetSourceHash());
+    stream.CompileUpTo(chapter, (size_t)-1);
+    return true;
+}
+
+bool DialogueParser::LoadCompiledChapter(const std::string& path, const PackEntry* packed,
+                                         ScriptChapter& chapter) {
+    // Capítulo precompilado dentro del pack: sin tocar el sistema de archivos
+    if (packed != nullptr && chapter.LoadFromMemory(packed->data, packed->size)) {
+        return true;
+    }
     
-    std::string line;
-    while (std::getline(file, line)) {
-        ParsedCommand cmd = ParseLine(line);
-        
-        switch (cmd.type) {
-            case CommandType::BACKGROUND:
-            case CommandType::MUSIC:
-            case CommandType::SFX:
-            case CommandType::CHARACTER:
-                // Ejecutar comandos inmediatamente
-                ExecuteCommand(cmd);
-                if (cmd.type == CommandType::CHARACTER) {
-                    currentCharacter = cmd.value1;
-                }
-                break;
-                
-            case CommandType::DIALOGUE:
-                // Agregar línea de diálogo
-                dialogue.AddLine(cmd.value1, cmd.value2);
-                currentCharacter = cmd.value1;
-                break;
-                
-            case CommandType::NARRATION:
-                // Agregar narración (sin personaje)
-                dialogue.AddLine("", cmd.value1, "neutral", LIGHTGRAY);
-                break;
-                
-            case CommandType::COMMENT:
-                // Los comentarios se ignoran (pero podrían usarse para debug)
-                break;
-                
-            case CommandType::NONE:
-                // Línea vacía o no reconocida
-                break;
+    // Preferir el capítulo precompilado salvo que el texto sea más nuevo
+    std::string compiledPath = ScriptChapter::GetCompiledPath(path);
+    if (FileExists(compiledPath.c_str()) &&
+        (!FileExists(path.c_str()) ||
+         GetFileModTime(compiledPath.c_str()) >= GetFileModTime(path.c_str()))) {
+        if (chapter.LoadFromFile(compiledPath)) {
+            return true;
         }
+        std::cerr << "Warning: Invalid compiled chapter, re-parsing: " << compiledPath << std::endl;
+    }
+    return false;
+}
+
+bool DialogueParser::ReadChapter(const std::string& path, const PackEntry* packed,
+                                 ScriptChapter& chapter) {
+    PROFILE_SCOPE("DialogueParser::ReadChapter");
+    return LoadCompiledChapter(path, packed, chapter) || CompileDialogueFile(path, chapter);
+}
+
+bool DialogueParser::LoadDialogueFile(const std::string& fileName, 
+                                      DialogueSystem& dialogue) {
+    PROFILE_SCOPE("DialogueParser::LoadDialogueFile");
+    ResourceManager* resources = ResourceManager::GetInstance();
+    std::string path = resources->GetDialoguePath(fileName);
+    
+    PackEntry entry;
+    bool packed = resources->FindPackedAsset(
+        resources->GetDialoguePackKey(ScriptChapter::GetCompiledPath(fileName)), entry);
+    
+    // Los comandos de escena no se ejecutan aquí: DialogueSystem los aplica
+    // al llegar a cada línea
+    ScriptChapter chapter;
+    if (LoadCompiledChapter(path, packed ? &entry : nullptr, chapter)) {
+        dialogue.LoadChapter(std::move(chapter), path);
+        return true;
     }
     
-    file.close();
+    // Sin bytecode: el texto se mapea y se compila por tramos por delante
+    // del lector, así que la carga no depende del tamaño del script
+    auto stream = std::make_unique<ScriptStream>();
+    if (!stream->Open(path)) {
+        std::cerr << "Error: Could not open dialogue file: " << path << std::endl;
+        return false;
+    }
+    dialogue.LoadChapter(std::move(stream), path);
     return true;
-}
\ No newline at end of file
+}
@@ -4,11 +4,23 @@
 #include "scene_manager.h"
 #include "dialogue_parser.h"
 #include "resource_manager.h"
+#include "profiler.h"
+#include "script_stream.h"
 #include <algorithm>
+#include <iostream>
+#include <cmath>
 
 DialogueSystem::DialogueSystem()
-    : currentLineIndex(0), isDisplaying(false), textRevealSpeed(50.0f), 
-      displayTimer(0.0f), customFontsLoaded(false) {
+    : currentLineIndex(0), sceneManager(nullptr), sceneLine(NO_LINE), readHistory(nullptr),
+      isDisplaying(false), textRevealSpeed(50.0f), lineLength(0), revealedCount(0),
+      displayTimer(0.0f), dirty(true), chapterGeneration(0), choosing(false), selectedChoice(0),
+      enteringBranch(false), hasChapterBranch(false), branchChapter(NO_SYMBOL), branchLabel(NO_SYMBOL),
+      fontCache(nullptr), fontGeneration(0), customFontsLoaded(false) {
+    chapter.Decode(chapter.GetCodeSize(), currentLine);
+    sceneBase.line = NO_LINE;
+    readLines = &sessionReadLines;
+    choiceIdleKey = Intern("choice_idle_background");
+    choiceHoverKey = Intern("choice_hover_background");
 }
 
 DialogueSystem::~DialogueSystem() {
@@ -16,56 +28,242 @@ DialogueSystem::~DialogueSystem() {
 }
 
 void DialogueSystem::LoadFonts(const std::string& fontName) {
-    dialogueFont = ResourceManager::GetInstance()->LoadFont(fontName);
-    nameFont = dialogueFont; // Usar la misma fuente, pero se puede cambiar
-    customFontsLoaded = true;
+    fontCache = ResourceManager::GetInstance()->LoadGlyphCache(fontName);
+    customFontsLoaded = fontCache->IsLoaded();
+    PrefillGlyphs();
+}
+
+void DialogueSystem::PrefillGlyphs(size_t fromOffset) {
+    if (!customFontsLoaded) return;
+    
+    // Rasterizar de una vez los codepoints de todo el capítulo (o del tramo
+    // recién compilado): nombres a 28px y textos a 24px
+    ScriptInstruction inst;
+    size_t offset = fromOffset;
+    while (offset < chapter.GetCodeSize()) {
+        offset = chapter.Decode(offset, inst);
+        if (inst.op == OpCode::SAY) {
+            fontCache->Request(chapter.GetString(inst.arg1), NAME_FONT_SIZE);
+            fontCache->Request(chapter.GetString(inst.arg2), TEXT_FONT_SIZE);
+        }
+    }
+    fontCache->Flush();
 }
 
 void DialogueSystem::AddLine(const std::string& character, const std::string& text,
                             const std::string& emotion, Color color) {
-    DialogueLine line;
-    line.character = character;
-    line.text = text;
-    line.emotion = emotion;
-    line.textColor = color;
-    dialogueLines.push_back(line);
+    chapter.EmitLine(character, text, emotion, color);
 }
 
 void DialogueSystem::AddLines(const std::vector<DialogueLine>& lines) {
     for (const auto& line : lines) {
-        dialogueLines.push_back(line);
+        chapter.EmitLine(line.character, line.text, line.emotion, line.textColor);
+    }
+}
+
+void DialogueSystem::LoadChapter(ScriptChapter&& compiled, const std::string& chapterName) {
+    Clear();
+    chapter = std::move(compiled);
+    timeline.Build(chapter);
+    if (readHistory && !chapterName.empty()) {
+        readLines = &readHistory->GetChapter(chapterName, chapter);
+    }
+    PrefillGlyphs();
+    if (sceneManager) {
+        sceneManager->PreloadSounds(chapter);
+    }
+}
+
+void DialogueSystem::LoadChapter(std::unique_ptr<ScriptStream> source, const std::string& chapterName) {
+    Clear();
+    stream = std::move(source);
+    chapter.SetSourceHash(stream->GetSourceHash());
+    EnsureLines(1);
+    if (readHistory && !chapterName.empty()) {
+        readLines = &readHistory->GetChapter(chapterName, chapter);
+    }
+}
+
+void DialogueSystem::EnsureLines(size_t count) {
+    if (!stream || chapter.GetLineCount() >= count) {
+        return;
+    }
+    
+    // Un tramo entero de una vez: el coste se reparte cada CHUNK_LINES líneas
+    size_t compiledCode = chapter.GetCodeSize();
+    stream->CompileUpTo(chapter, count + ScriptStream::CHUNK_LINES);
+    if (stream->IsFinished()) {
+        stream.reset();
+    }
+    
+    timeline.Build(chapter);
+    PrefillGlyphs(compiledCode);
+    if (sceneManager) {
+        sceneManager->PreloadSounds(chapter, compiledCode);
+    }
+}
+
+void DialogueSystem::BeginLine() {
+    // Al avanzar una línea se ejecutan sus comandos (deltas, con efectos de
+    // sonido); al rebobinar o saltar se reconstruye el estado desde el
+    // checkpoint más cercano
+    bool runCommands = enteringBranch ||
+                       ((sceneLine == NO_LINE) ? currentLineIndex == 0
+                                               : currentLineIndex == sceneLine + 1);
+    enteringBranch = false;
+    if (!runCommands && currentLineIndex != sceneLine) {
+        RestoreScene(currentLineIndex);
+    }
+    
+    // Ejecutar el bloque de la línea hasta su SAY
+    size_t offset = chapter.GetLineOffset(currentLineIndex);
+    do {
+        offset = chapter.Decode(offset, currentLine);
+        if (runCommands) {
+            ExecuteSceneCommand(currentLine);
+        }
+    } while (currentLine.op != OpCode::SAY && currentLine.op != OpCode::END);
+    
+    sceneLine = currentLineIndex;
+    if (runCommands && sceneManager) {
+        // Para volver a esta línea con otra pista sonando
+        if (!timeline.IsBuiltFor(chapter)) {
+            timeline.Build(chapter);
+        }
+        timeline.RecordMusicPosition(currentLineIndex, sceneManager->GetMusicPosition());
+    }
+    
+    // Líneas añadidas con AddLine no pasaron por el precargado del capítulo
+    if (customFontsLoaded && currentLine.op == OpCode::SAY) {
+        fontCache->Request(chapter.GetString(currentLine.arg1), NAME_FONT_SIZE);
+        fontCache->Request(chapter.GetString(currentLine.arg2), TEXT_FONT_SIZE);
+        fontCache->Flush();
+    }
+    
+    // Se cuenta en codepoints para no cortar secuencias UTF-8 (¡, ñ, é...)
+    lineLength = (currentLine.op == OpCode::SAY)
+        ? (size_t)GetCodepointCount(chapter.GetString(currentLine.arg2).data()) : 0;
+}
+
+void DialogueSystem::RunTail() {
+    // Los comandos detrás del último SAY (un @music o @bg de cierre) no son
+    // de ninguna línea: se ejecutan al pasar de ella
+    if (currentLineIndex >= chapter.GetLineCount()) return;
+    
+    ScriptInstruction inst;
+    size_t offset = chapter.GetLineOffset(currentLineIndex);
+    do {
+        offset = chapter.Decode(offset, inst);
+    } while (inst.op != OpCode::SAY && inst.op != OpCode::END);
+    while (offset < chapter.GetCodeSize()) {
+        offset = chapter.Decode(offset, inst);
+        ExecuteSceneCommand(inst);
+    }
+}
+
+void DialogueSystem::RestoreScene(size_t line) {
+    if (!sceneManager) return;
+    
+    SceneState state;
+    BuildScene(line, state);
+    sceneManager->RestoreState(state);
+}
+
+void DialogueSystem::BuildScene(size_t line, SceneState& out) {
+    // Líneas añadidas con AddLine después de cargar
+    if (!timeline.IsBuiltFor(chapter)) {
+        timeline.Build(chapter);
+    }
+    
+    // Después de un salto, desde la escena que había al saltar: lo que hay
+    // en el texto antes del destino no es lo que se leyó
+    const SceneEntry* entry = !branchTrail.empty() ? &branchTrail.back().target : &sceneBase;
+    if (entry->line != NO_LINE && line >= entry->line) {
+        out = entry->scene;
+        timeline.Replay(chapter, entry->applied ? entry->line + 1 : entry->line, line, out);
+        return;
+    }
+    
+    SceneSnapshot snapshot;
+    timeline.Reconstruct(chapter, line, snapshot);
+    timeline.ToSceneState(chapter, snapshot, line, out);
+}
+
+void DialogueSystem::ExecuteSceneCommand(const ScriptInstruction& inst) {
+    if (!sceneManager) return;
+    
+    switch (inst.op) {
+        case OpCode::BACKGROUND:
+            sceneManager->SetBackground(chapter.GetSymbol(inst.arg1));
+            break;
+            
+        case OpCode::MUSIC:
+            sceneManager->PlayMusic(chapter.GetSymbol(inst.arg1));
+            break;
+            
+        case OpCode::SFX:
+            sceneManager->PlaySound(chapter.GetSymbol(inst.arg1));
+            break;
+            
+        case OpCode::CHARACTER:
+            sceneManager->ShowCharacter(chapter.GetSymbol(inst.arg1), chapter.GetSymbol(inst.arg2),
+                                      inst.position);
+            break;
+            
+        default:
+            break;
     }
 }
 
 void DialogueSystem::Update(float deltaTime) {
-    if (currentLineIndex >= dialogueLines.size()) {
+    PROFILE_SCOPE("DialogueSystem::Update");
+    if (currentLineIndex >= chapter.GetLineCount()) {
         return;
     }
     
     if (!isDisplaying) {
+        // La ventana del prefetcher tiene que estar ya compilada
+        EnsureLines(currentLineIndex + 1 + prefetcher.GetLookahead());
+        BeginLine();
+        prefetcher.Update(chapter, currentLineIndex);
         isDisplaying = true;
         displayTimer = 0.0f;
-        displayedText = "";
+        revealedCount = 0;
+        dirty = true;
     }
     
-    // Revelar texto gradualmente
-    if (displayedText.length() < dialogueLines[currentLineIndex].text.length()) {
+    // Revelar texto gradualmente (sin copiar: Render dibuja el prefijo del layout)
+    if (revealedCount < lineLength) {
         displayTimer += deltaTime;
         
         size_t charsToReveal = (size_t)(displayTimer * textRevealSpeed);
-        displayedText = dialogueLines[currentLineIndex].text.substr(0, charsToReveal);
+        size_t revealed = std::min(charsToReveal, lineLength);
+        if (revealed != revealedCount) {
+            revealedCount = revealed;
+            dirty = true;
+        }
+    }
+    
+    // El menú sale con la pregunta ya entera en pantalla
+    if (!choosing && revealedCount >= lineLength) {
+        size_t exit = chapter.FindExit(currentLineIndex);
+        if (exit != ScriptChapter::NO_EXIT && chapter.GetExit(exit).choice) {
+            OpenChoice();
+        }
     }
 }
 
 void DialogueSystem::Render(int screenWidth, int screenHeight) {
-    if (currentLineIndex >= dialogueLines.size()) {
+    PROFILE_SCOPE("DialogueSystem::Render");
+    if (currentLineIndex >= chapter.GetLineCount() || currentLine.op != OpCode::SAY) {
         return;
     }
     
-    const DialogueLine& currentLine = dialogueLines[currentLineIndex];
+    // Los strings del capítulo terminan en '\0' y se pasan directo a raylib
+    const char* characterName = chapter.GetString(currentLine.arg1).data();
     
     // Fondo del diálogo
-    int dialogueHeight = 200;
+    int dialogueHeight = DIALOGUE_BOX_HEIGHT;
     int dialogueY = screenHeight - dialogueHeight;
 
     DrawRectangle(0, dialogueY, screenWidth, dialogueHeight, (Color){0, 0, 0, 220});
@@ -75,75 +273,71 @@ void DialogueSystem::Render(int screenWidth, int screenHeight) {
     int textX = 30;
     int textY = dialogueY + 15;
     
-    if (!currentLine.character.empty()) {
+    Font font = customFontsLoaded ? fontCache->GetFont(TEXT_FONT_SIZE) : GetFontDefault();
+    Font nameFont = customFontsLoaded ? fontCache->GetFont(NAME_FONT_SIZE) : GetFontDefault();
+    
+    // Glifos nuevos en el atlas: los layouts guardados ya no son válidos
+    if (customFontsLoaded && fontCache->GetGeneration() != fontGeneration) {
+        layoutCache.Clear();
+        fontGeneration = fontCache->GetGeneration();
+    }
+    
+    if (characterName[0] != '\0') {
         // Fondo del nombre
-        int nameWidth = MeasureText(currentLine.character.c_str(), 28) + 30;
+        int nameWidth = MeasureText(characterName, NAME_FONT_SIZE) + 30;
         DrawRectangle(textX - 10, textY - 5, nameWidth, 40, (Color){50, 50, 50, 255});
         DrawRectangleLines(textX - 10, textY - 5, nameWidth, 40, YELLOW);
         
         if (customFontsLoaded) {
-            DrawTextEx(nameFont, currentLine.character.c_str(), 
-                      (Vector2){(float)textX, (float)textY}, 28, 2, YELLOW);
+            DrawTextEx(nameFont, characterName, 
+                      (Vector2){(float)textX, (float)textY}, NAME_FONT_SIZE, 2, YELLOW);
         } else {
-            DrawText(currentLine.character.c_str(), textX, textY, 28, YELLOW);
+            DrawText(characterName, textX, textY, NAME_FONT_SIZE, YELLOW);
         }
     }
 
     // Texto del diálogo con word wrap
     int textStartY = textY + 55;
     int maxWidth = screenWidth - (textX + 50);
-    int fontSize = 24;
+    int fontSize = TEXT_FONT_SIZE;
     float spacing = 2.0f;
     
-    Font font = customFontsLoaded ? dialogueFont : GetFontDefault();
-    
-    // Word wrap mejorado
-    auto DrawTextWrapped = [&](const Font& f, const std::string& str, int x, int y, 
-                               int maxW, int fs, float sp, Color tint) {
-        std::string word;
-        std::string line;
-        float currentY = (float)y;
-        
-        for (size_t i = 0; i <= str.size(); ++i) {
-            char c = (i < str.size()) ? str[i] : ' ';
-            
-            if (c == ' ' || c == '\n' || i == str.size()) {
-                if (!word.empty()) {
-                    std::string testLine = line.empty() ? word : line + " " + word;
-                    Vector2 size = MeasureTextEx(f, testLine.c_str(), (float)fs, sp);
-                    
-                    if (size.x > maxW && !line.empty()) {
-                        // Dibujar línea actual y empezar nueva
-                        DrawTextEx(f, line.c_str(), (Vector2){(float)x, currentY}, 
-                                 (float)fs, sp, tint);
-                        currentY += fs + sp + 4;
-                        line = word;
-                    } else {
-                        line = testLine;
-                    }
-                    word.clear();
-                }
-                
-                if (c == '\n' && !line.empty()) {
-                    DrawTextEx(f, line.c_str(), (Vector2){(float)x, currentY}, 
-                             (float)fs, sp, tint);
-                    currentY += fs + sp + 4;
-                    line.clear();
-                }
+    // El layout se calcula una vez por línea; cada frame se dibuja solo el
+    // prefijo de glifos ya revelado
+    const TextLayout& layout = layoutCache.Get(currentLine.arg2, chapter.GetString(currentLine.arg2),
+                                               font, (float)fontSize, spacing, spacing + 4,
+                                               (float)maxWidth);
+    layout.Draw((Vector2){ (float)(textX + 5), (float)textStartY },
+                layout.CountGlyphsBefore(revealedCount), currentLine.color);
+
+    if (choosing) {
+        // Opciones sobre la escena, encima del cuadro de diálogo
+        ResourceManager* resources = ResourceManager::GetInstance();
+        Symbol idleKey = resources->GUIKey(choiceIdleKey);
+        Symbol hoverKey = resources->GUIKey(choiceHoverKey);
+        const ScriptExit& exit = chapter.GetExit(chapter.FindExit(currentLineIndex));
+        for (size_t i = 0; i < exit.branchCount; i++) {
+            Rectangle bounds = GetChoiceBounds(i, screenWidth, screenHeight);
+            bool selected = (int)i == selectedChoice;
+            Symbol key = selected ? hoverKey : idleKey;
+            if (resources->IsTextureLoaded(key)) {
+                Texture2D texture = resources->GetTexture(key);
+                DrawTexturePro(texture, (Rectangle){ 0, 0, (float)texture.width, (float)texture.height },
+                               bounds, (Vector2){ 0, 0 }, 0.0f, WHITE);
             } else {
-                word.push_back(c);
+                DrawRectangleRec(bounds, selected ? (Color){ 80, 80, 40, 230 } : (Color){ 0, 0, 0, 200 });
+                DrawRectangleLinesEx(bounds, 1.0f, selected ? YELLOW : (Color){ 100, 100, 100, 255 });
             }
+            
+            const char* text = chapter.GetString(chapter.GetBranch(exit.firstBranch + i).text).data();
+            Vector2 size = MeasureTextEx(font, text, (float)fontSize, spacing);
+            DrawTextEx(font, text, (Vector2){ bounds.x + (bounds.width - size.x) / 2.0f,
+                                              bounds.y + (bounds.height - size.y) / 2.0f },
+                       (float)fontSize, spacing, selected ? YELLOW : WHITE);
         }
-        
-        if (!line.empty()) {
-            DrawTextEx(font, line.c_str(), (Vector2){(float)x, currentY}, 
-                     (float)fs, sp, tint);
-        }
-    };
+        return;
+    }
     
-    DrawTextWrapped(font, displayedText, textX + 5, textStartY, 
-                   maxWidth, fontSize, spacing, currentLine.textColor);
-
     // Indicador de continuar
     if (IsLineFinished()) {
         int indicatorX = screenWidth - 40;
@@ -157,45 +351,336 @@ void DialogueSystem::Render(int screenWidth, int screenHeight) {
     }
 }
 
+void DialogueSystem::ResetLineState() {
+    isDisplaying = false;
+    revealedCount = 0;
+    displayTimer = 0.0f;
+    choosing = false;
+}
+
 void DialogueSystem::NextLine() {
-    if (currentLineIndex < dialogueLines.size() - 1) {
+    if (choosing) {
+        return;   // Hay que elegir una opción
+    }
+    
+    // Las salidas de una línea se compilan detrás de su SAY
+    EnsureLines(currentLineIndex + 2);
+    size_t exit = chapter.FindExit(currentLineIndex);
+    if (exit != ScriptChapter::NO_EXIT && isDisplaying) {
+        if (chapter.GetExit(exit).choice) {
+            OpenChoice();
+        } else {
+            MarkCurrentRead();
+            FollowBranch(chapter.GetBranch(chapter.GetExit(exit).firstBranch));
+        }
+        return;
+    }
+    
+    if (currentLineIndex + 1 < chapter.GetLineCount()) {
+        MarkCurrentRead();
         currentLineIndex++;
-        isDisplaying = false;
-        displayedText = "";
-        displayTimer = 0.0f;
+        ResetLineState();
+    } else if (isDisplaying) {
+        // Fin del capítulo (EnsureLines ya lo compiló entero): lo que venga
+        // detrás de la última línea y después IsFinished
+        MarkCurrentRead();
+        RunTail();
+        currentLineIndex = chapter.GetLineCount();
+        sceneLine = currentLineIndex;   // Al volver atrás se reconstruye la última línea
+        ResetLineState();
     }
 }
 
 void DialogueSystem::PreviousLine() {
+    // Por donde se llegó: el origen del último salto, no la línea anterior del texto
+    if (!branchTrail.empty() && branchTrail.back().target.line == currentLineIndex) {
+        MarkCurrentRead();
+        currentLineIndex = branchTrail.back().origin;
+        branchTrail.pop_back();
+        ResetLineState();
+        return;
+    }
+    
     if (currentLineIndex > 0) {
+        MarkCurrentRead();
         currentLineIndex--;
-        isDisplaying = false;
-        displayedText = "";
-        displayTimer = 0.0f;
+        ResetLineState();
+    }
+}
+
+void DialogueSystem::JumpToLine(size_t line) {
+    EnsureLines(line + 1);
+    if (line < chapter.GetLineCount() && line != currentLineIndex) {
+        MarkCurrentRead();
+        currentLineIndex = line;
+        ResetLineState();
+    }
+}
+
+void DialogueSystem::ResumeAt(size_t line, const SceneState& scene) {
+    EnsureLines(line + 1);
+    if (line >= chapter.GetLineCount()) {
+        return;
+    }
+    MarkCurrentRead();
+    currentLineIndex = line;
+    ResetLineState();
+    enteringBranch = false;
+    sceneLine = line;
+    
+    // El camino hasta la partida no se conoce: retroceder parte de su escena
+    branchTrail.clear();
+    sceneBase.line = line;
+    sceneBase.scene = scene;
+    sceneBase.applied = true;
+}
+
+uint32_t DialogueSystem::ResolveLocalBranch(const ScriptBranch& branch) {
+    if (branch.line != ScriptChapter::UNRESOLVED_LINE) {
+        return branch.line;
+    }
+    
+    // Salto hacia delante a una etiqueta que el stream aún no ha compilado
+    Symbol label = chapter.GetSymbol(branch.label);
+    uint32_t line = chapter.GetLabelLine(label);
+    while (line == ScriptChapter::UNRESOLVED_LINE && stream) {
+        EnsureLines(chapter.GetLineCount() + 1);
+        line = chapter.GetLabelLine(label);
+    }
+    return line;
+}
+
+void DialogueSystem::CaptureEntry(size_t line, SceneEntry& entry) {
+    entry.line = line;
+    entry.applied = false;
+    if (!sceneManager) return;
+    
+    // La escena real si ya muestra la línea actual o viene de otro capítulo;
+    // tras un avance rápido sin Update en medio aún no se ha puesto al día
+    if (sceneLine == currentLineIndex || sceneLine == NO_LINE) {
+        sceneManager->CaptureState(entry.scene);
+    } else {
+        BuildScene(currentLineIndex, entry.scene);
+    }
+}
+
+void DialogueSystem::EnterLine(size_t line) {
+    EnsureLines(line + 1);
+    currentLineIndex = line;
+    enteringBranch = true;
+    ResetLineState();
+    dirty = true;
+}
+
+void DialogueSystem::FollowBranch(ScriptBranch branch) {
+    // Copia: compilar más del stream puede mover la tabla de saltos
+    choosing = false;
+    if (branch.chapter != 0) {
+        hasChapterBranch = true;
+        branchChapter = chapter.GetSymbol(branch.chapter);
+        branchLabel = chapter.GetSymbol(branch.label);
+        return;
+    }
+    
+    uint32_t line = ResolveLocalBranch(branch);
+    if (line == ScriptChapter::UNRESOLVED_LINE) {
+        std::cerr << "Warning: Undefined label: " << chapter.GetString(branch.label) << std::endl;
+        if (currentLineIndex + 1 < chapter.GetLineCount()) {
+            currentLineIndex++;
+            ResetLineState();
+        }
+        return;
+    }
+    
+    BranchStep step;
+    step.origin = currentLineIndex;
+    CaptureEntry(line, step.target);
+    branchTrail.push_back(step);
+    EnterLine(line);
+}
+
+bool DialogueSystem::JumpToLabel(Symbol label) {
+    uint32_t line = chapter.GetLabelLine(label);
+    while (line == ScriptChapter::UNRESOLVED_LINE && stream) {
+        EnsureLines(chapter.GetLineCount() + 1);
+        line = chapter.GetLabelLine(label);
+    }
+    if (line == ScriptChapter::UNRESOLVED_LINE) {
+        return false;
+    }
+    MarkCurrentRead();
+    // Punto de entrada nuevo: no hay camino detrás por el que volver
+    CaptureEntry(line, sceneBase);
+    branchTrail.clear();
+    EnterLine(line);
+    return true;
+}
+
+void DialogueSystem::OpenChoice() {
+    size_t exit = chapter.FindExit(currentLineIndex);
+    if (exit == ScriptChapter::NO_EXIT) {
+        return;
+    }
+    choosing = true;
+    selectedChoice = 0;
+    dirty = true;
+    
+    ResourceManager* resources = ResourceManager::GetInstance();
+    resources->LoadGUI(choiceIdleKey);
+    resources->LoadGUI(choiceHoverKey);
+    
+    // Los textos de las opciones no pasan por el precargado de glifos
+    if (customFontsLoaded) {
+        const ScriptExit& choices = chapter.GetExit(exit);
+        for (uint32_t i = 0; i < choices.branchCount; i++) {
+            fontCache->Request(chapter.GetString(chapter.GetBranch(choices.firstBranch + i).text),
+                               TEXT_FONT_SIZE);
+        }
+        fontCache->Flush();
+    }
+}
+
+size_t DialogueSystem::GetChoiceCount() const {
+    if (!choosing) {
+        return 0;
+    }
+    return chapter.GetExit(chapter.FindExit(currentLineIndex)).branchCount;
+}
+
+void DialogueSystem::SetSelectedChoice(int index) {
+    int count = (int)GetChoiceCount();
+    if (count == 0) {
+        return;
+    }
+    index = std::max(0, std::min(index, count - 1));
+    if (index != selectedChoice) {
+        selectedChoice = index;
+        dirty = true;
+    }
+}
+
+Rectangle DialogueSystem::GetChoiceBounds(size_t index, int screenWidth, int screenHeight) const {
+    // Centradas en el espacio que deja libre el cuadro de diálogo
+    size_t count = GetChoiceCount();
+    float width = std::min((float)CHOICE_MAX_WIDTH, (float)(screenWidth - 160));
+    float total = count * CHOICE_HEIGHT + (count > 0 ? count - 1 : 0) * CHOICE_SPACING;
+    float top = ((screenHeight - DIALOGUE_BOX_HEIGHT) - total) / 2.0f;
+    return (Rectangle){ (screenWidth - width) / 2.0f, top + index * (CHOICE_HEIGHT + CHOICE_SPACING),
+                        width, (float)CHOICE_HEIGHT };
+}
+
+int DialogueSystem::GetChoiceAt(Vector2 point, int screenWidth, int screenHeight) const {
+    size_t count = GetChoiceCount();
+    for (size_t i = 0; i < count; i++) {
+        if (CheckCollisionPointRec(point, GetChoiceBounds(i, screenWidth, screenHeight))) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void DialogueSystem::Choose(size_t index) {
+    size_t exit = chapter.FindExit(currentLineIndex);
+    if (!choosing || exit == ScriptChapter::NO_EXIT || index >= chapter.GetExit(exit).branchCount) {
+        return;
+    }
+    MarkCurrentRead();
+    FollowBranch(chapter.GetBranch(chapter.GetExit(exit).firstBranch + index));
+}
+
+bool DialogueSystem::TakeChapterBranch(std::string& chapterName, Symbol& label) {
+    if (!hasChapterBranch) {
+        return false;
+    }
+    chapterName = SymbolName(branchChapter);
+    label = branchLabel;
+    hasChapterBranch = false;
+    return true;
+}
+
+void DialogueSystem::MarkCurrentRead() {
+    // Una línea cuenta como leída al dejarla (como en el modo skip de otros motores)
+    if (isDisplaying && currentLineIndex < chapter.GetLineCount()) {
+        readLines->Set(currentLineIndex);
+    }
+}
+
+bool DialogueSystem::SkipReadLines() {
+    PROFILE_SCOPE("DialogueSystem::SkipReadLines");
+    EnsureLines(currentLineIndex + 2);
+    if (choosing || hasChapterBranch || !readLines->Test(currentLineIndex)) {
+        return false;
+    }
+    
+    // En un salto se sigue (y se continúa desde el destino en el siguiente
+    // frame); los menús los decide el jugador
+    size_t exit = chapter.FindExit(currentLineIndex);
+    if (exit != ScriptChapter::NO_EXIT) {
+        if (chapter.GetExit(exit).choice) {
+            return false;
+        }
+        MarkCurrentRead();
+        FollowBranch(chapter.GetBranch(chapter.GetExit(exit).firstBranch));
+        return true;
+    }
+    if (currentLineIndex + 1 >= chapter.GetLineCount()) {
+        return false;
+    }
+    
+    // Búsqueda por palabras en el bitset; BeginLine reconstruye desde el
+    // checkpoint solo la escena de destino y carga únicamente sus recursos.
+    // Con stream se compila hasta el destino (no hay otra forma de saber dónde cae)
+    size_t target = readLines->FindNextUnset(currentLineIndex + 1);
+    EnsureLines(target + 1);
+    
+    // Sin pasar de largo la siguiente salida: el texto de detrás no es lo que viene
+    size_t nextExit = chapter.FindNextExit(currentLineIndex + 1);
+    if (nextExit != ScriptChapter::NO_EXIT) {
+        target = std::min(target, (size_t)chapter.GetExit(nextExit).line);
     }
+    JumpToLine(std::min(target, chapter.GetLineCount() - 1));
+    return true;
 }
 
 void DialogueSystem::SkipToEnd() {
-    if (currentLineIndex < dialogueLines.size()) {
-        displayedText = dialogueLines[currentLineIndex].text;
+    if (currentLineIndex < chapter.GetLineCount() && revealedCount != lineLength) {
+        revealedCount = lineLength;
+        dirty = true;
     }
 }
 
 bool DialogueSystem::IsFinished() const {
-    return currentLineIndex >= dialogueLines.size();
+    return currentLineIndex >= chapter.GetLineCount();
 }
 
 bool DialogueSystem::IsLineFinished() const {
-    if (currentLineIndex >= dialogueLines.size()) {
+    if (currentLineIndex >= chapter.GetLineCount()) {
         return false;
     }
-    return displayedText.length() >= dialogueLines[currentLineIndex].text.length();
+    return isDisplaying && revealedCount >= lineLength;
 }
 
 void DialogueSystem::Clear() {
-    dialogueLines.clear();
+    prefetcher.Reset();
+    layoutCache.Clear();
+    stream.reset();
+    chapter.Clear();
+    chapter.Decode(chapter.GetCodeSize(), currentLine);
     currentLineIndex = 0;
+    timeline.Clear();
+    sceneLine = NO_LINE;
+    sessionReadLines.Clear();
+    readLines = &sessionReadLines;
+    chapterGeneration++;
+    choosing = false;
+    selectedChoice = 0;
+    enteringBranch = false;
+    branchTrail.clear();
+    sceneBase.line = NO_LINE;
+    hasChapterBranch = false;
     isDisplaying = false;
-    displayedText = "";
+    lineLength = 0;
+    revealedCount = 0;
     displayTimer = 0.0f;
+    dirty = true;
 }
\ No newline at end of file
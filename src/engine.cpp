@@ -6,7 +6,8 @@
 #include "resource_manager.h"
 
 Engine::Engine(int width, int height, const std::string& title, bool fullscreen)
-    : screenWidth(width), screenHeight(height), gameTitle(title), isRunning(true), isFullscreen(fullscreen) {
+    : screenWidth(width), screenHeight(height), gameTitle(title), isRunning(true), isFullscreen(fullscreen),
+      targetFPS(60), idleFPS(20), idleDelay(0.5f), quietTime(0.0f), isIdle(false) {
 }
 
 Engine::~Engine() {
@@ -22,7 +23,7 @@ bool Engine::Initialize() {
     
     SetConfigFlags(flags);
     InitWindow(screenWidth, screenHeight, gameTitle.c_str());
-    SetTargetFPS(60);
+    SetTargetFPS(targetFPS);
     
     // Si está en fullscreen, obtener las dimensiones reales
     if (isFullscreen) {
@@ -67,3 +68,30 @@ void Engine::SetFullscreen(bool fullscreen) {
         ToggleBorderlessWindowed();
     }
 }
+
+void Engine::UpdateIdleState(bool changed, float deltaTime) {
+    if (changed) {
+        quietTime = 0.0f;
+        if (isIdle) {
+            // El frame actual ya vuelve a esperar solo 1/targetFPS
+            isIdle = false;
+            SetTargetFPS(targetFPS);
+        }
+        return;
+    }
+    
+    quietTime += deltaTime;
+    if (!isIdle && idleFPS > 0 && quietTime >= idleDelay) {
+        isIdle = true;
+        SetTargetFPS(idleFPS);
+    }
+}
+
+void Engine::SetIdleFPS(int fps) {
+    // La música se rellena en su propio hilo: cualquier ritmo de reposo vale
+    idleFPS = fps;
+    if (isIdle) {
+        isIdle = false;
+        SetTargetFPS(targetFPS);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,247 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "profiler.h"
+#include "glyph_cache.h"
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+
+GlyphCache::GlyphCache()
+    : fontData(nullptr), fontDataSize(0), ownedData(nullptr), generation(0) {
+}
+
+GlyphCache::~GlyphCache() {
+    Unload();
+}
+
+bool GlyphCache::LoadFromMemory(const unsigned char* data, int dataSize) {
+    Unload();
+    if (data == nullptr || dataSize <= 0) {
+        return false;
+    }
+    fontData = data;
+    fontDataSize = dataSize;
+    return true;
+}
+
+bool GlyphCache::LoadFromFile(const std::string& path) {
+    Unload();
+
+    int dataSize = 0;
+    ownedData = LoadFileData(path.c_str(), &dataSize);
+    if (ownedData == nullptr) {
+        return false;
+    }
+    fontData = ownedData;
+    fontDataSize = dataSize;
+    return true;
+}
+
+void GlyphCache::Unload() {
+    for (auto& face : faces) {
+        UnloadImage(face->atlas);
+        if (face->texture.id > 0) {
+            UnloadTexture(face->texture);
+        }
+    }
+    faces.clear();
+
+    if (ownedData != nullptr) {
+        UnloadFileData(ownedData);
+        ownedData = nullptr;
+    }
+    fontData = nullptr;
+    fontDataSize = 0;
+    generation++;
+}
+
+GlyphCache::Face& GlyphCache::GetFace(int fontSize) {
+    for (auto& face : faces) {
+        if (face->fontSize == fontSize) {
+            return *face;
+        }
+    }
+
+    auto face = std::make_unique<Face>();
+    face->fontSize = fontSize;
+    face->texture = (Texture2D){ 0 };
+    face->shelfX = face->shelfY = face->shelfHeight = 0;
+
+    // El atlas empieza pequeño y se duplica en altura al llenarse
+    face->atlas = (Image){ 0 };
+    face->atlas.width = ATLAS_WIDTH;
+    face->atlas.height = 256;
+    face->atlas.mipmaps = 1;
+    face->atlas.format = PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA;
+    face->atlas.data = MemAlloc(ATLAS_WIDTH * face->atlas.height * 2);
+
+    // ASCII imprimible siempre presente (incluye '?' para codepoints que falten)
+    for (int codepoint = 32; codepoint < 127; codepoint++) {
+        RequestCodepoint(*face, codepoint);
+    }
+
+    faces.push_back(std::move(face));
+    return *faces.back();
+}
+
+void GlyphCache::RequestCodepoint(Face& face, int codepoint) {
+    if (face.glyphIndex.find(codepoint) != face.glyphIndex.end()) {
+        return;
+    }
+    // -1: pendiente (o no rasterizable); no se vuelve a pedir
+    face.glyphIndex[codepoint] = -1;
+    face.pending.push_back(codepoint);
+}
+
+void GlyphCache::Request(std::string_view text, int fontSize) {
+    if (!IsLoaded()) return;
+
+    Face& face = GetFace(fontSize);
+    size_t i = 0;
+    while (i < text.size()) {
+        int size = 0;
+        int codepoint = GetCodepointNext(text.data() + i, &size);
+        if (size <= 0) size = 1;
+        if (codepoint >= 32) {
+            RequestCodepoint(face, codepoint);
+        }
+        i += size;
+    }
+}
+
+void GlyphCache::Flush() {
+    for (auto& face : faces) {
+        Rasterize(*face);
+    }
+}
+
+void GlyphCache::Prefill(std::string_view text, int fontSize) {
+    Request(text, fontSize);
+    Flush();
+}
+
+bool GlyphCache::PlaceGlyph(Face& face, const Image& glyph, Rectangle& rec) {
+    int cellWidth = glyph.width + 2 * GLYPH_PADDING;
+    int cellHeight = glyph.height + 2 * GLYPH_PADDING;
+    if (cellWidth > ATLAS_WIDTH) return false;
+
+    // Empaquetado por estantes
+    if (face.shelfX + cellWidth > ATLAS_WIDTH) {
+        face.shelfY += face.shelfHeight;
+        face.shelfX = 0;
+        face.shelfHeight = 0;
+    }
+
+    if (face.shelfY + cellHeight > face.atlas.height) {
+        int newHeight = face.atlas.height;
+        while (face.shelfY + cellHeight > newHeight) newHeight *= 2;
+        if (newHeight > MAX_ATLAS_HEIGHT) return false;
+
+        // Crecer hacia abajo: los rectángulos ya asignados no cambian
+        size_t oldBytes = (size_t)ATLAS_WIDTH * face.atlas.height * 2;
+        unsigned char* grown = (unsigned char*)MemAlloc(ATLAS_WIDTH * newHeight * 2);
+        memcpy(grown, face.atlas.data, oldBytes);
+        MemFree(face.atlas.data);
+        face.atlas.data = grown;
+        face.atlas.height = newHeight;
+    }
+
+    int x = face.shelfX + GLYPH_PADDING;
+    int y = face.shelfY + GLYPH_PADDING;
+    const unsigned char* src = (const unsigned char*)glyph.data;
+    unsigned char* dst = (unsigned char*)face.atlas.data;
+    if (src != nullptr) {
+        for (int row = 0; row < glyph.height; row++) {
+            for (int col = 0; col < glyph.width; col++) {
+                size_t index = ((size_t)(y + row) * ATLAS_WIDTH + (x + col)) * 2;
+                dst[index] = 255;
+                dst[index + 1] = src[row * glyph.width + col];
+            }
+        }
+    }
+
+    rec = (Rectangle){ (float)x, (float)y, (float)glyph.width, (float)glyph.height };
+    face.shelfX += cellWidth;
+    face.shelfHeight = std::max(face.shelfHeight, cellHeight);
+    return true;
+}
+
+void GlyphCache::Rasterize(Face& face) {
+    if (face.pending.empty() || !IsLoaded()) return;
+    PROFILE_SCOPE("GlyphCache::Rasterize");
+
+    int count = (int)face.pending.size();
+    GlyphInfo* rasterized = LoadFontData(fontData, fontDataSize, face.fontSize,
+                                         face.pending.data(), count, FONT_DEFAULT);
+    face.pending.clear();
+    if (rasterized == nullptr) {
+        std::cerr << "Warning: Could not rasterize " << count << " glyphs" << std::endl;
+        return;
+    }
+
+    int oldHeight = face.atlas.height;
+    bool atlasFull = false;
+
+    for (int i = 0; i < count; i++) {
+        Image glyph = rasterized[i].image;
+        if (glyph.data != nullptr && glyph.format != PIXELFORMAT_UNCOMPRESSED_GRAYSCALE) {
+            ImageFormat(&rasterized[i].image, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE);
+            glyph = rasterized[i].image;
+        }
+
+        Rectangle rec;
+        if (!PlaceGlyph(face, glyph, rec)) {
+            atlasFull = true;
+            continue;
+        }
+
+        GlyphInfo info = rasterized[i];
+        info.image = (Image){ 0 };
+        face.glyphIndex[info.value] = (int)face.glyphs.size();
+        face.glyphs.push_back(info);
+        face.recs.push_back(rec);
+    }
+    UnloadFontData(rasterized, count);
+
+    if (atlasFull) {
+        std::cerr << "Warning: Glyph atlas full (" << face.fontSize << "px)" << std::endl;
+    }
+
+    // Subir el atlas: si cambió de tamaño se recrea la textura
+    if (face.texture.id == 0 || face.atlas.height != oldHeight) {
+        if (face.texture.id > 0) {
+            UnloadTexture(face.texture);
+        }
+        face.texture = LoadTextureFromImage(face.atlas);
+    } else {
+        UpdateTexture(face.texture, face.atlas.data);
+    }
+    generation++;
+}
+
+Font GlyphCache::GetFont(int fontSize) {
+    if (!IsLoaded()) {
+        return GetFontDefault();
+    }
+
+    Face& face = GetFace(fontSize);
+    Rasterize(face);
+
+    Font font = { 0 };
+    font.baseSize = fontSize;
+    font.glyphCount = (int)face.glyphs.size();
+    font.glyphPadding = GLYPH_PADDING;
+    font.texture = face.texture;
+    font.recs = face.recs.data();
+    font.glyphs = face.glyphs.data();
+    return font;
+}
+
+size_t GlyphCache::GetGlyphCount(int fontSize) {
+    if (!IsLoaded()) return 0;
+    return GetFace(fontSize).glyphs.size();
+}
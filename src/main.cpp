@@ -4,6 +4,12 @@
 #include "scene_manager.h"
 #include "dialogue_parser.h"
 #include "resource_manager.h"
+#include "profiler.h"
+#include "chapter_loader.h"
+#include "save_system.h"
+#include "branch_prefetcher.h"
+#include "voice_player.h"
+#include <ctime>
 
 enum GameState {
     STATE_SPLASH,
@@ -18,6 +24,7 @@ int main() {
     if (!engine.Initialize()) {
         return -1;
     }
+    Profiler::GetInstance()->SetThreadName("Principal");
     
     // Inicializar el ResourceManager
     ResourceManager::GetInstance()->Initialize("resources/");
@@ -25,46 +32,100 @@ int main() {
     
     // Inicializar sistemas
     SplashScreen splash("resources/backgrounds/splash-screen.png");
-    splash.SetLoadingTime(3.0f);
     splash.SetShowLoadingBar(true);
     
+    // Líneas leídas de partidas anteriores (avance rápido con CTRL)
+    ReadHistory readHistory;
+    readHistory.LoadFromFile("saves/read_lines.dat");
+    
+    // Partidas guardadas: se escriben en un hilo aparte
+    SaveSystem saves("saves/");
+    SaveData resumeData;
+    bool resumePending = false;
+    uint32_t noticedSaves = 0;
+    float saveNoticeTimer = 0.0f;
+    
     SceneManager sceneManager;
     DialogueSystem dialogue;
+    dialogue.SetSceneManager(&sceneManager);
+    dialogue.SetReadHistory(&readHistory);
     DialogueParser parser(&sceneManager);
     
     // Cargar fuente personalizada
     dialogue.LoadFonts("GenJyuuGothicX-Bold.ttf");
     dialogue.SetTextSpeed(40.0f); // Velocidad de texto (caracteres por segundo)
+    dialogue.SetPrefetchDistance(8); // Líneas de script que se cargan por adelantado
+    
+    // Carga real detrás del splash: el capítulo 0 y los recursos de su manifiesto
+    ChapterLoader chapterLoader;
+    std::string currentChapter = "ch0.txt";
+    if (!chapterLoader.Begin(currentChapter, parser, dialogue)) {
+        // Si no se puede cargar, usar diálogos de ejemplo
+        dialogue.AddLine("Sistema", "No se pudo cargar ch0.txt");
+        dialogue.AddLine("Sistema", "Verifica que el archivo esté en resources/dialogues/spa-spa/");
+    }
+    
+    // Capítulos de destino de saltos y opciones, compilados antes de elegir
+    BranchPrefetcher branches(8);
+    
+    // Voz de cada línea: solo se tienen abiertos los clips de las próximas 3
+    VoicePlayer voices(3);
     
     GameState currentState = STATE_SPLASH;
     float deltaTime = 0.0f;
+    bool showProfiler = false;
     
     // Main loop
     while (!engine.ShouldClose()) {
+        Profiler::GetInstance()->BeginFrame();
         deltaTime = GetFrameTime();
         
         // Update
         switch (currentState) {
             case STATE_SPLASH:
+                // La barra refleja los recursos ya subidos; termina al acabar la carga
+                chapterLoader.Update();
+                splash.SetProgress(chapterLoader.GetProgress());
                 splash.Update(deltaTime);
                 if (splash.IsFinished()) {
                     currentState = STATE_DIALOGUE;
-                    
-                    // Cargar el capítulo 0 desde archivo
-                    if (!parser.LoadDialogueFile("ch0.txt", dialogue)) {
-                        // Si no se puede cargar, usar diálogos de ejemplo
-                        dialogue.AddLine("Sistema", "No se pudo cargar ch0.txt");
-                        dialogue.AddLine("Sistema", "Verifica que el archivo esté en resources/dialogues/spa-spa/");
+                    if (resumePending) {
+                        SaveSystem::Resume(resumeData, dialogue, sceneManager);
+                        resumePending = false;
                     }
                 }
                 break;
                 
             case STATE_DIALOGUE:
+                // Subir a GPU lo que los workers ya decodificaron (con presupuesto por frame)
+                ResourceManager::GetInstance()->ProcessUploads();
                 sceneManager.Update(deltaTime);
                 dialogue.Update(deltaTime);
+                branches.Update(dialogue);
                 
                 // Controles
-                if (IsKeyPressed(KEY_SPACE) || IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+                if (dialogue.IsChoosing()) {
+                    // Menú de opciones: ratón, o flechas y ENTER/ESPACIO
+                    int pointed = dialogue.GetChoiceAt(GetMousePosition(), engine.GetScreenWidth(),
+                                                       engine.GetScreenHeight());
+                    Vector2 pointerDelta = GetMouseDelta();
+                    if (pointed >= 0 && (pointerDelta.x != 0.0f || pointerDelta.y != 0.0f)) {
+                        dialogue.SetSelectedChoice(pointed);
+                    }
+                    if (IsKeyPressed(KEY_DOWN)) {
+                        dialogue.SetSelectedChoice(dialogue.GetSelectedChoice() + 1);
+                    }
+                    if (IsKeyPressed(KEY_UP)) {
+                        dialogue.SetSelectedChoice(dialogue.GetSelectedChoice() - 1);
+                    }
+                    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+                        if (pointed >= 0) {
+                            dialogue.Choose(pointed);
+                        }
+                    } else if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_SPACE)) {
+                        dialogue.Choose(dialogue.GetSelectedChoice());
+                    }
+                } else if (IsKeyPressed(KEY_SPACE) || IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
                     if (dialogue.IsLineFinished()) {
                         dialogue.NextLine();
                     } else {
@@ -77,15 +138,55 @@ int main() {
                     dialogue.PreviousLine();
                 }
                 
-                // Avance automático rápido (mantener CTRL)
+                // Avance rápido (mantener CTRL): salta de golpe hasta la primera línea no leída
                 if (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) {
-                    if (dialogue.IsLineFinished()) {
-                        dialogue.NextLine();
+                    dialogue.SkipReadLines();
+                }
+                
+                // Salto a otro capítulo: ya compilado mientras se leía, sin pantalla de carga
+                {
+                    std::string branchChapter;
+                    Symbol branchLabel;
+                    if (dialogue.TakeChapterBranch(branchChapter, branchLabel) &&
+                        branches.Enter(branchChapter, branchLabel, parser, dialogue)) {
+                        currentChapter = branchChapter;
+                    }
+                }
+                
+                // Después de la entrada: la voz es la de la línea que queda en pantalla
+                voices.Update(dialogue, currentChapter, sceneManager, deltaTime);
+                
+                // Guardado rápido (F5): copia el estado y vuelve sin esperar al disco
+                if (IsKeyPressed(KEY_F5)) {
+                    saves.QuickSave(currentChapter, dialogue, sceneManager);
+                }
+                
+                // Carga rápida (F9): capítulo y escena guardada detrás de la pantalla de carga
+                if (IsKeyPressed(KEY_F9) && saves.QuickLoad(resumeData)) {
+                    std::string previousLanguage = ResourceManager::GetInstance()->GetLanguage();
+                    ResourceManager::GetInstance()->SetLanguage(resumeData.language);
+                    if (chapterLoader.Begin(resumeData.chapter, parser, dialogue, &resumeData.scene,
+                                            resumeData.line)) {
+                        currentChapter = resumeData.chapter;
+                        resumePending = true;
+                        splash.Reset();
+                        currentState = STATE_SPLASH;
+                    } else {
+                        ResourceManager::GetInstance()->SetLanguage(previousLanguage);
                     }
                 }
                 
                 if (dialogue.IsFinished()) {
-                    currentState = STATE_EXIT;
+                    // Siguiente capítulo (ch0 -> ch1) detrás de la misma pantalla de carga
+                    std::string nextChapter = ChapterLoader::GetNextChapterName(currentChapter);
+                    if (ChapterLoader::ChapterExists(nextChapter) &&
+                        chapterLoader.Begin(nextChapter, parser, dialogue)) {
+                        currentChapter = nextChapter;
+                        splash.Reset();
+                        currentState = STATE_SPLASH;
+                    } else {
+                        currentState = STATE_EXIT;
+                    }
                 }
                 break;
                 
@@ -104,27 +205,103 @@ int main() {
         if (currentState == STATE_SPLASH) {
             splash.Render(engine.GetScreenWidth(), engine.GetScreenHeight());
         } else {
-            // Renderizar escena
-            sceneManager.RenderBackground(engine.GetScreenWidth(), engine.GetScreenHeight());
-            sceneManager.RenderCharacters(engine.GetScreenWidth(), engine.GetScreenHeight());
+            // Renderizar escena (capa cacheada: solo se recompone si cambió)
+            sceneManager.RenderScene(engine.GetScreenWidth(), engine.GetScreenHeight());
             
             // Renderizar diálogo
             dialogue.Render(engine.GetScreenWidth(), engine.GetScreenHeight());
             
             // Mostrar controles (debug)
-            DrawText("ESPACIO/CLICK: Continuar | BACKSPACE/CLICK-DER: Atrás | CTRL: Avance rápido | ESC: Salir", 
+            DrawText("ESPACIO/CLICK: Continuar | BACKSPACE/CLICK-DER: Atrás | CTRL: Avance rápido | F5/F9: Guardar/Cargar | ESC: Salir", 
                     10, 10, 16, WHITE);
             
+            // Aviso al terminar de escribirse un guardado
+            if (saves.GetCompletedSaves() != noticedSaves) {
+                noticedSaves = saves.GetCompletedSaves();
+                saveNoticeTimer = 2.0f;
+            }
+            if (saveNoticeTimer > 0.0f) {
+                saveNoticeTimer -= deltaTime;
+                DrawText("Partida guardada", engine.GetScreenWidth() - 200, 10, 20, GREEN);
+            }
+            
             // Mostrar info de debug
             if (IsKeyDown(KEY_F1)) {
                 DrawText(TextFormat("Línea: %d/%d", 
                         (int)dialogue.GetCurrentLineIndex() + 1, 
                         (int)dialogue.GetTotalLines()), 
                         10, 40, 16, YELLOW);
+                
+                // Uso de caché para ajustar los presupuestos de cada plataforma
+                const char* cacheNames[] = { "Texturas", "Sonidos", "Musica" };
+                for (int i = 0; i < (int)CacheClass::COUNT; i++) {
+                    CacheStats stats = ResourceManager::GetInstance()->GetCacheStats((CacheClass)i);
+                    DrawText(TextFormat("%s: %.1f/%.0f MB (%d) | hits %llu | miss %llu | expulsados %llu",
+                            cacheNames[i], stats.bytesUsed / (1024.0f * 1024.0f),
+                            stats.budgetBytes / (1024.0f * 1024.0f), (int)stats.entries,
+                            (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+                            (unsigned long long)stats.evictions),
+                            10, 60 + i * 20, 16, YELLOW);
+                }
+                
+                // Cambios de textura por frame en la escena (los atlas los reducen)
+                DrawText(TextFormat("Cambios de textura: %d | Capa compuesta %d veces | Reposo: %s",
+                        sceneManager.GetTextureBinds(), sceneManager.GetLayerCompositions(),
+                        engine.IsIdle() ? "si" : "no"),
+                        10, 60 + (int)CacheClass::COUNT * 20, 16, YELLOW);
+                
+                // Hilo de la música: pasadas tardías y margen decodificado
+                MusicStats music = sceneManager.GetMusicStats();
+                DrawText(TextFormat("Musica: underruns %llu | mayor hueco %.1f ms | buffer %.0f ms | pasadas %llu",
+                        (unsigned long long)music.underruns, music.maxGapMs, music.bufferMs,
+                        (unsigned long long)music.refills),
+                        10, 80 + (int)CacheClass::COUNT * 20, 16, YELLOW);
+                
+                SoundStats sounds = sceneManager.GetSoundStats();
+                DrawText(TextFormat("Efectos: voces %d/%d | robadas %llu | rechazados %llu | esperaron %llu | perdidos %llu",
+                        sounds.activeVoices, SoundMixer::VOICE_COUNT, (unsigned long long)sounds.stolen,
+                        (unsigned long long)sounds.rejected, (unsigned long long)sounds.delayed,
+                        (unsigned long long)sounds.dropped),
+                        10, 100 + (int)CacheClass::COUNT * 20, 16, YELLOW);
+                
+                VoiceStats voiceStats = voices.GetStats();
+                DrawText(TextFormat("Voz: ventana %d clips (%.0f KB) | reproducidas %llu | tarde %llu",
+                        voiceStats.windowClips, voiceStats.windowBytes / 1024.0f,
+                        (unsigned long long)voiceStats.played, (unsigned long long)voiceStats.late),
+                        10, 120 + (int)CacheClass::COUNT * 20, 16, YELLOW);
             }
         }
         
-        EndDrawing();
+        // Profiler: F3 muestra la gráfica por etapas, F4 guarda un trace de Chrome/Perfetto
+        if (IsKeyPressed(KEY_F3)) {
+            showProfiler = !showProfiler;
+        }
+        if (IsKeyPressed(KEY_F4)) {
+            Profiler::GetInstance()->ExportChromeTrace(TextFormat("trace_%lld.json", (long long)time(nullptr)));
+        }
+        if (showProfiler) {
+            Profiler::GetInstance()->RenderOverlay(engine.GetScreenWidth() - 490, 40, 480);
+        }
+        
+        // Modo reposo: con el texto ya revelado y sin entrada se baja el ritmo de frames
+        Vector2 mouseDelta = GetMouseDelta();
+        bool inputActive = GetKeyPressed() != 0 || mouseDelta.x != 0.0f || mouseDelta.y != 0.0f ||
+                           GetMouseWheelMove() != 0.0f ||
+                           IsMouseButtonDown(MOUSE_BUTTON_LEFT) || IsMouseButtonDown(MOUSE_BUTTON_RIGHT) ||
+                           IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL) || IsKeyDown(KEY_F1);
+        bool sceneChanged = currentState != STATE_DIALOGUE || inputActive || showProfiler ||
+                            IsWindowResized() || sceneManager.IsDirty() || dialogue.IsDirty() ||
+                            saveNoticeTimer > 0.0f || saves.IsSaving() ||
+                            ResourceManager::GetInstance()->HasPendingLoads();
+        engine.UpdateIdleState(sceneChanged, deltaTime);
+        sceneManager.ClearDirty();
+        dialogue.ClearDirty();
+        
+        {
+            PROFILE_SCOPE("EndDrawing");
+            EndDrawing();
+        }
+        Profiler::GetInstance()->EndFrame();
         
         // Salir con ESC
         if (IsKeyPressed(KEY_ESCAPE)) {
@@ -133,6 +310,10 @@ int main() {
     }
     
     // Cleanup
+    saves.Shutdown();
+    voices.Reset(sceneManager);
+    sceneManager.Shutdown();
+    readHistory.SaveToFile("saves/read_lines.dat");
     ResourceManager::Destroy();
     engine.Shutdown();
     return 0;
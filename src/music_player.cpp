@@ -0,0 +1,308 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "profiler.h"
+#include "music_player.h"
+#include <chrono>
+
+MusicPlayer::MusicPlayer()
+    : primary(0), volume(0.5f), voice{ 0 }, voiceActive(false), voiceVolume(1.0f),
+      duck(1.0f), duckTarget(1.0f), duckLevel(0.35f), stopping(false), trackRevision(0),
+      voicePlaying(false), refills(0), underruns(0), maxGapMicros(0), bufferMicros(0) {
+    for (Track& track : tracks) {
+        track.music = (Music){ 0 };
+        track.name = NO_SYMBOL;
+        track.gain = 0.0f;
+        track.target = 0.0f;
+        track.fadeSpeed = 0.0f;
+        track.active = false;
+    }
+    worker = std::thread(&MusicPlayer::WorkerLoop, this);
+}
+
+MusicPlayer::~MusicPlayer() {
+    Shutdown();
+}
+
+void MusicPlayer::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+
+    for (Track& track : tracks) {
+        if (track.active) {
+            Release(track);
+        }
+    }
+    if (voiceActive) {
+        StopMusicStream(voice);
+        voiceActive = false;
+        voicePlaying = false;
+    }
+}
+
+void MusicPlayer::WorkerLoop() {
+    Profiler::GetInstance()->SetThreadName("MusicPlayer");
+
+    std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait_for(lock, std::chrono::milliseconds(UPDATE_INTERVAL_MS), [this] { return stopping; });
+        if (stopping) return;
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        float elapsed = std::chrono::duration<float>(now - last).count();
+        last = now;
+        Refill(elapsed);
+    }
+}
+
+void MusicPlayer::Refill(float elapsed) {
+    PROFILE_SCOPE("MusicPlayer::Refill");
+    float ahead = 0.0f;
+
+    // La voz primero: si termina, la música empieza a subir en esta misma pasada
+    if (voiceActive) {
+        UpdateMusicStream(voice);
+        if (voice.stream.sampleRate > 0) {
+            ahead = (float)BUFFER_FRAMES / (float)voice.stream.sampleRate;
+        }
+        if (!IsMusicStreamPlaying(voice)) {
+            voiceActive = false;
+            voicePlaying = false;
+            duckTarget = 1.0f;
+        }
+    }
+    bool duckChanged = duck != duckTarget;
+    if (duckChanged) {
+        float step = elapsed * 1000.0f / DUCK_FADE_MS;
+        if (duck < duckTarget) {
+            duck = (duck + step < duckTarget) ? duck + step : duckTarget;
+        } else {
+            duck = (duck - step > duckTarget) ? duck - step : duckTarget;
+        }
+    }
+    for (Track& track : tracks) {
+        if (!track.active) {
+            continue;
+        }
+        UpdateMusicStream(track.music);
+        if (track.music.stream.sampleRate > 0) {
+            float seconds = (float)BUFFER_FRAMES / (float)track.music.stream.sampleRate;
+            ahead = (ahead == 0.0f || seconds < ahead) ? seconds : ahead;
+        }
+
+        if (track.gain != track.target) {
+            float step = track.fadeSpeed * elapsed;
+            if (track.gain < track.target) {
+                track.gain = (track.gain + step < track.target) ? track.gain + step : track.target;
+            } else {
+                track.gain = (track.gain - step > track.target) ? track.gain - step : track.target;
+            }
+            if (track.gain <= 0.0f && track.target <= 0.0f) {
+                Release(track);
+                continue;
+            }
+            ApplyVolume(track);
+        } else if (duckChanged) {
+            ApplyVolume(track);
+        }
+    }
+
+    // En silencio los huecos no cuentan
+    if (ahead == 0.0f) {
+        return;
+    }
+    refills++;
+    bufferMicros = (uint32_t)(ahead * 1000000.0f);
+
+    // Se rellena un sub-buffer cada vez que el dispositivo acaba otro: si la
+    // pasada llega más tarde que lo que dura uno, el dispositivo pudo quedarse sin datos
+    uint32_t gap = (uint32_t)(elapsed * 1000000.0f);
+    if (gap > maxGapMicros.load()) {
+        maxGapMicros = gap;
+    }
+    if (elapsed > ahead) {
+        underruns++;
+    }
+}
+
+void MusicPlayer::StartFade(Track& track, float target, float seconds) {
+    track.target = target;
+    if (seconds <= 0.0f) {
+        if (target <= 0.0f) {
+            Release(track);
+            return;
+        }
+        track.gain = target;
+        track.fadeSpeed = 0.0f;
+    } else {
+        track.fadeSpeed = 1.0f / seconds;
+    }
+    ApplyVolume(track);
+}
+
+void MusicPlayer::ApplyVolume(Track& track) {
+    ::SetMusicVolume(track.music, volume * track.gain * duck);
+}
+
+void MusicPlayer::Release(Track& track) {
+    StopMusicStream(track.music);
+    track.music = (Music){ 0 };
+    track.name = NO_SYMBOL;
+    track.gain = 0.0f;
+    track.target = 0.0f;
+    track.active = false;
+    trackRevision++;
+}
+
+void MusicPlayer::Play(Music music, Symbol name, bool loop, float fadeSeconds, float start) {
+    PROFILE_SCOPE("MusicPlayer::Play");
+    std::lock_guard<std::mutex> lock(mutex);
+    Track& current = tracks[primary];
+    Track& other = tracks[1 - primary];
+
+    if (current.active && current.name == name) {
+        StartFade(current, 1.0f, fadeSeconds);
+        return;
+    }
+    if (other.active && other.name == name) {
+        // Vuelve la pista que estaba saliendo: se cruzan de nuevo
+        if (current.active) {
+            StartFade(current, 0.0f, fadeSeconds);
+        }
+        primary = 1 - primary;
+        StartFade(other, 1.0f, fadeSeconds);
+        return;
+    }
+
+    if (current.active) {
+        // Una tercera pista durante un fundido: la que ya salía se corta
+        if (other.active) {
+            Release(other);
+        }
+        StartFade(current, 0.0f, fadeSeconds);
+        primary = 1 - primary;
+    }
+    if (music.ctxType == 0) {
+        return;
+    }
+
+    Track& incoming = tracks[primary];
+    incoming.music = music;
+    incoming.music.looping = loop;
+    incoming.name = name;
+    incoming.gain = 0.0f;
+    incoming.active = true;
+    StartFade(incoming, 1.0f, fadeSeconds);
+    PlayMusicStream(incoming.music);
+    if (start > 0.0f) {
+        SeekMusicStream(incoming.music, start);
+    }
+}
+
+void MusicPlayer::Stop(float fadeSeconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Track& current = tracks[primary];
+    if (current.active) {
+        StartFade(current, 0.0f, fadeSeconds);
+    }
+}
+
+void MusicPlayer::SetVolume(float newVolume) {
+    std::lock_guard<std::mutex> lock(mutex);
+    volume = newVolume;
+    for (Track& track : tracks) {
+        if (track.active) {
+            ApplyVolume(track);
+        }
+    }
+}
+
+void MusicPlayer::PlayVoice(Music clip) {
+    PROFILE_SCOPE("MusicPlayer::PlayVoice");
+    std::lock_guard<std::mutex> lock(mutex);
+    if (voiceActive) {
+        StopMusicStream(voice);
+    }
+    voice = clip;
+    voiceActive = voice.ctxType != 0;
+    voicePlaying = voiceActive;
+    if (!voiceActive) {
+        duckTarget = 1.0f;
+        return;
+    }
+    voice.looping = false;
+    ::SetMusicVolume(voice, voiceVolume);
+    // StopMusicStream rebobina: un clip ya oído (al volver atrás) empieza de cero
+    StopMusicStream(voice);
+    PlayMusicStream(voice);
+    duckTarget = duckLevel;
+}
+
+void MusicPlayer::StopVoice() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (voiceActive) {
+        StopMusicStream(voice);
+        voiceActive = false;
+        voicePlaying = false;
+    }
+    voice = (Music){ 0 };
+    duckTarget = 1.0f;
+}
+
+void MusicPlayer::SetVoiceVolume(float newVolume) {
+    std::lock_guard<std::mutex> lock(mutex);
+    voiceVolume = newVolume;
+    if (voiceActive) {
+        ::SetMusicVolume(voice, voiceVolume);
+    }
+}
+
+void MusicPlayer::SetDuckLevel(float level) {
+    std::lock_guard<std::mutex> lock(mutex);
+    duckLevel = level;
+    if (voiceActive) {
+        duckTarget = duckLevel;
+    }
+}
+
+float MusicPlayer::GetPosition() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Track& current = tracks[primary];
+    if (!current.active || current.target <= 0.0f) {
+        return -1.0f;
+    }
+    return GetMusicTimePlayed(current.music);
+}
+
+bool MusicPlayer::IsCrossfading() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return tracks[1 - primary].active;
+}
+
+void MusicPlayer::CollectTracks(std::vector<Symbol>& names) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const Track& track : tracks) {
+        if (track.active) {
+            names.push_back(track.name);
+        }
+    }
+}
+
+MusicStats MusicPlayer::GetStats() const {
+    MusicStats stats;
+    stats.refills = refills.load();
+    stats.underruns = underruns.load();
+    stats.maxGapMs = maxGapMicros.load() / 1000.0f;
+    stats.bufferMs = bufferMicros.load() / 1000.0f;
+    return stats;
+}
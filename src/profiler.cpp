@@ -0,0 +1,351 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+// Buffer del hilo actual: al terminar el hilo vuelve a la lista libre del
+// profiler y lo reutiliza el siguiente (los hilos de corta vida no acumulan)
+struct ThreadBufferOwner {
+    Profiler::ThreadBuffer* buffer = nullptr;
+
+    ~ThreadBufferOwner() {
+        if (buffer != nullptr) {
+            Profiler::GetInstance()->ReleaseThreadBuffer(buffer);
+        }
+    }
+};
+
+thread_local ThreadBufferOwner localBuffer;
+
+} // namespace
+
+static const Color stageColors[Profiler::MAX_STAGES] = {
+    SKYBLUE, LIME, ORANGE, PINK, GOLD, VIOLET, BEIGE, GRAY
+};
+
+static bool SameName(const char* a, const char* b) {
+    return a == b || strcmp(a, b) == 0;
+}
+
+Profiler::Profiler()
+    : epoch(std::chrono::steady_clock::now()), enabled(true), nextThreadId(1), mainThread(nullptr),
+      frameStart(0), frameFirstEvent(0), historyIndex(0), stageCount(0),
+      zoneCount(0), windowFrames(0) {
+    memset(history, 0, sizeof(history));
+    memset(stageNames, 0, sizeof(stageNames));
+    memset(zones, 0, sizeof(zones));
+    stageNames[MAX_STAGES - 1] = "Otros";
+}
+
+Profiler::~Profiler() {
+}
+
+Profiler* Profiler::GetInstance() {
+    // Estático local: se construye una sola vez aunque lo pidan varios hilos a la vez
+    static Profiler profiler;
+    return &profiler;
+}
+
+uint64_t Profiler::Now() const {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - epoch).count();
+}
+
+Profiler::ThreadBuffer* Profiler::GetThreadBuffer() {
+    if (localBuffer.buffer != nullptr) {
+        return localBuffer.buffer;
+    }
+
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    ThreadBuffer* buffer;
+    if (!freeBuffers.empty()) {
+        // Las zonas del hilo anterior se descartan: la traza solo tiene hilos vivos o recientes
+        buffer = freeBuffers.back();
+        freeBuffers.pop_back();
+        buffer->written.store(0, std::memory_order_relaxed);
+        buffer->depth = 0;
+    } else {
+        threads.push_back(std::make_unique<ThreadBuffer>());
+        buffer = threads.back().get();
+    }
+    buffer->threadId = nextThreadId++;
+    buffer->threadName = "Hilo " + std::to_string(buffer->threadId);
+
+    localBuffer.buffer = buffer;
+    return buffer;
+}
+
+void Profiler::ReleaseThreadBuffer(ThreadBuffer* buffer) {
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    freeBuffers.push_back(buffer);
+}
+
+void Profiler::SetThreadName(const std::string& name) {
+    ThreadBuffer* buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    buffer->threadName = name;
+}
+
+void Profiler::Record(ThreadBuffer& buffer, const char* name, uint64_t start, uint64_t end, uint32_t depth) {
+    // Un solo escritor por buffer: basta con publicar el índice al final
+    uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    ProfileEvent& event = buffer.events[index & (ThreadBuffer::CAPACITY - 1)];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    event.depth = depth;
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::Begin(ThreadBuffer& buffer) {
+    buffer.depth++;
+}
+
+void Profiler::End(ThreadBuffer& buffer, const char* name, uint64_t start) {
+    uint64_t end = Now();
+    buffer.depth--;
+    Record(buffer, name, start, end, buffer.depth);
+}
+
+void Profiler::BeginFrame() {
+    if (!IsEnabled()) return;
+
+    if (mainThread == nullptr) {
+        mainThread = GetThreadBuffer();
+    }
+    frameStart = Now();
+    frameFirstEvent = mainThread->written.load(std::memory_order_relaxed);
+}
+
+int Profiler::FindStage(const char* name) {
+    for (int i = 0; i < stageCount; i++) {
+        if (SameName(stageNames[i], name)) return i;
+    }
+    if (stageCount < MAX_STAGES - 1) {
+        stageNames[stageCount] = name;
+        return stageCount++;
+    }
+    return MAX_STAGES - 1;
+}
+
+Profiler::ZoneStats* Profiler::FindZone(const char* name) {
+    for (int i = 0; i < zoneCount; i++) {
+        if (SameName(zones[i].name, name)) return &zones[i];
+    }
+    if (zoneCount < MAX_ZONES) {
+        ZoneStats& zone = zones[zoneCount++];
+        memset(&zone, 0, sizeof(zone));
+        zone.name = name;
+        return &zone;
+    }
+    return nullptr;
+}
+
+void Profiler::EndFrame() {
+    if (!IsEnabled() || mainThread == nullptr) return;
+
+    uint64_t frameEnd = Now();
+    FrameSample& sample = history[historyIndex];
+    memset(&sample, 0, sizeof(sample));
+    sample.totalMs = (frameEnd - frameStart) / 1e6f;
+
+    // Zonas del hilo principal cerradas durante este frame
+    uint64_t last = mainThread->written.load(std::memory_order_relaxed);
+    uint64_t first = frameFirstEvent;
+    if (last - first > ThreadBuffer::CAPACITY) {
+        first = last - ThreadBuffer::CAPACITY;
+    }
+    for (uint64_t i = first; i < last; i++) {
+        const ProfileEvent& event = mainThread->events[i & (ThreadBuffer::CAPACITY - 1)];
+        float ms = (event.end - event.start) / 1e6f;
+        if (event.depth == 0) {
+            sample.stageMs[FindStage(event.name)] += ms;
+        }
+        ZoneStats* zone = FindZone(event.name);
+        if (zone != nullptr) {
+            zone->frameMs += ms;
+            zone->windowCalls++;
+        }
+    }
+
+    windowFrames++;
+    for (int i = 0; i < zoneCount; i++) {
+        ZoneStats& zone = zones[i];
+        zone.windowMs += zone.frameMs;
+        zone.windowPeakMs = std::max(zone.windowPeakMs, zone.frameMs);
+        zone.frameMs = 0.0f;
+        if (windowFrames >= ZONE_WINDOW) {
+            zone.averageMs = zone.windowMs / windowFrames;
+            zone.peakMs = zone.windowPeakMs;
+            zone.calls = zone.windowCalls;
+            zone.windowMs = zone.windowPeakMs = 0.0f;
+            zone.windowCalls = 0;
+        }
+    }
+    if (windowFrames >= ZONE_WINDOW) {
+        windowFrames = 0;
+    }
+
+    historyIndex = (historyIndex + 1) % HISTORY_FRAMES;
+    Record(*mainThread, "Frame", frameStart, frameEnd, 0);
+}
+
+void Profiler::RenderOverlay(int x, int y, int width) {
+    const int graphHeight = 100;
+    const float msScale = graphHeight / 33.3f;   // La gráfica llega a 2 frames de 60 fps
+    char text[160];
+
+    DrawRectangle(x, y, width, graphHeight, Fade(BLACK, 0.7f));
+
+    // Barras apiladas por etapa, de la más antigua a la más reciente
+    int barWidth = std::max(1, width / HISTORY_FRAMES);
+    for (int i = 0; i < HISTORY_FRAMES && (i + 1) * barWidth <= width; i++) {
+        const FrameSample& sample = history[(historyIndex + i) % HISTORY_FRAMES];
+        int barX = x + i * barWidth;
+        float stacked = 0.0f;
+        for (int stage = 0; stage < MAX_STAGES; stage++) {
+            float top = std::min(stacked + sample.stageMs[stage], 33.3f);
+            int height = (int)(top * msScale) - (int)(stacked * msScale);
+            if (height > 0) {
+                DrawRectangle(barX, y + graphHeight - (int)(top * msScale), barWidth, height, stageColors[stage]);
+            }
+            stacked = top;
+        }
+        // Tiempo fuera de las etapas medidas (entrada, ventana, vsync)
+        float total = std::min(sample.totalMs, 33.3f);
+        if (total > stacked) {
+            int height = (int)(total * msScale) - (int)(stacked * msScale);
+            DrawRectangle(barX, y + graphHeight - (int)(total * msScale), barWidth, height, Fade(WHITE, 0.25f));
+        }
+    }
+
+    // Referencias de 60 y 30 fps
+    DrawRectangle(x, y + graphHeight - (int)(16.7f * msScale), width, 1, Fade(GREEN, 0.8f));
+    DrawRectangle(x, y, width, 1, Fade(RED, 0.8f));
+
+    // Leyenda: media de cada etapa en la última ventana
+    float stageAverage[MAX_STAGES] = { 0 };
+    float totalAverage = 0.0f, worst = 0.0f;
+    for (int i = 1; i <= ZONE_WINDOW; i++) {
+        const FrameSample& sample = history[(historyIndex - i + HISTORY_FRAMES) % HISTORY_FRAMES];
+        for (int stage = 0; stage < MAX_STAGES; stage++) {
+            stageAverage[stage] += sample.stageMs[stage] / ZONE_WINDOW;
+        }
+        totalAverage += sample.totalMs / ZONE_WINDOW;
+        worst = std::max(worst, sample.totalMs);
+    }
+
+    int lineY = y + graphHeight + 4;
+    snprintf(text, sizeof(text), "Frame: %.2f ms (peor %.2f ms) | F4: exportar trace", totalAverage, worst);
+    DrawText(text, x, lineY, 16, YELLOW);
+    lineY += 18;
+
+    for (int stage = 0; stage < MAX_STAGES; stage++) {
+        if (stageNames[stage] == nullptr || (stage == MAX_STAGES - 1 && stageAverage[stage] <= 0.0f)) continue;
+        DrawRectangle(x, lineY + 3, 10, 10, stageColors[stage]);
+        snprintf(text, sizeof(text), "%s: %.2f ms", stageNames[stage], stageAverage[stage]);
+        DrawText(text, x + 16, lineY, 16, WHITE);
+        lineY += 18;
+    }
+
+    // Zonas más caras (incluye las anidadas: carga, decodificación, layout)
+    int order[MAX_ZONES];
+    for (int i = 0; i < zoneCount; i++) order[i] = i;
+    std::sort(order, order + zoneCount, [this](int a, int b) {
+        return zones[a].peakMs > zones[b].peakMs;
+    });
+
+    lineY += 4;
+    for (int i = 0; i < zoneCount && i < 12; i++) {
+        const ZoneStats& zone = zones[order[i]];
+        if (zone.peakMs <= 0.0f) break;
+        snprintf(text, sizeof(text), "%-32s media %6.3f ms | pico %6.3f ms | %u llamadas",
+                 zone.name, zone.averageMs, zone.peakMs, zone.calls);
+        DrawText(text, x, lineY, 14, LIGHTGRAY);
+        lineY += 16;
+    }
+}
+
+static void WriteJsonString(std::ofstream& file, const std::string& value) {
+    file << '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') file << '\\' << c;
+        else if ((unsigned char)c < 0x20) file << ' ';
+        else file << c;
+    }
+    file << '"';
+}
+
+bool Profiler::ExportChromeTrace(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Warning: Could not write trace: " << path << std::endl;
+        return false;
+    }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool firstEntry = true;
+    std::vector<ProfileEvent> snapshot;
+
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    for (const auto& buffer : threads) {
+        if (!firstEntry) file << ",";
+        firstEntry = false;
+        file << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+             << ",\"args\":{\"name\":";
+        WriteJsonString(file, buffer->threadName);
+        file << "}}";
+
+        // Copia del buffer; lo que el hilo sobrescriba mientras tanto se descarta
+        uint64_t last = buffer->written.load(std::memory_order_acquire);
+        uint64_t first = last > ThreadBuffer::CAPACITY ? last - ThreadBuffer::CAPACITY : 0;
+        snapshot.resize((size_t)(last - first));
+        for (uint64_t i = first; i < last; i++) {
+            snapshot[(size_t)(i - first)] = buffer->events[i & (ThreadBuffer::CAPACITY - 1)];
+        }
+        uint64_t after = buffer->written.load(std::memory_order_acquire);
+        uint64_t valid = after > ThreadBuffer::CAPACITY ? after - ThreadBuffer::CAPACITY : 0;
+
+        char entry[96];
+        for (uint64_t i = std::max(first, valid); i < last; i++) {
+            const ProfileEvent& event = snapshot[(size_t)(i - first)];
+            file << ",\n{\"name\":";
+            WriteJsonString(file, event.name);
+            snprintf(entry, sizeof(entry), ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                     buffer->threadId, event.start / 1000.0, (event.end - event.start) / 1000.0);
+            file << entry;
+        }
+    }
+    file << "\n]}\n";
+
+    if (!file) {
+        std::cerr << "Warning: Could not write trace: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+ProfileScope::ProfileScope(const char* zoneName) : buffer(nullptr), name(zoneName), start(0) {
+    Profiler* profiler = Profiler::GetInstance();
+    if (profiler->IsEnabled()) {
+        buffer = profiler->GetThreadBuffer();
+        start = profiler->Now();
+        profiler->Begin(*buffer);
+    }
+}
+
+ProfileScope::~ProfileScope() {
+    if (buffer != nullptr) {
+        Profiler::GetInstance()->End(*buffer, name, start);
+    }
+}
@@ -0,0 +1,166 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "read_history.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char HISTORY_MAGIC[4] = { 'N', 'X', 'R', 'L' };
+
+template <typename T>
+bool ReadValue(std::ifstream& file, T& value) {
+    return (bool)file.read((char*)&value, sizeof(T));
+}
+
+template <typename T>
+void WriteValue(std::ofstream& file, const T& value) {
+    file.write((const char*)&value, sizeof(T));
+}
+
+} // namespace
+
+void LineBitset::Resize(size_t lines) {
+    count = lines;
+    words.resize((lines + 63) / 64, 0);
+    // Sin bits sueltos más allá de count (FindNextUnset los daría por leídos)
+    if (lines % 64 != 0) {
+        words.back() &= (1ULL << (lines % 64)) - 1;
+    }
+}
+
+bool LineBitset::Test(size_t line) const {
+    return line < count && (words[line / 64] >> (line % 64)) & 1;
+}
+
+void LineBitset::Set(size_t line) {
+    if (line >= count) {
+        Resize(line + 1);
+    }
+    words[line / 64] |= 1ULL << (line % 64);
+}
+
+size_t LineBitset::FindNextUnset(size_t from) const {
+    // Palabra a palabra: saltar miles de líneas leídas cuesta unas decenas de operaciones
+    for (size_t word = from / 64; word < words.size(); word++) {
+        uint64_t unset = ~words[word];
+        if (word == from / 64) {
+            unset &= ~0ULL << (from % 64);
+        }
+        if (unset != 0) {
+            size_t line = word * 64 + (size_t)__builtin_ctzll(unset);
+            return (line < count) ? line : count;
+        }
+    }
+    return count;
+}
+
+void LineBitset::SetWords(std::vector<uint64_t>&& data, size_t lines) {
+    words = std::move(data);
+    Resize(lines);
+}
+
+bool ReadHistory::LoadFromFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;   // Primera partida
+    }
+
+    char magic[4];
+    uint16_t version = 0;
+    uint32_t chapterCount = 0;
+    if (!file.read(magic, 4) || memcmp(magic, HISTORY_MAGIC, 4) != 0 ||
+        !ReadValue(file, version) || version != VERSION || !ReadValue(file, chapterCount)) {
+        std::cerr << "Warning: Invalid read history: " << path << std::endl;
+        return false;
+    }
+
+    chapters.clear();
+    for (uint32_t i = 0; i < chapterCount; i++) {
+        uint16_t nameLength = 0;
+        uint64_t hash = 0;
+        uint32_t lineCount = 0;
+        std::string name;
+
+        if (!ReadValue(file, nameLength)) break;
+        name.resize(nameLength);
+        if (!file.read(&name[0], nameLength) || !ReadValue(file, hash) || !ReadValue(file, lineCount)) break;
+
+        std::vector<uint64_t> words((lineCount + 63) / 64);
+        if (!file.read((char*)words.data(), words.size() * sizeof(uint64_t))) break;
+
+        ChapterEntry& entry = chapters[name];
+        entry.hash = hash;
+        entry.lines.SetWords(std::move(words), lineCount);
+    }
+
+    if (!file) {
+        std::cerr << "Warning: Truncated read history: " << path << std::endl;
+    }
+    return true;
+}
+
+bool ReadHistory::SaveToFile(const std::string& path) const {
+    std::error_code ec;
+    fs::path target(path);
+    if (target.has_parent_path()) {
+        fs::create_directories(target.parent_path(), ec);
+    }
+
+    // Se escribe aparte y se renombra: un cierre a medias no borra el historial
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Warning: Could not write read history: " << path << std::endl;
+            return false;
+        }
+
+        file.write(HISTORY_MAGIC, 4);
+        WriteValue(file, (uint16_t)VERSION);
+        WriteValue(file, (uint32_t)chapters.size());
+        for (const auto& pair : chapters) {
+            const LineBitset& lines = pair.second.lines;
+            WriteValue(file, (uint16_t)pair.first.size());
+            file.write(pair.first.data(), pair.first.size());
+            WriteValue(file, pair.second.hash);
+            WriteValue(file, (uint32_t)lines.GetCount());
+            file.write((const char*)lines.GetWords().data(), lines.GetWords().size() * sizeof(uint64_t));
+        }
+        if (!file.good()) {
+            std::cerr << "Warning: Could not write read history: " << path << std::endl;
+            return false;
+        }
+    }
+
+    fs::rename(temp, target, ec);
+    if (ec) {
+        std::cerr << "Warning: Could not replace read history: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+LineBitset& ReadHistory::GetChapter(const std::string& name, const ScriptChapter& chapter) {
+    uint64_t hash = chapter.GetContentHash();
+    auto it = chapters.find(name);
+    if (it == chapters.end() || it->second.hash != hash) {
+        ChapterEntry& entry = chapters[name];
+        entry.hash = hash;
+        entry.lines.Clear();
+        entry.lines.Resize(chapter.GetLineCount());
+        return entry.lines;
+    }
+    if (it->second.lines.GetCount() < chapter.GetLineCount()) {
+        it->second.lines.Resize(chapter.GetLineCount());
+    }
+    return it->second.lines;
+}
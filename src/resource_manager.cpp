@@ -4,15 +4,27 @@
 #include "scene_manager.h"
 #include "dialogue_parser.h"
 #include "resource_manager.h"
+#include "profiler.h"
 #include <iostream>
 
 ResourceManager* ResourceManager::instance = nullptr;
 
 ResourceManager::ResourceManager() 
-    : resourcePath("resources/"), currentLanguage("spa-spa") {
+    : resourcePath("resources/"), currentLanguage("spa-spa"),
+      uploadBudgetBytes(16 * 1024 * 1024), evictionEpoch(0) {
+    for (auto& cache : caches) {
+        cache.stats = (CacheStats){ 0 };
+    }
+    
+    // Presupuestos por defecto; cada plataforma los ajusta con SetCacheBudget
+    caches[(int)CacheClass::TEXTURE].stats.budgetBytes = 512 * 1024 * 1024;
+    caches[(int)CacheClass::SOUND].stats.budgetBytes = 64 * 1024 * 1024;
+    caches[(int)CacheClass::MUSIC].stats.budgetBytes = 8 * 1024 * 1024;
 }
 
 ResourceManager::~ResourceManager() {
+    // Parar los workers antes de liberar nada
+    loader.Stop();
     UnloadAll();
 }
 
@@ -35,221 +47,825 @@ void ResourceManager::Initialize(const std::string& resPath) {
     if (resourcePath.back() != '/') {
         resourcePath += '/';
     }
+    
+    // Buffers de la música antes de abrir ninguna pista: los rellena el hilo
+    // del MusicPlayer y tienen que aguantar lo que tarde en volver
+    SetAudioStreamBufferSizeDefault(MusicPlayer::BUFFER_FRAMES);
+    
+    // resources/ -> resources.pak
+    OpenPack(resourcePath.substr(0, resourcePath.size() - 1) + ".pak");
+    LoadAtlasIndex();
+    loader.Start();
+}
+
+void ResourceManager::LoadAtlasIndex() {
+    atlas.Clear();
+    spriteSources.Clear();
+    
+    PackEntry entry;
+    if (pack.Find("atlas/characters.atlas", entry)) {
+        atlas.LoadFromText(std::string((const char*)entry.data, entry.size).c_str());
+    } else if (AllowLooseFiles()) {
+        std::string path = resourcePath + "atlases/characters.atlas";
+        if (!FileExists(path.c_str())) {
+            return;
+        }
+        char* text = LoadFileText(path.c_str());
+        if (text != nullptr) {
+            atlas.LoadFromText(text);
+            UnloadFileText(text);
+        }
+    }
+}
+
+std::string ResourceManager::AtlasPageKey(int page) const {
+    // characters_0.png -> atlas_characters_0
+    std::string file = atlas.GetPageName(page);
+    return "atlas_" + file.substr(0, file.find_last_of('.'));
+}
+
+const ResourceManager::SpriteSource& ResourceManager::ResolveSprite(Symbol character, Symbol emotion) {
+    SymbolTable<SpriteSource>& emotions = spriteSources[character];
+    if (const SpriteSource* known = emotions.Find(emotion)) {
+        return *known;
+    }
+    
+    // Primera vez que se pide este sprite: aquí sí se construyen las rutas
+    const std::string& characterName = SymbolName(character);
+    const std::string& emotionName = SymbolName(emotion);
+    SpriteSource& source = emotions[emotion];
+    source.inAtlas = atlas.Find(characterName, emotionName, source.frame);
+    if (source.inAtlas) {
+        std::string key = AtlasPageKey(source.frame.page);
+        source.textureKey = Intern(key);
+        source.packKey = key;
+        source.path = resourcePath + "atlases/" + atlas.GetPageName(source.frame.page);
+    } else {
+        source.textureKey = Intern(characterName + "_" + emotionName);
+        source.packKey = characterName + "/" + emotionName;
+        source.path = resourcePath + "characters/" + characterName + "/" + emotionName + ".png";
+    }
+    return source;
+}
+
+Symbol ResourceManager::PrefixedKey(KeyTable table, const AssetFolder& type, Symbol name) {
+    Symbol& key = prefixedKeys[(int)table][name];
+    if (key == NO_SYMBOL) {
+        key = Intern(type.keyPrefix + SymbolName(name));
+    }
+    return key;
+}
+
+std::vector<std::string> ResourceManager::LooseCandidates(const AssetFolder& type,
+                                                          const std::string& name) const {
+    std::vector<std::string> candidates;
+    for (const char* extension : type.extensions) {
+        if (extension != nullptr) {
+            candidates.push_back(resourcePath + type.folder + "/" + name + extension);
+        }
+    }
+    return candidates;
+}
+
+SpriteFrame ResourceManager::GetCharacterFrame(Symbol character, Symbol emotion, Texture2D texture) {
+    SpriteFrame sprite;
+    sprite.texture = texture;
+    
+    const SpriteSource& source = ResolveSprite(character, emotion);
+    if (source.inAtlas) {
+        sprite.source = source.frame.source;
+        sprite.offset = source.frame.offset;
+        sprite.size = source.frame.size;
+    } else {
+        sprite.source = (Rectangle){ 0, 0, (float)texture.width, (float)texture.height };
+        sprite.offset = (Vector2){ 0, 0 };
+        sprite.size = (Vector2){ (float)texture.width, (float)texture.height };
+    }
+    return sprite;
+}
+
+bool ResourceManager::OpenPack(const std::string& packPath) {
+    // Solo antes de cargar nada: los workers y los streams leen del mapeo
+    return pack.Open(packPath);
+}
+
+bool ResourceManager::FindPackedAsset(const std::string& packKey, PackEntry& out) const {
+    return pack.Find(packKey, out);
+}
+
+bool ResourceManager::AllowLooseFiles() const {
+#ifdef NDEBUG
+    // En release, con pack, lo que no está en el pack no existe (sin sondear el disco)
+    return !pack.IsOpen();
+#else
+    return true;
+#endif
 }
 
 void ResourceManager::SetLanguage(const std::string& lang) {
     currentLanguage = lang;
 }
 
-Texture2D ResourceManager::LoadCharacterSprite(const std::string& character, 
-                                               const std::string& emotion) {
-    std::string key = character + "_" + emotion;
+AssetHandle ResourceManager::TakePending(Symbol key) {
+    AssetHandle* pending = pendingRequests.Find(key);
+    if (pending == nullptr) {
+        return nullptr;
+    }
     
+    // Si el worker aún no terminó, la carga síncrona se queda con la petición
+    AssetHandle request = *pending;
+    pendingRequests.Erase(key);
+    AssetState expected = AssetState::PENDING;
+    request->state.compare_exchange_strong(expected, AssetState::CANCELLED);
+    return request;
+}
+
+Texture2D ResourceManager::LoadTextureAsset(Symbol key, const std::string& packKey,
+                                            const std::string& path, const char* label) {
+    PROFILE_SCOPE("ResourceManager::LoadTextureAsset");
     // Verificar si ya está cargado
-    if (textures.find(key) != textures.end()) {
-        return textures[key];
+    if (const Texture2D* loaded = textures.Find(key)) {
+        TouchResource(CacheClass::TEXTURE, key);
+        return *loaded;
     }
+    caches[(int)CacheClass::TEXTURE].stats.misses++;
     
-    // Cargar sprite
-    std::string path = resourcePath + "characters/" + character + "/" + emotion + ".png";
+    // Si ya hay una versión decodificada en cola, basta con subirla
+    AssetHandle pending = TakePending(key);
+    if (pending && pending->state.load() == AssetState::DECODED && CompleteRequest(pending)) {
+        return pending->texture;
+    }
+    
+    Texture2D tex = { 0 };
+    PackEntry entry;
+    if (pack.Find(packKey, entry)) {
+        // Decodificar directamente desde las páginas mapeadas
+        Image image = { 0 };
+        {
+            PROFILE_SCOPE("Decode");
+            image = LoadImageFromMemory(entry.fileType, entry.data, (int)entry.size);
+        }
+        {
+            PROFILE_SCOPE("Upload");
+            tex = LoadTextureFromImage(image);
+        }
+        UnloadImage(image);
+    } else if (AllowLooseFiles() && FileExists(path.c_str())) {
+        PROFILE_SCOPE("Disk + Decode + Upload");
+        tex = ::LoadTexture(path.c_str());
+    }
     
-    if (FileExists(path.c_str())) {
-        Texture2D tex = LoadTexture(path.c_str());
+    if (tex.id > 0) {
         textures[key] = tex;
-        return tex;
+        TrackResource(CacheClass::TEXTURE, key, EstimateTextureSize(tex));
     } else {
-        std::cerr << "Warning: Character sprite not found: " << path << std::endl;
-        // Retornar textura vacía
-        Texture2D empty = { 0 };
-        return empty;
+        std::cerr << "Warning: " << label << " not found: " << path << std::endl;
     }
+    
+    if (pending) {
+        pending->texture = tex;
+        pending->state = (tex.id > 0) ? AssetState::READY : AssetState::FAILED;
+    }
+    return tex;
+}
+
+Texture2D ResourceManager::LoadCharacterSprite(Symbol character, Symbol emotion) {
+    PROFILE_SCOPE("ResourceManager::LoadCharacterSprite");
+    // Con atlas se carga la página entera (todas las emociones que contiene)
+    const SpriteSource& source = ResolveSprite(character, emotion);
+    if (const Texture2D* loaded = textures.Find(source.textureKey)) {
+        TouchResource(CacheClass::TEXTURE, source.textureKey);
+        return *loaded;
+    }
+    return LoadTextureAsset(source.textureKey, source.packKey, source.path,
+                            source.inAtlas ? "Atlas page" : "Character sprite");
+}
+
+Texture2D ResourceManager::LoadBackground(Symbol bgName) {
+    PROFILE_SCOPE("ResourceManager::LoadBackground");
+    Symbol key = BackgroundKey(bgName);
+    if (const Texture2D* loaded = textures.Find(key)) {
+        TouchResource(CacheClass::TEXTURE, key);
+        return *loaded;
+    }
+    return LoadTextureAsset(key, SymbolName(key),
+                            LooseCandidates(BACKGROUND_ASSETS, SymbolName(bgName))[0],
+                            "Background");
+}
+
+Texture2D ResourceManager::LoadCG(Symbol cgName) {
+    PROFILE_SCOPE("ResourceManager::LoadCG");
+    Symbol key = CGKey(cgName);
+    if (const Texture2D* loaded = textures.Find(key)) {
+        TouchResource(CacheClass::TEXTURE, key);
+        return *loaded;
+    }
+    return LoadTextureAsset(key, SymbolName(key),
+                            LooseCandidates(CG_ASSETS, SymbolName(cgName))[0],
+                            "CG");
 }
 
-Texture2D ResourceManager::LoadBackground(const std::string& bgName) {
-    std::string key = "bg_" + bgName;
+Texture2D ResourceManager::LoadGUI(Symbol guiName) {
+    PROFILE_SCOPE("ResourceManager::LoadGUI");
+    Symbol key = GUIKey(guiName);
+    if (const Texture2D* loaded = textures.Find(key)) {
+        TouchResource(CacheClass::TEXTURE, key);
+        return *loaded;
+    }
+    return LoadTextureAsset(key, SymbolName(key),
+                            LooseCandidates(GUI_ASSETS, SymbolName(guiName))[0],
+                            "GUI texture");
+}
+
+Music ResourceManager::LoadMusic(Symbol musicName) {
+    PROFILE_SCOPE("ResourceManager::LoadMusic");
+    Symbol key = MusicKey(musicName);
     
-    if (textures.find(key) != textures.end()) {
-        return textures[key];
+    if (const Music* loaded = musicTracks.Find(key)) {
+        TouchResource(CacheClass::MUSIC, key);
+        return *loaded;
     }
+    caches[(int)CacheClass::MUSIC].stats.misses++;
     
-    std::string path = resourcePath + "backgrounds/" + bgName + ".png";
+    AssetHandle pending = TakePending(key);
+    if (pending && pending->state.load() == AssetState::DECODED && CompleteRequest(pending)) {
+        return pending->music;
+    }
     
-    if (FileExists(path.c_str())) {
-        Texture2D tex = LoadTexture(path.c_str());
-        textures[key] = tex;
-        return tex;
+    Music music = { 0 };
+    PackEntry entry;
+    if (pack.Find(SymbolName(key), entry)) {
+        // El stream lee del mapeo mientras suena: sin copia
+        music = LoadMusicStreamFromMemory(entry.fileType, entry.data, (int)entry.size);
+    } else if (AllowLooseFiles()) {
+        // .ogg y después .mp3
+        for (const std::string& path : LooseCandidates(MUSIC_ASSETS, SymbolName(musicName))) {
+            if (FileExists(path.c_str())) {
+                music = LoadMusicStream(path.c_str());
+                break;
+            }
+        }
+    }
+    
+    if (music.ctxType != 0) {
+        musicTracks[key] = music;
+        TrackResource(CacheClass::MUSIC, key, EstimateMusicSize(music));
     } else {
-        std::cerr << "Warning: Background not found: " << path << std::endl;
-        Texture2D empty = { 0 };
-        return empty;
+        std::cerr << "Warning: Music not found: " << SymbolName(musicName) << std::endl;
+    }
+    
+    if (pending) {
+        pending->music = music;
+        pending->state = (music.ctxType != 0) ? AssetState::READY : AssetState::FAILED;
     }
+    return music;
 }
 
-Texture2D ResourceManager::LoadCG(const std::string& cgName) {
-    std::string key = "cg_" + cgName;
+Sound ResourceManager::LoadSound(Symbol soundName) {
+    PROFILE_SCOPE("ResourceManager::LoadSound");
+    Symbol key = SoundKey(soundName);
     
-    if (textures.find(key) != textures.end()) {
-        return textures[key];
+    if (const Sound* loaded = sounds.Find(key)) {
+        TouchResource(CacheClass::SOUND, key);
+        return *loaded;
     }
+    caches[(int)CacheClass::SOUND].stats.misses++;
     
-    std::string path = resourcePath + "cgs/" + cgName + ".png";
+    AssetHandle pending = TakePending(key);
+    if (pending && pending->state.load() == AssetState::DECODED && CompleteRequest(pending)) {
+        return pending->sound;
+    }
     
-    if (FileExists(path.c_str())) {
-        Texture2D tex = LoadTexture(path.c_str());
-        textures[key] = tex;
-        return tex;
+    Sound snd = { 0 };
+    PackEntry entry;
+    if (pack.Find(SymbolName(key), entry)) {
+        Wave wave = LoadWaveFromMemory(entry.fileType, entry.data, (int)entry.size);
+        snd = LoadSoundFromWave(wave);
+        UnloadWave(wave);
+    } else if (AllowLooseFiles()) {
+        // .wav y después .ogg
+        for (const std::string& path : LooseCandidates(SOUND_ASSETS, SymbolName(soundName))) {
+            if (FileExists(path.c_str())) {
+                snd = ::LoadSound(path.c_str());
+                break;
+            }
+        }
+    }
+    
+    if (snd.frameCount > 0) {
+        sounds[key] = snd;
+        TrackResource(CacheClass::SOUND, key, EstimateSoundSize(snd));
     } else {
-        std::cerr << "Warning: CG not found: " << path << std::endl;
-        Texture2D empty = { 0 };
-        return empty;
+        std::cerr << "Warning: Sound not found: " << SymbolName(soundName) << std::endl;
     }
+    
+    if (pending) {
+        pending->sound = snd;
+        pending->state = (snd.frameCount > 0) ? AssetState::READY : AssetState::FAILED;
+    }
+    return snd;
 }
 
-Music ResourceManager::LoadMusic(const std::string& musicName) {
-    std::string key = "music_" + musicName;
+AssetHandle ResourceManager::FindRequest(Symbol key, AssetKind kind) {
+    if (const AssetHandle* pending = pendingRequests.Find(key)) {
+        (*pending)->interested++;
+        return *pending;
+    }
     
-    if (musicTracks.find(key) != musicTracks.end()) {
-        return musicTracks[key];
+    CacheClass cls = CacheClass::TEXTURE;
+    bool loaded = false;
+    switch (kind) {
+        case AssetKind::TEXTURE:
+            loaded = textures.Contains(key);
+            break;
+        case AssetKind::SOUND:
+            cls = CacheClass::SOUND;
+            loaded = sounds.Contains(key);
+            break;
+        case AssetKind::MUSIC:
+            cls = CacheClass::MUSIC;
+            loaded = musicTracks.Contains(key);
+            break;
+    }
+    if (!loaded) {
+        caches[(int)cls].stats.misses++;
+        return nullptr;
     }
     
-    std::string path = resourcePath + "music/" + musicName + ".ogg";
-    // Intentar también .mp3
-    if (!FileExists(path.c_str())) {
-        path = resourcePath + "music/" + musicName + ".mp3";
+    // Ya en caché: el handle nace listo y se reutiliza mientras siga cargado
+    TouchResource(cls, key);
+    LruEntry* entry = caches[(int)cls].entries.Find(key);
+    if (entry != nullptr && entry->ready) {
+        return entry->ready;
     }
     
-    if (FileExists(path.c_str())) {
-        Music music = LoadMusicStream(path.c_str());
-        musicTracks[key] = music;
-        return music;
-    } else {
-        std::cerr << "Warning: Music not found: " << musicName << std::endl;
-        Music empty = { 0 };
-        return empty;
+    AssetHandle request = std::make_shared<AssetRequest>(key, kind);
+    switch (kind) {
+        case AssetKind::TEXTURE:
+            request->texture = *textures.Find(key);
+            break;
+        case AssetKind::SOUND:
+            request->sound = *sounds.Find(key);
+            break;
+        case AssetKind::MUSIC:
+            request->music = *musicTracks.Find(key);
+            break;
+    }
+    request->state = AssetState::READY;
+    if (entry != nullptr) {
+        entry->ready = request;
     }
+    return request;
 }
 
-Sound ResourceManager::LoadSound(const std::string& soundName) {
-    std::string key = "sfx_" + soundName;
+AssetHandle ResourceManager::StartRequest(Symbol key, AssetKind kind, const std::string& packKey,
+                                          const std::vector<std::string>& candidates) {
+    AssetHandle request = std::make_shared<AssetRequest>(key, kind);
     
-    if (sounds.find(key) != sounds.end()) {
-        return sounds[key];
+    PackEntry entry;
+    if (pack.Find(packKey, entry)) {
+        request->packData = entry.data;
+        request->packSize = entry.size;
+        request->fileType = entry.fileType;
+    } else if (AllowLooseFiles()) {
+        request->candidates = candidates;
     }
     
-    std::string path = resourcePath + "sfx/" + soundName + ".wav";
-    // Intentar también .ogg
-    if (!FileExists(path.c_str())) {
-        path = resourcePath + "sfx/" + soundName + ".ogg";
+    if (!loader.IsRunning()) {
+        // Sin workers (Initialize no llamado): decodificar y subir aquí mismo
+        AsyncLoader::Decode(*request);
+        if (request->state.load() == AssetState::DECODED) {
+            CompleteRequest(request);
+        }
+        return request;
     }
     
-    if (FileExists(path.c_str())) {
-        Sound snd = LoadSound(path.c_str());
-        sounds[key] = snd;
-        return snd;
-    } else {
-        std::cerr << "Warning: Sound not found: " << soundName << std::endl;
-        Sound empty = { 0 };
-        return empty;
+    request->interested = 1;
+    pendingRequests[key] = request;
+    loader.Submit(request);
+    return request;
+}
+
+AssetHandle ResourceManager::RequestCharacterSprite(Symbol character, Symbol emotion) {
+    const SpriteSource& source = ResolveSprite(character, emotion);
+    if (AssetHandle found = FindRequest(source.textureKey, AssetKind::TEXTURE)) {
+        return found;
     }
+    return StartRequest(source.textureKey, AssetKind::TEXTURE, source.packKey, { source.path });
 }
 
-Font ResourceManager::LoadFont(const std::string& fontName) {
-    if (fonts.find(fontName) != fonts.end()) {
-        return fonts[fontName];
+AssetHandle ResourceManager::RequestBackground(Symbol bgName) {
+    Symbol key = BackgroundKey(bgName);
+    if (AssetHandle found = FindRequest(key, AssetKind::TEXTURE)) {
+        return found;
+    }
+    return StartRequest(key, AssetKind::TEXTURE, SymbolName(key),
+                        LooseCandidates(BACKGROUND_ASSETS, SymbolName(bgName)));
+}
+
+AssetHandle ResourceManager::RequestCG(Symbol cgName) {
+    Symbol key = CGKey(cgName);
+    if (AssetHandle found = FindRequest(key, AssetKind::TEXTURE)) {
+        return found;
+    }
+    return StartRequest(key, AssetKind::TEXTURE, SymbolName(key),
+                        LooseCandidates(CG_ASSETS, SymbolName(cgName)));
+}
+
+AssetHandle ResourceManager::RequestMusic(Symbol musicName) {
+    Symbol key = MusicKey(musicName);
+    if (AssetHandle found = FindRequest(key, AssetKind::MUSIC)) {
+        return found;
+    }
+    return StartRequest(key, AssetKind::MUSIC, SymbolName(key),
+                        LooseCandidates(MUSIC_ASSETS, SymbolName(musicName)));
+}
+
+AssetHandle ResourceManager::RequestSound(Symbol soundName) {
+    Symbol key = SoundKey(soundName);
+    if (AssetHandle found = FindRequest(key, AssetKind::SOUND)) {
+        return found;
+    }
+    return StartRequest(key, AssetKind::SOUND, SymbolName(key),
+                        LooseCandidates(SOUND_ASSETS, SymbolName(soundName)));
+}
+
+void ResourceManager::CancelRequest(const AssetHandle& request) {
+    const AssetHandle* pending = pendingRequests.Find(request->key);
+    if (pending == nullptr || *pending != request) {
+        return;
+    }
+    
+    // Otro la sigue esperando (p. ej. el SceneManager con ese fondo): la carga sigue
+    if (--request->interested > 0) {
+        return;
+    }
+    
+    AssetState expected = AssetState::PENDING;
+    if (!request->state.compare_exchange_strong(expected, AssetState::CANCELLED)) {
+        expected = AssetState::DECODED;
+        request->state.compare_exchange_strong(expected, AssetState::CANCELLED);
+    }
+    pendingRequests.Erase(request->key);
+}
+
+void ResourceManager::RunInBackground(std::function<void()> job) {
+    if (!loader.IsRunning()) {
+        job();
+        return;
+    }
+    loader.SubmitJob(std::move(job));
+}
+
+bool ResourceManager::CompleteRequest(const AssetHandle& request) {
+    // Solo en el hilo principal: aquí se crean los recursos de GPU/audio
+    PROFILE_SCOPE("Upload");
+    bool ok = false;
+    
+    switch (request->kind) {
+        case AssetKind::TEXTURE: {
+            if (const Texture2D* loaded = textures.Find(request->key)) {
+                request->texture = *loaded;
+            } else {
+                request->texture = LoadTextureFromImage(request->image);
+                if (request->texture.id > 0) {
+                    textures[request->key] = request->texture;
+                    TrackResource(CacheClass::TEXTURE, request->key, EstimateTextureSize(request->texture));
+                }
+            }
+            ok = request->texture.id > 0;
+            break;
+        }
+        case AssetKind::SOUND: {
+            if (const Sound* loaded = sounds.Find(request->key)) {
+                request->sound = *loaded;
+            } else {
+                request->sound = LoadSoundFromWave(request->wave);
+                if (request->sound.frameCount > 0) {
+                    sounds[request->key] = request->sound;
+                    TrackResource(CacheClass::SOUND, request->key, EstimateSoundSize(request->sound));
+                }
+            }
+            ok = request->sound.frameCount > 0;
+            break;
+        }
+        case AssetKind::MUSIC: {
+            if (const Music* loaded = musicTracks.Find(request->key)) {
+                request->music = *loaded;
+            } else {
+                request->music = (request->packData != nullptr)
+                    ? LoadMusicStreamFromMemory(request->fileType.c_str(), request->packData,
+                                                (int)request->packSize)
+                    : LoadMusicStream(request->path.c_str());
+                if (request->music.ctxType != 0) {
+                    musicTracks[request->key] = request->music;
+                    TrackResource(CacheClass::MUSIC, request->key, EstimateMusicSize(request->music));
+                }
+            }
+            ok = request->music.ctxType != 0;
+            break;
+        }
+    }
+    
+    AsyncLoader::ReleaseDecoded(*request);
+    request->state = ok ? AssetState::READY : AssetState::FAILED;
+    return ok;
+}
+
+void ResourceManager::ProcessUploads() {
+    PROFILE_SCOPE("ResourceManager::ProcessUploads");
+    // Siempre se permite al menos una subida por frame
+    size_t uploadedBytes = 0;
+    AssetHandle request;
+    
+    while (uploadedBytes < uploadBudgetBytes && loader.PopDecoded(request)) {
+        AssetState state = request->state.load();
+        
+        if (state == AssetState::DECODED) {
+            uploadedBytes += request->sizeBytes;
+            CompleteRequest(request);
+        } else if (state == AssetState::FAILED) {
+            std::cerr << "Warning: Asset not found: " << SymbolName(request->key) << std::endl;
+        } else if (state == AssetState::CANCELLED) {
+            AsyncLoader::ReleaseDecoded(*request);
+        }
+        
+        const AssetHandle* pending = pendingRequests.Find(request->key);
+        if (pending != nullptr && *pending == request) {
+            pendingRequests.Erase(request->key);
+        }
+    }
+}
+
+GlyphCache* ResourceManager::LoadGlyphCache(const std::string& fontName) {
+    PROFILE_SCOPE("ResourceManager::LoadGlyphCache");
+    auto it = fonts.find(fontName);
+    if (it != fonts.end()) {
+        return it->second.get();
     }
     
     std::string path = resourcePath + "fonts/" + fontName;
+    auto cache = std::make_unique<GlyphCache>();
     
-    if (FileExists(path.c_str())) {
-        Font font = LoadFontEx(path.c_str(), 32, 0, 0);
-        fonts[fontName] = font;
-        return font;
-    } else {
+    PackEntry entry;
+    if (pack.Find("font/" + fontName, entry)) {
+        // El TTF se rasteriza directamente desde las páginas mapeadas
+        cache->LoadFromMemory(entry.data, (int)entry.size);
+    } else if (AllowLooseFiles() && FileExists(path.c_str())) {
+        cache->LoadFromFile(path);
+    }
+    
+    if (!cache->IsLoaded()) {
         std::cerr << "Warning: Font not found: " << path << std::endl;
-        return GetFontDefault();
     }
+    
+    // Se guarda aunque falle: GetFont devuelve la fuente por defecto
+    GlyphCache* result = cache.get();
+    fonts[fontName] = std::move(cache);
+    return result;
 }
 
-Texture2D ResourceManager::GetTexture(const std::string& key) {
-    if (textures.find(key) != textures.end()) {
-        return textures[key];
+Font ResourceManager::LoadFont(const std::string& fontName) {
+    PROFILE_SCOPE("ResourceManager::LoadFont");
+    return LoadGlyphCache(fontName)->GetFont(32);
+}
+
+Texture2D ResourceManager::GetTexture(Symbol key) {
+    if (const Texture2D* loaded = textures.Find(key)) {
+        return *loaded;
     }
     Texture2D empty = { 0 };
     return empty;
 }
 
-Music ResourceManager::GetMusic(const std::string& key) {
-    if (musicTracks.find(key) != musicTracks.end()) {
-        return musicTracks[key];
+Music ResourceManager::GetMusic(Symbol key) {
+    if (const Music* loaded = musicTracks.Find(key)) {
+        return *loaded;
     }
     Music empty = { 0 };
     return empty;
 }
 
-Sound ResourceManager::GetSound(const std::string& key) {
-    if (sounds.find(key) != sounds.end()) {
-        return sounds[key];
+Sound ResourceManager::GetSound(Symbol key) {
+    if (const Sound* loaded = sounds.Find(key)) {
+        return *loaded;
     }
     Sound empty = { 0 };
     return empty;
 }
 
 Font ResourceManager::GetFont(const std::string& key) {
-    if (fonts.find(key) != fonts.end()) {
-        return fonts[key];
+    auto it = fonts.find(key);
+    if (it != fonts.end()) {
+        return it->second->GetFont(32);
     }
     return GetFontDefault();
 }
 
-void ResourceManager::UnloadTexture(const std::string& key) {
-    if (textures.find(key) != textures.end()) {
-        UnloadTexture(textures[key]);
-        textures.erase(key);
+void ResourceManager::UnloadTexture(Symbol key) {
+    if (const Texture2D* loaded = textures.Find(key)) {
+        ::UnloadTexture(*loaded);
+        textures.Erase(key);
+        ForgetResource(CacheClass::TEXTURE, key);
     }
 }
 
-void ResourceManager::UnloadMusic(const std::string& key) {
-    if (musicTracks.find(key) != musicTracks.end()) {
-        UnloadMusicStream(musicTracks[key]);
-        musicTracks.erase(key);
+void ResourceManager::UnloadMusic(Symbol key) {
+    if (const Music* loaded = musicTracks.Find(key)) {
+        UnloadMusicStream(*loaded);
+        musicTracks.Erase(key);
+        ForgetResource(CacheClass::MUSIC, key);
     }
 }
 
-void ResourceManager::UnloadSound(const std::string& key) {
-    if (sounds.find(key) != sounds.end()) {
-        UnloadSound(sounds[key]);
-        sounds.erase(key);
+void ResourceManager::UnloadSound(Symbol key) {
+    if (const Sound* loaded = sounds.Find(key)) {
+        ::UnloadSound(*loaded);
+        sounds.Erase(key);
+        ForgetResource(CacheClass::SOUND, key);
     }
 }
 
 void ResourceManager::UnloadAll() {
+    // Cancelar cargas en curso (los datos se liberan al salir de la cola)
+    for (auto& pair : pendingRequests) {
+        AssetState expected = AssetState::PENDING;
+        if (!pair.second->state.compare_exchange_strong(expected, AssetState::CANCELLED)) {
+            expected = AssetState::DECODED;
+            pair.second->state.compare_exchange_strong(expected, AssetState::CANCELLED);
+        }
+    }
+    pendingRequests.Clear();
+    
     // Unload textures
     for (auto& pair : textures) {
-        UnloadTexture(pair.second);
+        ::UnloadTexture(pair.second);
     }
-    textures.clear();
+    textures.Clear();
     
     // Unload music
     for (auto& pair : musicTracks) {
         UnloadMusicStream(pair.second);
     }
-    musicTracks.clear();
+    musicTracks.Clear();
     
     // Unload sounds
     for (auto& pair : sounds) {
-        UnloadSound(pair.second);
+        ::UnloadSound(pair.second);
     }
-    sounds.clear();
+    sounds.Clear();
     
     // Unload fonts
-    for (auto& pair : fonts) {
-        if (pair.second.texture.id != GetFontDefault().texture.id) {
-            UnloadFont(pair.second);
+    fonts.clear();
+    
+    // Vaciar el LRU conservando los contadores
+    for (auto& cache : caches) {
+        cache.order.clear();
+        cache.entries.Clear();
+        cache.stats.bytesUsed = 0;
+        cache.stats.entries = 0;
+    }
+    evictionEpoch++;
+}
+
+void ResourceManager::SetCacheBudget(CacheClass cls, size_t bytes) {
+    caches[(int)cls].stats.budgetBytes = bytes;
+    EnforceBudget(cls);
+}
+
+void ResourceManager::SetPinnedKeys(PinGroup group, const std::vector<Symbol>& keys) {
+    uint8_t bit = (uint8_t)(1 << (int)group);
+    std::vector<Symbol>& pins = pinnedKeys[(int)group];
+    for (Symbol key : pins) {
+        pinMasks[key] &= (uint8_t)~bit;
+    }
+    
+    pins = keys;
+    for (Symbol key : pins) {
+        if (key >= pinMasks.size()) {
+            pinMasks.resize(key + 1, 0);
         }
+        pinMasks[key] |= bit;
     }
-    fonts.clear();
+}
+
+void ResourceManager::TrackResource(CacheClass cls, Symbol key, size_t bytes) {
+    LruCache& cache = caches[(int)cls];
+    ForgetResource(cls, key);
+    
+    cache.order.push_front(key);
+    cache.entries[key] = { bytes, cache.order.begin() };
+    cache.stats.bytesUsed += bytes;
+    cache.stats.entries = cache.entries.Size();
+    
+    EnforceBudget(cls);
+}
+
+void ResourceManager::TouchResource(CacheClass cls, Symbol key) {
+    LruCache& cache = caches[(int)cls];
+    cache.stats.hits++;
+    
+    if (LruEntry* entry = cache.entries.Find(key)) {
+        cache.order.splice(cache.order.begin(), cache.order, entry->position);
+    }
+}
+
+void ResourceManager::ForgetResource(CacheClass cls, Symbol key) {
+    LruCache& cache = caches[(int)cls];
+    if (LruEntry* entry = cache.entries.Find(key)) {
+        cache.stats.bytesUsed -= entry->bytes;
+        cache.order.erase(entry->position);
+        cache.entries.Erase(key);
+        cache.stats.entries = cache.entries.Size();
+    }
+}
+
+void ResourceManager::EnforceBudget(CacheClass cls) {
+    LruCache& cache = caches[(int)cls];
+    
+    // Recorrer desde el menos usado; lo fijado en pantalla o en la ventana
+    // de prefetch se salta aunque se supere el presupuesto, y el recurso más
+    // reciente (el que se acaba de cargar) nunca se expulsa
+    auto it = cache.order.end();
+    while (cache.stats.bytesUsed > cache.stats.budgetBytes && it != cache.order.begin()) {
+        --it;
+        if (it == cache.order.begin()) {
+            break;
+        }
+        if (IsPinned(*it)) {
+            continue;
+        }
+        
+        Symbol key = *it;
+        it = std::next(it);
+        switch (cls) {
+            case CacheClass::TEXTURE:
+                ::UnloadTexture(textures[key]);
+                textures.Erase(key);
+                break;
+            case CacheClass::SOUND:
+                ::UnloadSound(sounds[key]);
+                sounds.Erase(key);
+                break;
+            case CacheClass::MUSIC:
+                UnloadMusicStream(musicTracks[key]);
+                musicTracks.Erase(key);
+                break;
+            default:
+                break;
+        }
+        ForgetResource(cls, key);
+        cache.stats.evictions++;
+        evictionEpoch++;
+    }
+}
+
+size_t ResourceManager::EstimateTextureSize(Texture2D texture) {
+    size_t bytes = GetPixelDataSize(texture.width, texture.height, texture.format);
+    // La cadena de mipmaps añade ~1/3
+    if (texture.mipmaps > 1) {
+        bytes += bytes / 3;
+    }
+    return bytes;
+}
+
+size_t ResourceManager::EstimateSoundSize(Sound sound) {
+    // PCM ya convertido al formato del dispositivo
+    return (size_t)sound.frameCount * sound.stream.channels * sound.stream.sampleSize / 8;
+}
+
+size_t ResourceManager::EstimateMusicSize(Music music) {
+    // Solo se mantienen en memoria los dos sub-buffers del stream
+    return (size_t)MusicPlayer::BUFFER_FRAMES * 2 * music.stream.channels *
+           music.stream.sampleSize / 8;
 }
 
 std::string ResourceManager::GetDialoguePath(const std::string& fileName) {
     return resourcePath + "dialogues/" + currentLanguage + "/" + fileName;
+}
+
+std::string ResourceManager::GetDialoguePackKey(const std::string& fileName) const {
+    return "dialogue/" + currentLanguage + "/" + fileName;
+}
+
+std::string ResourceManager::GetVoicePackKey(const std::string& fileName, size_t line) const {
+    std::string chapter = fileName.substr(0, fileName.find_last_of('.'));
+    return VOICE_ASSETS.keyPrefix + currentLanguage + "/" + chapter + "/" + std::to_string(line + 1);
+}
+
+std::vector<std::string> ResourceManager::GetVoiceCandidates(const std::string& fileName, size_t line) const {
+    if (!AllowLooseFiles()) {
+        return {};
+    }
+    std::string chapter = fileName.substr(0, fileName.find_last_of('.'));
+    return LooseCandidates(VOICE_ASSETS, currentLanguage + "/" + chapter + "/" + std::to_string(line + 1));
+}
+
+bool ResourceManager::HasLooseVoices(const std::string& fileName) const {
+    if (!AllowLooseFiles()) {
+        return false;
+    }
+    std::string chapter = fileName.substr(0, fileName.find_last_of('.'));
+    std::string folder = resourcePath + VOICE_ASSETS.folder + "/" + currentLanguage + "/" + chapter;
+    return DirectoryExists(folder.c_str());
 }
\ No newline at end of file
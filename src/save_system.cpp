@@ -0,0 +1,328 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "profiler.h"
+#include "save_system.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <ctime>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char SAVE_MAGIC[4] = { 'N', 'X', 'S', 'V' };
+
+template <typename T>
+void WriteValue(std::vector<unsigned char>& out, const T& value) {
+    const unsigned char* bytes = (const unsigned char*)&value;
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void WriteString(std::vector<unsigned char>& out, const std::string& str) {
+    WriteValue(out, (uint16_t)str.size());
+    out.insert(out.end(), str.begin(), str.end());
+}
+
+// Lector con límites: un archivo truncado falla en vez de leer de más
+struct ByteReader {
+    const unsigned char* data;
+    size_t size;
+    size_t offset;
+
+    template <typename T>
+    bool Read(T& value) {
+        if (offset + sizeof(T) > size) return false;
+        memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(std::string& str) {
+        uint16_t length = 0;
+        if (!Read(length) || offset + length > size) return false;
+        str.assign((const char*)data + offset, length);
+        offset += length;
+        return true;
+    }
+};
+
+} // namespace
+
+SaveSystem::SaveSystem(const std::string& directory)
+    : saveDirectory(directory), thumbnailTarget{ 0 }, stopping(false),
+      completedSaves(0), failedSaves(0), pendingSaves(0) {
+    if (!saveDirectory.empty() && saveDirectory.back() != '/') {
+        saveDirectory += '/';
+    }
+    worker = std::thread(&SaveSystem::WorkerLoop, this);
+}
+
+SaveSystem::~SaveSystem() {
+    Shutdown();
+}
+
+void SaveSystem::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        stopping = true;
+    }
+    jobsCondition.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+
+    // Necesita el contexto de GL: llamar antes de cerrar la ventana
+    if (thumbnailTarget.id != 0) {
+        UnloadRenderTexture(thumbnailTarget);
+        thumbnailTarget = (RenderTexture2D){ 0 };
+    }
+}
+
+std::string SaveSystem::GetSlotPath(int slot) const {
+    if (slot == QUICK_SLOT) {
+        return saveDirectory + "quick.nxs";
+    }
+    return saveDirectory + "slot_" + std::to_string(slot) + ".nxs";
+}
+
+bool SaveSystem::SlotExists(int slot) const {
+    std::error_code ec;
+    return fs::is_regular_file(GetSlotPath(slot), ec);
+}
+
+Image SaveSystem::CaptureThumbnail(SceneManager& scene) {
+    if (thumbnailTarget.id == 0) {
+        thumbnailTarget = LoadRenderTexture(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT);
+        if (thumbnailTarget.id == 0) {
+            return (Image){ 0 };
+        }
+    }
+
+    BeginTextureMode(thumbnailTarget);
+    scene.RenderThumbnail(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT);
+    EndTextureMode();
+
+    // Única lectura de la GPU: 256x144 RGBA (~144 KB), no el framebuffer entero
+    return LoadImageFromTexture(thumbnailTarget.texture);
+}
+
+bool SaveSystem::Save(int slot, const std::string& chapterName, const DialogueSystem& dialogue,
+                      SceneManager& scene) {
+    PROFILE_SCOPE("SaveSystem::Save");
+    if (stopping || chapterName.empty()) {
+        return false;
+    }
+
+    SaveJob job;
+    job.path = GetSlotPath(slot);
+    job.data.language = ResourceManager::GetInstance()->GetLanguage();
+    job.data.chapter = chapterName;
+    job.data.chapterHash = dialogue.GetChapter().GetContentHash();
+    job.data.line = (uint32_t)dialogue.GetCurrentLineIndex();
+    job.data.timestamp = (int64_t)time(nullptr);
+    scene.CaptureState(job.data.scene);
+    job.thumbnail = CaptureThumbnail(scene);
+
+    pendingSaves++;
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        jobs.push_back(std::move(job));
+    }
+    jobsCondition.notify_one();
+    return true;
+}
+
+void SaveSystem::WorkerLoop() {
+    Profiler::GetInstance()->SetThreadName("SaveSystem");
+
+    while (true) {
+        SaveJob job;
+        {
+            std::unique_lock<std::mutex> lock(jobsMutex);
+            jobsCondition.wait(lock, [this] { return stopping || !jobs.empty(); });
+            // Al parar se terminan antes los guardados ya pedidos
+            if (jobs.empty()) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        if (WriteSave(job)) {
+            completedSaves++;
+        } else {
+            failedSaves++;
+        }
+        pendingSaves--;
+    }
+}
+
+bool SaveSystem::WriteSave(SaveJob& job) {
+    PROFILE_SCOPE("SaveSystem::WriteSave");
+
+    if (job.thumbnail.data != nullptr) {
+        // Los framebuffers se leen invertidos en Y
+        ImageFlipVertical(&job.thumbnail);
+        int pngSize = 0;
+        unsigned char* png = ExportImageToMemory(job.thumbnail, ".png", &pngSize);
+        if (png != nullptr) {
+            job.data.thumbnail.assign(png, png + pngSize);
+            MemFree(png);
+        }
+        UnloadImage(job.thumbnail);
+        job.thumbnail = (Image){ 0 };
+    }
+
+    std::vector<unsigned char> bytes;
+    if (!Serialize(job.data, bytes)) {
+        std::cerr << "Warning: Could not serialize save: " << job.path << std::endl;
+        return false;
+    }
+
+    std::error_code ec;
+    fs::path target(job.path);
+    if (target.has_parent_path()) {
+        fs::create_directories(target.parent_path(), ec);
+    }
+
+    // Se escribe aparte y se renombra: un cierre a medias no borra el slot anterior
+    std::string temp = job.path + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Warning: Could not write save: " << job.path << std::endl;
+            return false;
+        }
+        file.write((const char*)bytes.data(), bytes.size());
+        if (!file.good()) {
+            std::cerr << "Warning: Could not write save: " << job.path << std::endl;
+            return false;
+        }
+    }
+    fs::rename(temp, target, ec);
+    if (ec) {
+        std::cerr << "Warning: Could not replace save: " << job.path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool SaveSystem::Serialize(const SaveData& data, std::vector<unsigned char>& out) {
+    if (data.scene.characters.size() > 255) {
+        return false;
+    }
+
+    out.clear();
+    out.reserve(128 + data.thumbnail.size());
+    out.insert(out.end(), SAVE_MAGIC, SAVE_MAGIC + 4);
+    WriteValue(out, (uint16_t)VERSION);
+    WriteValue(out, data.line);
+    WriteValue(out, data.chapterHash);
+    WriteValue(out, data.timestamp);
+    WriteString(out, data.language);
+    WriteString(out, data.chapter);
+    WriteString(out, SymbolName(data.scene.background));
+    WriteString(out, SymbolName(data.scene.music));
+    WriteValue(out, data.scene.musicPosition);
+
+    WriteValue(out, (uint8_t)data.scene.characters.size());
+    for (const CharacterState& character : data.scene.characters) {
+        WriteString(out, SymbolName(character.name));
+        WriteString(out, SymbolName(character.emotion));
+        WriteValue(out, (uint8_t)character.position);
+        float alpha = (character.alpha < 0.0f) ? 0.0f : (character.alpha > 1.0f ? 1.0f : character.alpha);
+        WriteValue(out, (uint8_t)(alpha * 255.0f + 0.5f));
+    }
+
+    WriteValue(out, (uint32_t)data.thumbnail.size());
+    out.insert(out.end(), data.thumbnail.begin(), data.thumbnail.end());
+    return true;
+}
+
+bool SaveSystem::Deserialize(const unsigned char* bytes, size_t size, SaveData& out) {
+    ByteReader reader = { bytes, size, 0 };
+    uint16_t version = 0;
+    if (size < 4 || memcmp(bytes, SAVE_MAGIC, 4) != 0) {
+        return false;
+    }
+    reader.offset = 4;
+    if (!reader.Read(version) || version != VERSION) {
+        return false;
+    }
+
+    std::string background, music;
+    if (!reader.Read(out.line) || !reader.Read(out.chapterHash) || !reader.Read(out.timestamp) ||
+        !reader.ReadString(out.language) || !reader.ReadString(out.chapter) ||
+        !reader.ReadString(background) || !reader.ReadString(music) ||
+        !reader.Read(out.scene.musicPosition)) {
+        return false;
+    }
+    out.scene.background = Intern(background);
+    out.scene.music = Intern(music);
+
+    uint8_t characterCount = 0;
+    if (!reader.Read(characterCount)) {
+        return false;
+    }
+    out.scene.characters.clear();
+    for (uint8_t i = 0; i < characterCount; i++) {
+        std::string name, emotion;
+        uint8_t position = 0;
+        uint8_t alpha = 0;
+        if (!reader.ReadString(name) || !reader.ReadString(emotion) ||
+            !reader.Read(position) || !reader.Read(alpha) ||
+            position > (uint8_t)CharacterPosition::OFFSCREEN) {
+            return false;
+        }
+        out.scene.characters.push_back({ Intern(name), Intern(emotion),
+                                         (CharacterPosition)position, alpha / 255.0f });
+    }
+
+    uint32_t thumbnailSize = 0;
+    if (!reader.Read(thumbnailSize) || reader.offset + thumbnailSize > size) {
+        return false;
+    }
+    out.thumbnail.assign(bytes + reader.offset, bytes + reader.offset + thumbnailSize);
+    return true;
+}
+
+bool SaveSystem::Load(int slot, SaveData& out) const {
+    PROFILE_SCOPE("SaveSystem::Load");
+    std::string path = GetSlotPath(slot);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)),
+                                     std::istreambuf_iterator<char>());
+    if (!Deserialize(bytes.data(), bytes.size(), out)) {
+        std::cerr << "Warning: Invalid save: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+Texture2D SaveSystem::LoadThumbnail(const SaveData& data) {
+    if (data.thumbnail.empty()) {
+        return (Texture2D){ 0 };
+    }
+    Image image = LoadImageFromMemory(".png", data.thumbnail.data(), (int)data.thumbnail.size());
+    Texture2D texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    return texture;
+}
+
+void SaveSystem::Resume(const SaveData& data, DialogueSystem& dialogue, SceneManager& scene) {
+    if (dialogue.GetChapter().GetContentHash() != data.chapterHash) {
+        std::cerr << "Warning: " << data.chapter << " changed since it was saved, line "
+                  << data.line << " may differ" << std::endl;
+    }
+    // La escena guardada manda: BeginLine no la reconstruye desde el texto
+    scene.RestoreState(data.scene);
+    dialogue.ResumeAt(data.line, data.scene);
+}
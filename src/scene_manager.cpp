@@ -4,84 +4,174 @@
 #include "scene_manager.h"
 #include "dialogue_parser.h"
 #include "resource_manager.h"
+#include "profiler.h"
+#include "rlgl.h"
+#include <iostream>
 
 SceneManager::SceneManager()
-    : musicVolume(0.5f), transitionAlpha(0.0f), isTransitioning(false) {
+    : currentBgName(NO_SYMBOL), shownBgName(NO_SYMBOL), currentMusicName(NO_SYMBOL), musicVolume(0.5f), musicFade(1.5f),
+      musicTracksRevision(0), transitionAlpha(0.0f), isTransitioning(false), revision(1), cleanRevision(0),
+      textureBinds(0), lastTextureId(0), layerRevision(0), layerValid(false),
+      useSceneLayer(true), layerCompositions(0) {
     currentBackground.id = 0;
-    currentMusic.ctxType = 0;
+    musicPlayer.SetVolume(musicVolume);
+    sceneLayer = (RenderTexture2D){ 0 };
 }
 
 SceneManager::~SceneManager() {
-    if (currentMusic.ctxType != 0) {
-        StopMusicStream(currentMusic);
-    }
+    Shutdown();
+    UnloadSceneLayer();
+}
+
+void SceneManager::Shutdown() {
+    musicPlayer.Shutdown();
+    soundMixer.Shutdown();
 }
 
-void SceneManager::SetBackground(const std::string& bgName) {
+void SceneManager::SetBackground(Symbol bgName) {
     currentBgName = bgName;
-    currentBackground = ResourceManager::GetInstance()->LoadBackground(bgName);
+    // Se pide antes de retirar el anterior: si es el mismo, su carga sigue
+    ResourceManager* resources = ResourceManager::GetInstance();
+    AssetHandle previous = std::move(pendingBackground);
+    pendingBackground = resources->RequestBackground(bgName);
+    if (previous) {
+        resources->CancelRequest(previous);
+    }
+    if (pendingBackground->IsDone()) {
+        if (pendingBackground->IsReady()) {
+            currentBackground = pendingBackground->texture;
+            shownBgName = bgName;
+            revision++;
+        }
+        pendingBackground.reset();
+    }
+    PublishPins();
 }
 
 void SceneManager::ClearBackground() {
     currentBackground.id = 0;
-    currentBgName = "";
+    currentBgName = NO_SYMBOL;
+    shownBgName = NO_SYMBOL;
+    if (pendingBackground) {
+        ResourceManager::GetInstance()->CancelRequest(pendingBackground);
+        pendingBackground.reset();
+    }
+    revision++;
+    PublishPins();
 }
 
-void SceneManager::PlayMusic(const std::string& musicName, bool loop) {
-    // Detener música actual si existe
-    if (currentMusic.ctxType != 0 && currentMusicName != musicName) {
-        StopMusicStream(currentMusic);
-    }
-    
+void SceneManager::PlayMusic(Symbol musicName, bool loop) {
+    StartMusic(musicName, loop, 0.0f);
+}
+
+void SceneManager::StartMusic(Symbol musicName, bool loop, float start) {
+    // La pista anterior sale con un fundido cruzado; el hilo de la música la detiene al acabar
     currentMusicName = musicName;
-    currentMusic = ResourceManager::GetInstance()->LoadMusic(musicName);
-    
-    if (currentMusic.ctxType != 0) {
-        currentMusic.looping = loop;
-        SetMusicVolume(currentMusic, musicVolume);
-        PlayMusicStream(currentMusic);
-    }
+    Music music = ResourceManager::GetInstance()->LoadMusic(musicName);
+    musicPlayer.Play(music, musicName, loop, musicFade, start);
+    PublishPins();
 }
 
 void SceneManager::StopMusic() {
-    if (currentMusic.ctxType != 0) {
-        StopMusicStream(currentMusic);
+    musicPlayer.Stop(musicFade);
+    currentMusicName = NO_SYMBOL;
+    PublishPins();
+}
+
+float SceneManager::GetMusicPosition() const {
+    if (currentMusicName == NO_SYMBOL) {
+        return -1.0f;
     }
-    currentMusicName = "";
+    return musicPlayer.GetPosition();
 }
 
 void SceneManager::SetMusicVolume(float volume) {
     musicVolume = volume;
-    if (currentMusic.ctxType != 0) {
-        SetMusicVolume(currentMusic, musicVolume);
-    }
+    musicPlayer.SetVolume(musicVolume);
 }
 
-void SceneManager::PlaySound(const std::string& soundName) {
-    Sound sfx = ResourceManager::GetInstance()->LoadSound(soundName);
-    if (sfx.frameCount > 0) {
-        PlaySound(sfx);
-    }
+void SceneManager::PlaySound(Symbol soundName, float volume, float pan, int priority) {
+    soundMixer.Play(soundName, volume, pan, priority);
 }
 
-Character* SceneManager::GetCharacter(const std::string& name) {
-    if (characters.find(name) == characters.end()) {
-        characters[name] = std::make_shared<Character>(name);
+Character* SceneManager::GetCharacter(Symbol name) {
+    std::unique_ptr<Character>& character = characters[name];
+    if (!character) {
+        character = std::make_unique<Character>(name);
     }
-    return characters[name].get();
+    return character.get();
 }
 
-void SceneManager::ShowCharacter(const std::string& name, const std::string& emotion,
-                                CharacterPosition pos) {
+void SceneManager::ShowCharacter(Symbol name, Symbol emotion, CharacterPosition pos) {
     Character* character = GetCharacter(name);
     character->SetEmotion(emotion);
     character->SetPosition(pos);
     character->Show();
+    PublishPins();
+}
+
+void SceneManager::HideCharacter(Symbol name) {
+    if (std::unique_ptr<Character>* character = characters.Find(name)) {
+        (*character)->Hide();
+        PublishPins();
+    }
+}
+
+void SceneManager::RestoreState(const SceneState& state) {
+    PROFILE_SCOPE("SceneManager::RestoreState");
+    if (state.background != currentBgName) {
+        if (state.background == NO_SYMBOL) {
+            ClearBackground();
+        } else {
+            SetBackground(state.background);
+        }
+    }
+    
+    // Ocultar los que no están en el estado; el resto se actualiza en su sitio
+    for (auto& pair : characters) {
+        bool present = false;
+        for (const auto& entry : state.characters) {
+            if (entry.name == pair.first) {
+                present = true;
+                break;
+            }
+        }
+        if (!present) {
+            pair.second->Hide();
+        }
+    }
+    for (const auto& entry : state.characters) {
+        Character* character = GetCharacter(entry.name);
+        character->SetEmotion(entry.emotion);
+        character->SetPosition(entry.position);
+        if (character->GetAlpha() != entry.alpha) {
+            character->SetAlpha(entry.alpha);
+        }
+        character->Show();
+    }
+    
+    if (state.music != currentMusicName) {
+        if (state.music == NO_SYMBOL) {
+            StopMusic();
+        } else {
+            StartMusic(state.music, true, state.musicPosition);
+        }
+    }
+    
+    PublishPins();
 }
 
-void SceneManager::HideCharacter(const std::string& name) {
-    if (characters.find(name) != characters.end()) {
-        characters[name]->Hide();
+void SceneManager::CaptureState(SceneState& out) const {
+    out.background = currentBgName;
+    out.music = currentMusicName;
+    out.musicPosition = GetMusicPosition();
+    out.characters.clear();
+    for (const auto& pair : characters) {
+        const Character& character = *pair.second;
+        if (character.IsVisible()) {
+            out.characters.push_back({ pair.first, character.GetEmotionId(),
+                                       character.GetPosition(), character.GetAlpha() });
+        }
     }
 }
 
@@ -89,12 +179,36 @@ void SceneManager::ClearAllCharacters() {
     for (auto& pair : characters) {
         pair.second->Hide();
     }
+    PublishPins();
 }
 
 void SceneManager::Update(float deltaTime) {
-    // Actualizar música
-    if (currentMusic.ctxType != 0) {
-        UpdateMusicStream(currentMusic);
+    PROFILE_SCOPE("SceneManager::Update");
+    soundMixer.Update(deltaTime);
+    
+    // La pista que salía terminó su fundido: ya se puede expulsar
+    if (musicPlayer.GetTrackRevision() != musicTracksRevision) {
+        PublishPins();
+    }
+    
+    // Fondo pedido en segundo plano
+    if (pendingBackground && pendingBackground->IsDone()) {
+        if (pendingBackground->IsReady()) {
+            currentBackground = pendingBackground->texture;
+            shownBgName = currentBgName;
+            revision++;
+        }
+        pendingBackground.reset();
+        PublishPins();
+    }
+    
+    // Sprites pendientes de los personajes
+    bool spritesChanged = false;
+    for (auto& pair : characters) {
+        spritesChanged |= pair.second->Update();
+    }
+    if (spritesChanged) {
+        PublishPins();
     }
     
     // Actualizar transiciones
@@ -103,11 +217,17 @@ void SceneManager::Update(float deltaTime) {
         if (transitionAlpha >= 1.0f) {
             transitionAlpha = 1.0f;
             isTransitioning = false;
+            revision++;   // Último frame de la transición
         }
     }
 }
 
 void SceneManager::RenderBackground(int screenWidth, int screenHeight) {
+    PROFILE_SCOPE("SceneManager::RenderBackground");
+    // El fondo abre el render de la escena
+    textureBinds = 0;
+    lastTextureId = 0;
+    
     if (currentBackground.id > 0) {
         // Escalar el fondo para cubrir toda la pantalla
         float scaleX = (float)screenWidth / currentBackground.width;
@@ -129,15 +249,17 @@ void SceneManager::RenderBackground(int screenWidth, int screenHeight) {
         
         Vector2 origin = { 0, 0 };
         DrawTexturePro(currentBackground, source, dest, origin, 0.0f, WHITE);
+        CountTextureBind(currentBackground.id);
     } else {
         // Fondo negro si no hay imagen
-        ClearBackground(BLACK);
+        ::ClearBackground(BLACK);
     }
 }
 
 void SceneManager::RenderCharacters(int screenWidth, int screenHeight) {
+    PROFILE_SCOPE("SceneManager::RenderCharacters");
     // Renderizar personajes en orden: left, center, right
-    std::vector<CharacterPosition> renderOrder = {
+    static const CharacterPosition renderOrder[] = {
         CharacterPosition::LEFT,
         CharacterPosition::CENTER,
         CharacterPosition::RIGHT
@@ -147,12 +269,160 @@ void SceneManager::RenderCharacters(int screenWidth, int screenHeight) {
         for (auto& pair : characters) {
             if (pair.second->GetPosition() == pos) {
                 pair.second->Render(screenWidth, screenHeight);
+                CountTextureBind(pair.second->GetTextureId());
             }
         }
     }
 }
 
+uint32_t SceneManager::GetLayerRevision() const {
+    // Las revisiones solo suben: la suma cambia con cualquier cambio
+    uint32_t layer = revision;
+    for (const auto& pair : characters) {
+        layer += pair.second->GetRevision();
+    }
+    return layer;
+}
+
+void SceneManager::UnloadSceneLayer() {
+    // Tras CloseWindow ya no hay contexto de GL
+    if (sceneLayer.id > 0 && IsWindowReady()) {
+        UnloadRenderTexture(sceneLayer);
+    }
+    sceneLayer = (RenderTexture2D){ 0 };
+    layerValid = false;
+}
+
+void SceneManager::SetSceneLayerEnabled(bool enabled) {
+    useSceneLayer = enabled;
+    if (!enabled) {
+        UnloadSceneLayer();
+    }
+}
+
+void SceneManager::RenderScene(int screenWidth, int screenHeight) {
+    PROFILE_SCOPE("SceneManager::RenderScene");
+    if (!useSceneLayer) {
+        RenderBackground(screenWidth, screenHeight);
+        RenderCharacters(screenWidth, screenHeight);
+        return;
+    }
+    
+    if (sceneLayer.id == 0 || sceneLayer.texture.width != screenWidth ||
+        sceneLayer.texture.height != screenHeight) {
+        UnloadSceneLayer();
+        sceneLayer = LoadRenderTexture(screenWidth, screenHeight);
+        if (sceneLayer.id == 0) {
+            // Sin framebuffers: se dibuja la escena directamente cada frame
+            std::cerr << "Warning: Could not create scene layer, drawing directly" << std::endl;
+            useSceneLayer = false;
+            RenderBackground(screenWidth, screenHeight);
+            RenderCharacters(screenWidth, screenHeight);
+            return;
+        }
+    }
+    
+    uint32_t currentRevision = GetLayerRevision();
+    if (!layerValid || layerRevision != currentRevision) {
+        BeginTextureMode(sceneLayer);
+        ::ClearBackground(BLACK);
+        RenderBackground(screenWidth, screenHeight);
+        RenderCharacters(screenWidth, screenHeight);
+        EndTextureMode();
+        
+        layerRevision = currentRevision;
+        layerValid = true;
+        layerCompositions++;
+    } else {
+        textureBinds = 0;
+        lastTextureId = 0;
+    }
+    
+    // La textura de un framebuffer está invertida en Y
+    Rectangle source = { 0, 0, (float)screenWidth, -(float)screenHeight };
+    Rectangle dest = { 0, 0, (float)screenWidth, (float)screenHeight };
+    Vector2 origin = { 0, 0 };
+    
+    // Sin mezcla: el alpha de la capa queda por debajo de 1 bajo personajes
+    // semitransparentes y la escena ya es opaca
+    rlDrawRenderBatchActive();
+    rlDisableColorBlend();
+    DrawTexturePro(sceneLayer.texture, source, dest, origin, 0.0f, WHITE);
+    rlDrawRenderBatchActive();
+    rlEnableColorBlend();
+    CountTextureBind(sceneLayer.texture.id);
+}
+
+void SceneManager::RenderThumbnail(int width, int height) {
+    ::ClearBackground(BLACK);
+    if (useSceneLayer && layerValid && sceneLayer.id != 0) {
+        // La capa ya compuesta, escalada por la GPU: no se vuelve a dibujar la escena
+        Rectangle source = { 0, 0, (float)sceneLayer.texture.width, -(float)sceneLayer.texture.height };
+        Rectangle dest = { 0, 0, (float)width, (float)height };
+        DrawTexturePro(sceneLayer.texture, source, dest, (Vector2){ 0, 0 }, 0.0f, WHITE);
+    } else {
+        RenderBackground(width, height);
+        RenderCharacters(width, height);
+    }
+}
+
+void SceneManager::CountTextureBind(unsigned int textureId) {
+    // raylib agrupa en un draw call los quads consecutivos con la misma textura
+    if (textureId != 0 && textureId != lastTextureId) {
+        textureBinds++;
+        lastTextureId = textureId;
+    }
+}
+
+void SceneManager::PublishPins() {
+    ResourceManager* resources = ResourceManager::GetInstance();
+    std::vector<Symbol> keys;
+    if (currentBgName != NO_SYMBOL) {
+        keys.push_back(resources->BackgroundKey(currentBgName));
+    }
+    // El que sigue en pantalla mientras llega el nuevo
+    if (shownBgName != NO_SYMBOL && shownBgName != currentBgName) {
+        keys.push_back(resources->BackgroundKey(shownBgName));
+    }
+    if (currentMusicName != NO_SYMBOL) {
+        keys.push_back(resources->MusicKey(currentMusicName));
+    }
+    // También la pista que sale durante un fundido: el hilo de la música aún la usa
+    musicTracksRevision = musicPlayer.GetTrackRevision();
+    std::vector<Symbol> tracks;
+    musicPlayer.CollectTracks(tracks);
+    for (Symbol track : tracks) {
+        if (track != currentMusicName) {
+            keys.push_back(resources->MusicKey(track));
+        }
+    }
+    for (const auto& pair : characters) {
+        pair.second->CollectPinnedKeys(keys);
+    }
+    
+    resources->SetPinnedKeys(PinGroup::SCENE, keys);
+}
+
 void SceneManager::StartTransition() {
     isTransitioning = true;
     transitionAlpha = 0.0f;
+}
+
+bool SceneManager::IsDirty() const {
+    if (revision != cleanRevision || isTransitioning) {
+        return true;
+    }
+    for (const auto& pair : characters) {
+        if (pair.second->IsDirty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SceneManager::ClearDirty() {
+    cleanRevision = revision;
+    for (auto& pair : characters) {
+        pair.second->ClearDirty();
+    }
 }
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "profiler.h"
+#include "scene_timeline.h"
+
+SceneTimeline::SceneTimeline() : lineCount(0) {
+}
+
+void SceneTimeline::Clear() {
+    checkpoints.clear();
+    changes.clear();
+    musicPositions.clear();
+    buildState = SceneSnapshot();
+    lineCount = 0;
+}
+
+void SceneTimeline::ApplyLine(const ScriptChapter& chapter, size_t line, SceneSnapshot& state) {
+    ScriptInstruction inst;
+    size_t offset = chapter.GetLineOffset(line);
+    do {
+        offset = chapter.Decode(offset, inst);
+        switch (inst.op) {
+            case OpCode::BACKGROUND:
+                state.background = inst.arg1;
+                break;
+
+            case OpCode::MUSIC:
+                state.music = inst.arg1;
+                break;
+
+            case OpCode::CHARACTER:
+                SetCharacter(state, inst.arg1, inst.arg2, inst.position);
+                break;
+
+            default:
+                break;
+        }
+    } while (inst.op != OpCode::SAY && inst.op != OpCode::END);
+}
+
+void SceneTimeline::SetCharacter(SceneSnapshot& state, uint32_t name, uint32_t emotion,
+                                 CharacterPosition position) {
+    for (auto& entry : state.characters) {
+        if (entry.name == name) {
+            entry.emotion = emotion;
+            entry.position = position;
+            return;
+        }
+    }
+    state.characters.push_back({ name, emotion, position });
+}
+
+void SceneTimeline::Build(const ScriptChapter& chapter) {
+    PROFILE_SCOPE("SceneTimeline::Build");
+    size_t newCount = chapter.GetLineCount();
+    if (newCount < lineCount) {
+        // Otro capítulo más corto: empezar de cero
+        checkpoints.clear();
+        changes.clear();
+        buildState = SceneSnapshot();
+        lineCount = 0;
+    }
+
+    // Las posiciones ya registradas siguen valiendo si solo se añadieron líneas
+    musicPositions.resize(newCount, -1.0f);
+
+    for (size_t line = lineCount; line < newCount; line++) {
+        if (line % CHECKPOINT_INTERVAL == 0) {
+            checkpoints.push_back(buildState);
+            changes.push_back(SceneSnapshot());
+        }
+        ApplyLine(chapter, line, buildState);
+        ApplyLine(chapter, line, changes.back());
+    }
+    lineCount = newCount;
+}
+
+void SceneTimeline::Reconstruct(const ScriptChapter& chapter, size_t line, SceneSnapshot& out) const {
+    PROFILE_SCOPE("SceneTimeline::Reconstruct");
+    if (line >= lineCount || checkpoints.empty()) {
+        out = SceneSnapshot();
+        return;
+    }
+
+    size_t checkpoint = line / CHECKPOINT_INTERVAL;
+    out = checkpoints[checkpoint];
+    for (size_t i = checkpoint * CHECKPOINT_INTERVAL; i <= line; i++) {
+        ApplyLine(chapter, i, out);
+    }
+}
+
+void SceneTimeline::Replay(const ScriptChapter& chapter, size_t fromLine, size_t line,
+                           SceneState& state) const {
+    PROFILE_SCOPE("SceneTimeline::Replay");
+    if (line >= lineCount) {
+        return;
+    }
+
+    // Primero se junta lo que fijan las líneas recorridas y luego se aplica
+    SceneSnapshot applied;
+    size_t i = fromLine;
+    while (i <= line) {
+        if (i % CHECKPOINT_INTERVAL == 0 && line - i >= CHECKPOINT_INTERVAL - 1) {
+            const SceneSnapshot& block = changes[i / CHECKPOINT_INTERVAL];
+            if (block.background != SceneSnapshot::NONE) applied.background = block.background;
+            if (block.music != SceneSnapshot::NONE) applied.music = block.music;
+            for (const auto& entry : block.characters) {
+                SetCharacter(applied, entry.name, entry.emotion, entry.position);
+            }
+            i += CHECKPOINT_INTERVAL;
+        } else {
+            ApplyLine(chapter, i, applied);
+            i++;
+        }
+    }
+
+    if (applied.background != SceneSnapshot::NONE) {
+        state.background = chapter.GetSymbol(applied.background);
+    }
+    if (applied.music != SceneSnapshot::NONE) {
+        state.music = chapter.GetSymbol(applied.music);
+    }
+    for (const auto& entry : applied.characters) {
+        CharacterState character = { chapter.GetSymbol(entry.name), chapter.GetSymbol(entry.emotion),
+                                     entry.position, 1.0f };
+        bool found = false;
+        for (auto& current : state.characters) {
+            if (current.name == character.name) {
+                current = character;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            state.characters.push_back(character);
+        }
+    }
+    // Sin posición registrada y la misma pista, la que traía la escena
+    float position = GetMusicPosition(line);
+    if (position >= 0.0f || applied.music != SceneSnapshot::NONE) {
+        state.musicPosition = position;
+    }
+}
+
+void SceneTimeline::ToSceneState(const ScriptChapter& chapter, const SceneSnapshot& snapshot, size_t line,
+                                 SceneState& out) const {
+    out.background = (snapshot.background != SceneSnapshot::NONE)
+        ? chapter.GetSymbol(snapshot.background) : NO_SYMBOL;
+    out.music = (snapshot.music != SceneSnapshot::NONE)
+        ? chapter.GetSymbol(snapshot.music) : NO_SYMBOL;
+    out.musicPosition = GetMusicPosition(line);
+
+    out.characters.clear();
+    for (const auto& entry : snapshot.characters) {
+        out.characters.push_back({ chapter.GetSymbol(entry.name), chapter.GetSymbol(entry.emotion),
+                                   entry.position, 1.0f });
+    }
+}
+
+void SceneTimeline::RecordMusicPosition(size_t line, float seconds) {
+    if (line < musicPositions.size()) {
+        musicPositions[line] = seconds;
+    }
+}
+
+float SceneTimeline::GetMusicPosition(size_t line) const {
+    return (line < musicPositions.size()) ? musicPositions[line] : -1.0f;
+}
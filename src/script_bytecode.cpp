@@ -0,0 +1,541 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "script_bytecode.h"
+#include "asset_pack.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+struct ChapterHeader {
+    char magic[4];          // "NXBC"
+    uint16_t version;
+    uint16_t flags;
+    uint32_t stringCount;
+    uint32_t stringDataSize;
+    uint32_t codeSize;
+    uint32_t lineCount;
+    uint64_t sourceHash;
+    uint32_t labelCount;
+    uint32_t branchCount;
+    uint32_t exitCount;
+    uint32_t reserved;
+};
+static_assert(sizeof(ChapterHeader) == 48, "ChapterHeader debe ocupar 48 bytes");
+static_assert(sizeof(ScriptLabel) == 8 && sizeof(ScriptBranch) == 16 && sizeof(ScriptExit) == 16,
+              "La tabla de saltos se copia en bloque");
+
+const char CHAPTER_MAGIC[4] = { 'N', 'X', 'B', 'C' };
+
+uint32_t ReadVarUInt(const std::vector<uint8_t>& code, size_t& offset) {
+    uint32_t value = 0;
+    int shift = 0;
+    while (offset < code.size() && shift < 35) {
+        uint8_t byte = code[offset++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) break;
+        shift += 7;
+    }
+    return value;
+}
+
+size_t HashString(std::string_view str) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : str) {
+        hash = (hash ^ (uint8_t)c) * 1099511628211ULL;
+    }
+    return (size_t)hash;
+}
+
+} // namespace
+
+ScriptChapter::ScriptChapter() : nameCount(0), blockStart(0), sourceHash(0) {
+    Clear();
+}
+
+void ScriptChapter::Clear() {
+    code.clear();
+    lineOffsets.clear();
+    stringOffsets.clear();
+    stringData.clear();
+    symbols.clear();
+    labels.clear();
+    branches.clear();
+    exits.clear();
+    labelLines.Clear();
+    pendingBranches.Clear();
+    nameSlots.clear();
+    nameCount = 0;
+    blockStart = 0;
+    sourceHash = 0;
+
+    // El string 0 es siempre "" (narración sin personaje)
+    InternString("");
+}
+
+uint32_t ScriptChapter::InternString(std::string_view str) {
+    // Tras LoadFromMemory el índice está vacío: reconstruirlo una sola vez
+    // con los nombres (los que tienen símbolo) y el string 0
+    if (nameSlots.empty()) {
+        for (uint32_t i = 0; i < stringOffsets.size(); i++) {
+            if (i == 0 || symbols[i] != NO_SYMBOL) {
+                IndexName(i);
+            }
+        }
+    }
+
+    if (!nameSlots.empty()) {
+        size_t mask = nameSlots.size() - 1;
+        for (size_t slot = HashString(str) & mask; nameSlots[slot] != 0; slot = (slot + 1) & mask) {
+            if (GetString(nameSlots[slot] - 1) == str) {
+                return nameSlots[slot] - 1;
+            }
+        }
+    }
+
+    uint32_t id = AddString(str);
+    IndexName(id);
+    return id;
+}
+
+uint32_t ScriptChapter::AddString(std::string_view str) {
+    uint32_t id = (uint32_t)stringOffsets.size();
+    stringOffsets.push_back((uint32_t)stringData.size());
+    stringData.insert(stringData.end(), str.begin(), str.end());
+    stringData.push_back('\0');
+    symbols.push_back(NO_SYMBOL);
+    return id;
+}
+
+uint32_t ScriptChapter::AddText(std::string_view text) {
+    return text.empty() ? 0 : AddString(text);
+}
+
+void ScriptChapter::IndexName(uint32_t id) {
+    // Como mucho medio llena: al pasar se dobla y se vuelven a colocar
+    if ((nameCount + 1) * 2 > nameSlots.size()) {
+        std::vector<uint32_t> old;
+        old.swap(nameSlots);
+        nameSlots.assign(old.empty() ? 64 : old.size() * 2, 0);
+        nameCount = 0;
+        for (uint32_t slot : old) {
+            if (slot != 0) {
+                IndexName(slot - 1);
+            }
+        }
+    }
+
+    size_t mask = nameSlots.size() - 1;
+    size_t slot = HashString(GetString(id)) & mask;
+    while (nameSlots[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    nameSlots[slot] = id + 1;
+    nameCount++;
+}
+
+uint32_t ScriptChapter::InternName(std::string_view str) {
+    uint32_t id = InternString(str);
+    if (symbols[id] == NO_SYMBOL && !str.empty()) {
+        symbols[id] = Intern(str);
+    }
+    return id;
+}
+
+void ScriptChapter::ResolveSymbols() {
+    // Solo los strings que nombran algo: los textos no pasan por el interner
+    symbols.assign(stringOffsets.size(), NO_SYMBOL);
+    auto resolve = [this](uint32_t id) {
+        if (id < symbols.size() && symbols[id] == NO_SYMBOL) {
+            symbols[id] = Intern(GetString(id));
+        }
+    };
+
+    ScriptInstruction inst;
+    size_t offset = 0;
+    while (offset < code.size()) {
+        offset = Decode(offset, inst);
+        switch (inst.op) {
+            case OpCode::BACKGROUND:
+            case OpCode::MUSIC:
+            case OpCode::SFX:
+                resolve(inst.arg1);
+                break;
+            case OpCode::CHARACTER:
+                resolve(inst.arg1);
+                resolve(inst.arg2);
+                break;
+            case OpCode::SAY:
+                resolve(inst.arg1);
+                resolve(inst.arg3);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Tabla de saltos: nombres de etiquetas y capítulos de destino
+    labelLines.Clear();
+    for (const ScriptLabel& label : labels) {
+        resolve(label.name);
+        labelLines[symbols[label.name]] = label.line;
+    }
+    for (const ScriptBranch& branch : branches) {
+        resolve(branch.chapter);
+        resolve(branch.label);
+    }
+}
+
+void ScriptChapter::WriteVarUInt(uint32_t value) {
+    while (value >= 0x80) {
+        code.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    code.push_back((uint8_t)value);
+}
+
+void ScriptChapter::EmitBackground(std::string_view bgName) {
+    code.push_back((uint8_t)OpCode::BACKGROUND);
+    WriteVarUInt(InternName(bgName));
+}
+
+void ScriptChapter::EmitMusic(std::string_view musicName) {
+    code.push_back((uint8_t)OpCode::MUSIC);
+    WriteVarUInt(InternName(musicName));
+}
+
+void ScriptChapter::EmitSound(std::string_view soundName) {
+    code.push_back((uint8_t)OpCode::SFX);
+    WriteVarUInt(InternName(soundName));
+}
+
+void ScriptChapter::EmitCharacter(std::string_view name, std::string_view emotion,
+                                  CharacterPosition pos) {
+    code.push_back((uint8_t)OpCode::CHARACTER);
+    WriteVarUInt(InternName(name));
+    WriteVarUInt(InternName(emotion));
+    code.push_back((uint8_t)pos);
+}
+
+void ScriptChapter::EmitLine(std::string_view character, std::string_view text,
+                             std::string_view emotion, Color color) {
+    // El bloque de la línea incluye los comandos emitidos desde el SAY anterior
+    lineOffsets.push_back((uint32_t)blockStart);
+
+    code.push_back((uint8_t)OpCode::SAY);
+    WriteVarUInt(InternName(character));
+    WriteVarUInt(AddText(text));
+    WriteVarUInt(InternName(emotion));
+    code.push_back(color.r);
+    code.push_back(color.g);
+    code.push_back(color.b);
+    code.push_back(color.a);
+
+    blockStart = code.size();
+}
+
+void ScriptChapter::EmitLabel(std::string_view name) {
+    uint32_t nameId = InternName(name);
+    Symbol symbol = symbols[nameId];
+    if (symbol == NO_SYMBOL || labelLines.Contains(symbol)) {
+        return;   // La primera definición manda (nxcheck avisa de las repetidas)
+    }
+
+    uint32_t line = (uint32_t)lineOffsets.size();
+    labels.push_back({ nameId, line });
+    labelLines[symbol] = line;
+
+    // Saltos hacia delante que esperaban a esta etiqueta
+    if (std::vector<uint32_t>* pending = pendingBranches.Find(symbol)) {
+        for (uint32_t branch : *pending) {
+            branches[branch].line = line;
+        }
+        pendingBranches.Erase(symbol);
+    }
+}
+
+uint32_t ScriptChapter::AddBranch(std::string_view text, std::string_view chapterName,
+                                  std::string_view label) {
+    ScriptBranch branch;
+    branch.text = AddText(text);
+    branch.chapter = InternName(chapterName);
+    branch.label = InternName(label);
+    branch.line = UNRESOLVED_LINE;
+
+    uint32_t index = (uint32_t)branches.size();
+    if (branch.chapter == 0) {
+        if (branch.label == 0) {
+            branch.line = 0;
+        } else if (const uint32_t* line = labelLines.Find(symbols[branch.label])) {
+            branch.line = *line;
+        } else {
+            pendingBranches[symbols[branch.label]].push_back(index);
+        }
+    }
+    branches.push_back(branch);
+    return index;
+}
+
+void ScriptChapter::EmitJump(std::string_view chapterName, std::string_view label) {
+    // Sin línea de la que salir o con la salida ya puesta no hay nada que hacer
+    if (lineOffsets.empty()) return;
+    uint32_t line = (uint32_t)lineOffsets.size() - 1;
+    if (!exits.empty() && exits.back().line == line) return;
+
+    exits.push_back({ line, AddBranch("", chapterName, label), 1, 0 });
+}
+
+void ScriptChapter::EmitChoice(std::string_view text, std::string_view chapterName,
+                               std::string_view label) {
+    if (lineOffsets.empty()) return;
+    uint32_t line = (uint32_t)lineOffsets.size() - 1;
+
+    // Las opciones seguidas de una misma línea forman un único menú
+    if (!exits.empty() && exits.back().line == line) {
+        ScriptExit& exit = exits.back();
+        if (exit.choice && exit.firstBranch + exit.branchCount == branches.size()) {
+            AddBranch(text, chapterName, label);
+            exit.branchCount++;
+        }
+        return;
+    }
+    exits.push_back({ line, AddBranch(text, chapterName, label), 1, 1 });
+}
+
+size_t ScriptChapter::FindNextExit(size_t fromLine) const {
+    auto it = std::lower_bound(exits.begin(), exits.end(), fromLine,
+                               [](const ScriptExit& exit, size_t line) { return exit.line < line; });
+    return (it != exits.end()) ? (size_t)(it - exits.begin()) : NO_EXIT;
+}
+
+size_t ScriptChapter::FindExit(size_t line) const {
+    size_t index = FindNextExit(line);
+    return (index != NO_EXIT && exits[index].line == line) ? index : NO_EXIT;
+}
+
+uint32_t ScriptChapter::GetLabelLine(Symbol label) const {
+    const uint32_t* line = labelLines.Find(label);
+    return (line != nullptr) ? *line : UNRESOLVED_LINE;
+}
+
+size_t ScriptChapter::Decode(size_t offset, ScriptInstruction& out) const {
+    out.op = OpCode::END;
+    out.arg1 = out.arg2 = out.arg3 = 0;
+    out.position = CharacterPosition::CENTER;
+    out.color = WHITE;
+
+    if (offset >= code.size()) {
+        return code.size();
+    }
+
+    out.op = (OpCode)code[offset++];
+    switch (out.op) {
+        case OpCode::BACKGROUND:
+        case OpCode::MUSIC:
+        case OpCode::SFX:
+            out.arg1 = ReadVarUInt(code, offset);
+            break;
+
+        case OpCode::CHARACTER:
+            out.arg1 = ReadVarUInt(code, offset);
+            out.arg2 = ReadVarUInt(code, offset);
+            if (offset < code.size()) {
+                out.position = (CharacterPosition)code[offset++];
+            }
+            break;
+
+        case OpCode::SAY:
+            out.arg1 = ReadVarUInt(code, offset);
+            out.arg2 = ReadVarUInt(code, offset);
+            out.arg3 = ReadVarUInt(code, offset);
+            if (offset + 4 <= code.size()) {
+                out.color = (Color){ code[offset], code[offset + 1],
+                                     code[offset + 2], code[offset + 3] };
+                offset += 4;
+            }
+            break;
+
+        default:
+            // Opcode desconocido: tratar como fin del código
+            out.op = OpCode::END;
+            return code.size();
+    }
+
+    return offset;
+}
+
+std::string_view ScriptChapter::GetString(uint32_t id) const {
+    if (id >= stringOffsets.size()) {
+        return std::string_view("");
+    }
+    const char* str = stringData.data() + stringOffsets[id];
+    return std::string_view(str, strlen(str));
+}
+
+bool ScriptChapter::LoadFromMemory(const unsigned char* data, size_t size) {
+    ChapterHeader header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, CHAPTER_MAGIC, 4) != 0 || header.version != VERSION) {
+        return false;
+    }
+
+    size_t expected = sizeof(header)
+                    + (size_t)header.stringCount * sizeof(uint32_t)
+                    + header.stringDataSize
+                    + header.codeSize
+                    + (size_t)header.lineCount * sizeof(uint32_t)
+                    + (size_t)header.labelCount * sizeof(ScriptLabel)
+                    + (size_t)header.branchCount * sizeof(ScriptBranch)
+                    + (size_t)header.exitCount * sizeof(ScriptExit);
+    if (size < expected || header.stringCount == 0 || header.stringDataSize == 0 ||
+        data[sizeof(header) + header.stringCount * sizeof(uint32_t) + header.stringDataSize - 1] != '\0') {
+        return false;
+    }
+
+    // Copias en bloque de cada sección, sin parsear línea a línea
+    const unsigned char* ptr = data + sizeof(header);
+
+    stringOffsets.resize(header.stringCount);
+    memcpy(stringOffsets.data(), ptr, header.stringCount * sizeof(uint32_t));
+    ptr += header.stringCount * sizeof(uint32_t);
+
+    stringData.assign((const char*)ptr, (const char*)ptr + header.stringDataSize);
+    ptr += header.stringDataSize;
+
+    code.assign(ptr, ptr + header.codeSize);
+    ptr += header.codeSize;
+
+    lineOffsets.resize(header.lineCount);
+    memcpy(lineOffsets.data(), ptr, header.lineCount * sizeof(uint32_t));
+    ptr += header.lineCount * sizeof(uint32_t);
+
+    labels.resize(header.labelCount);
+    memcpy(labels.data(), ptr, header.labelCount * sizeof(ScriptLabel));
+    ptr += header.labelCount * sizeof(ScriptLabel);
+
+    branches.resize(header.branchCount);
+    memcpy(branches.data(), ptr, header.branchCount * sizeof(ScriptBranch));
+    ptr += header.branchCount * sizeof(ScriptBranch);
+
+    exits.resize(header.exitCount);
+    memcpy(exits.data(), ptr, header.exitCount * sizeof(ScriptExit));
+
+    for (uint32_t offset : stringOffsets) {
+        if (offset >= stringData.size()) {
+            Clear();
+            return false;
+        }
+    }
+    for (uint32_t offset : lineOffsets) {
+        if (offset > code.size()) {
+            Clear();
+            return false;
+        }
+    }
+    for (const ScriptLabel& label : labels) {
+        if (label.name >= stringOffsets.size() || label.line > lineOffsets.size()) {
+            Clear();
+            return false;
+        }
+    }
+    for (const ScriptBranch& branch : branches) {
+        if (branch.text >= stringOffsets.size() || branch.chapter >= stringOffsets.size() ||
+            branch.label >= stringOffsets.size() ||
+            (branch.line != UNRESOLVED_LINE && branch.line > lineOffsets.size())) {
+            Clear();
+            return false;
+        }
+    }
+    for (size_t i = 0; i < exits.size(); i++) {
+        // FindExit hace búsqueda binaria: tienen que venir ordenadas
+        if (exits[i].line >= lineOffsets.size() || exits[i].branchCount == 0 ||
+            (size_t)exits[i].firstBranch + exits[i].branchCount > branches.size() ||
+            (i > 0 && exits[i].line <= exits[i - 1].line)) {
+            Clear();
+            return false;
+        }
+    }
+
+    nameSlots.clear();
+    nameCount = 0;
+    pendingBranches.Clear();
+    blockStart = code.size();
+    sourceHash = header.sourceHash;
+    ResolveSymbols();
+    return true;
+}
+
+bool ScriptChapter::LoadFromFile(const std::string& path) {
+    // Mapeado: las secciones se copian una sola vez, directo del page cache
+    MappedFile file;
+    if (!file.Open(path)) {
+        return false;
+    }
+    return LoadFromMemory(file.GetData(), file.GetSize());
+}
+
+bool ScriptChapter::SaveToFile(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not write compiled chapter: " << path << std::endl;
+        return false;
+    }
+
+    ChapterHeader header;
+    memcpy(header.magic, CHAPTER_MAGIC, 4);
+    header.version = VERSION;
+    header.flags = 0;
+    header.stringCount = (uint32_t)stringOffsets.size();
+    header.stringDataSize = (uint32_t)stringData.size();
+    header.codeSize = (uint32_t)code.size();
+    header.lineCount = (uint32_t)lineOffsets.size();
+    header.sourceHash = sourceHash;
+    header.labelCount = (uint32_t)labels.size();
+    header.branchCount = (uint32_t)branches.size();
+    header.exitCount = (uint32_t)exits.size();
+    header.reserved = 0;
+
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)stringOffsets.data(), stringOffsets.size() * sizeof(uint32_t));
+    file.write(stringData.data(), stringData.size());
+    file.write((const char*)code.data(), code.size());
+    file.write((const char*)lineOffsets.data(), lineOffsets.size() * sizeof(uint32_t));
+    file.write((const char*)labels.data(), labels.size() * sizeof(ScriptLabel));
+    file.write((const char*)branches.data(), branches.size() * sizeof(ScriptBranch));
+    file.write((const char*)exits.data(), exits.size() * sizeof(ScriptExit));
+
+    return file.good();
+}
+
+uint64_t ScriptChapter::GetContentHash() const {
+    if (sourceHash != 0) {
+        return sourceHash;
+    }
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint8_t byte : code) {
+        hash = (hash ^ byte) * 1099511628211ULL;
+    }
+    for (char c : stringData) {
+        hash = (hash ^ (uint8_t)c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string ScriptChapter::GetCompiledPath(const std::string& scriptPath) {
+    size_t dot = scriptPath.find_last_of('.');
+    size_t slash = scriptPath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return scriptPath + ".nxb";
+    }
+    return scriptPath.substr(0, dot) + ".nxb";
+}
@@ -0,0 +1,117 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "script_prefetcher.h"
+#include <algorithm>
+
+ScriptPrefetcher::ScriptPrefetcher(size_t lines)
+    : lookahead(lines), scannedUpTo(0), lastLine(0) {
+}
+
+ScriptPrefetcher::~ScriptPrefetcher() {
+    Cancel();
+}
+
+void ScriptPrefetcher::Update(const ScriptChapter& chapter, size_t currentLine) {
+    // Salto hacia atrás: lo pedido para el futuro ya no corre prisa
+    if (currentLine < lastLine) {
+        Cancel();
+        windowKeys.clear();
+        scannedUpTo = currentLine + 1;
+    }
+    lastLine = currentLine;
+    
+    // Las líneas ya alcanzadas salen de la ventana
+    while (!windowKeys.empty() && windowKeys.front().first <= currentLine) {
+        windowKeys.pop_front();
+    }
+    
+    // Olvidar las peticiones ya terminadas
+    inFlight.erase(std::remove_if(inFlight.begin(), inFlight.end(),
+                                  [](const AssetHandle& h) { return h->IsDone(); }),
+                   inFlight.end());
+    
+    size_t end = std::min(chapter.GetLineCount(), currentLine + 1 + lookahead);
+    for (size_t line = std::max(scannedUpTo, currentLine + 1); line < end; line++) {
+        ScanLine(chapter, line);
+    }
+    scannedUpTo = std::max(scannedUpTo, end);
+    
+    PublishWindow();
+}
+
+void ScriptPrefetcher::PublishWindow() {
+    std::vector<Symbol> keys;
+    keys.reserve(windowKeys.size());
+    for (const auto& entry : windowKeys) {
+        keys.push_back(entry.second);
+    }
+    ResourceManager::GetInstance()->SetPinnedKeys(PinGroup::PREFETCH, keys);
+}
+
+void ScriptPrefetcher::ScanLine(const ScriptChapter& chapter, size_t line) {
+    ResourceManager* resources = ResourceManager::GetInstance();
+    AssetHandle handle;
+    
+    ScriptInstruction inst;
+    size_t offset = chapter.GetLineOffset(line);
+    do {
+        offset = chapter.Decode(offset, inst);
+        handle.reset();
+        
+        switch (inst.op) {
+            case OpCode::BACKGROUND:
+                handle = resources->RequestBackground(chapter.GetSymbol(inst.arg1));
+                break;
+                
+            case OpCode::MUSIC:
+                handle = resources->RequestMusic(chapter.GetSymbol(inst.arg1));
+                break;
+                
+            case OpCode::SFX:
+                handle = resources->RequestSound(chapter.GetSymbol(inst.arg1));
+                break;
+                
+            case OpCode::CHARACTER:
+                handle = resources->RequestCharacterSprite(chapter.GetSymbol(inst.arg1),
+                                                           chapter.GetSymbol(inst.arg2));
+                break;
+                
+            default:
+                break;
+        }
+        
+        if (handle) {
+            windowKeys.emplace_back(line, handle->key);
+            if (!handle->IsDone()) {
+                inFlight.push_back(handle);
+            }
+        }
+    } while (inst.op != OpCode::SAY && inst.op != OpCode::END);
+}
+
+void ScriptPrefetcher::Cancel() {
+    // Sin nada en vuelo no se toca el ResourceManager (puede estar ya destruido)
+    inFlight.erase(std::remove_if(inFlight.begin(), inFlight.end(),
+                                  [](const AssetHandle& h) { return h->IsDone(); }),
+                   inFlight.end());
+    if (inFlight.empty()) {
+        return;
+    }
+    
+    ResourceManager* resources = ResourceManager::GetInstance();
+    for (auto& handle : inFlight) {
+        resources->CancelRequest(handle);
+    }
+    inFlight.clear();
+}
+
+void ScriptPrefetcher::Reset() {
+    Cancel();
+    windowKeys.clear();
+    scannedUpTo = 0;
+    lastLine = 0;
+}
@@ -0,0 +1,77 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "profiler.h"
+#include "script_stream.h"
+#include <filesystem>
+#include <cstring>
+
+ScriptStream::ScriptStream()
+    : cursor(0), sourceHash(0), parser(nullptr) {
+}
+
+bool ScriptStream::Open(const std::string& path) {
+    cursor = 0;
+
+    if (!file.Open(path)) {
+        // MappedFile no mapea archivos vacíos: son un capítulo vacío, no un error
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(path, ec) || std::filesystem::file_size(path, ec) != 0) {
+            return false;
+        }
+    }
+
+    // El historial de lectura se asocia al texto fuente (el .nxb guarda el
+    // mismo hash). Una pasada sobre el mapeo de 8 en 8 bytes, sin parsear.
+    const unsigned char* data = file.GetData();
+    size_t size = file.GetSize();
+    sourceHash = 14695981039346656037ULL ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        sourceHash = (sourceHash ^ word) * 1099511628211ULL;
+        sourceHash ^= sourceHash >> 29;
+    }
+    for (; i < size; i++) {
+        sourceHash = (sourceHash ^ data[i]) * 1099511628211ULL;
+    }
+
+    // BOM de UTF-8 que dejan algunos editores
+    if (file.GetSize() >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+        cursor = 3;
+    }
+    return true;
+}
+
+bool ScriptStream::NextLine(std::string_view& line) {
+    size_t size = file.GetSize();
+    if (cursor >= size) {
+        return false;
+    }
+
+    const char* start = (const char*)file.GetData() + cursor;
+    const char* newline = (const char*)memchr(start, '\n', size - cursor);
+    size_t length = (newline != nullptr) ? (size_t)(newline - start) : size - cursor;
+
+    // El '\r' de CRLF lo quita Trim al parsear
+    line = std::string_view(start, length);
+    cursor += length + (newline != nullptr ? 1 : 0);
+    return true;
+}
+
+bool ScriptStream::CompileUpTo(ScriptChapter& chapter, size_t lineTarget) {
+    PROFILE_SCOPE("ScriptStream::CompileUpTo");
+    if (IsFinished()) {
+        return false;
+    }
+
+    std::string_view line;
+    while (chapter.GetLineCount() < lineTarget && NextLine(line)) {
+        parser.CompileLine(line, chapter);
+    }
+    return true;
+}
@@ -0,0 +1,224 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "profiler.h"
+#include "sound_mixer.h"
+#include <algorithm>
+
+SoundMixer::SoundMixer(int voiceCount)
+    : volume(1.0f), nextOrder(0), pinsDirty(false), stats{} {
+    voices.resize(voiceCount > 0 ? voiceCount : 1);
+    for (Voice& voice : voices) {
+        voice.alias = (Sound){ 0 };
+        voice.key = NO_SYMBOL;
+        voice.priority = PRIORITY_NORMAL;
+        voice.order = 0;
+    }
+}
+
+SoundMixer::~SoundMixer() {
+    Shutdown();
+}
+
+void SoundMixer::Shutdown() {
+    for (Voice& voice : voices) {
+        if (voice.key != NO_SYMBOL) {
+            ReleaseVoice(voice);
+        }
+    }
+    pending.clear();
+}
+
+void SoundMixer::Preload(const ScriptChapter& chapter, size_t fromOffset) {
+    PROFILE_SCOPE("SoundMixer::Preload");
+    ResourceManager* resources = ResourceManager::GetInstance();
+    if (fromOffset == 0) {
+        chapterSounds.clear();
+    }
+
+    size_t previous = chapterSounds.size();
+    ScriptInstruction inst;
+    size_t offset = fromOffset;
+    while (offset < chapter.GetCodeSize()) {
+        offset = chapter.Decode(offset, inst);
+        if (inst.op != OpCode::SFX) {
+            continue;
+        }
+        Symbol key = resources->SoundKey(chapter.GetSymbol(inst.arg1));
+        if (std::find(chapterSounds.begin(), chapterSounds.end(), key) != chapterSounds.end()) {
+            continue;
+        }
+        chapterSounds.push_back(key);
+        // Se decodifica en los workers; el handle no hace falta, el sonido queda en la caché
+        resources->RequestSound(chapter.GetSymbol(inst.arg1));
+    }
+
+    if (fromOffset == 0 || chapterSounds.size() != previous) {
+        PublishPins();
+    }
+}
+
+SoundMixer::Voice* SoundMixer::AcquireVoice(Symbol key, int priority) {
+    Voice* idle = nullptr;
+    Voice* candidate = nullptr;
+    for (Voice& voice : voices) {
+        if (voice.key == NO_SYMBOL || !IsSoundPlaying(voice.alias)) {
+            // Mejor una que ya tenga el alias de este sonido
+            if (voice.key == key) {
+                return &voice;
+            }
+            if (idle == nullptr) {
+                idle = &voice;
+            }
+            continue;
+        }
+        if (candidate == nullptr || voice.priority < candidate->priority ||
+            (voice.priority == candidate->priority && voice.order < candidate->order)) {
+            candidate = &voice;
+        }
+    }
+    if (idle != nullptr) {
+        return idle;
+    }
+
+    if (candidate->priority > priority) {
+        stats.rejected++;
+        return nullptr;
+    }
+    StopSound(candidate->alias);
+    stats.stolen++;
+    return candidate;
+}
+
+void SoundMixer::Start(Voice& voice, Symbol key, Sound source, float gain, float pan, int priority) {
+    // Un alias del mismo sonido se reutiliza; si no, se cambia por uno del nuevo
+    if (voice.key != key) {
+        if (voice.key != NO_SYMBOL) {
+            UnloadSoundAlias(voice.alias);
+        }
+        voice.alias = LoadSoundAlias(source);
+        voice.key = key;
+        pinsDirty = true;
+    }
+    voice.priority = priority;
+    voice.order = nextOrder++;
+    SetSoundVolume(voice.alias, gain * volume);
+    SetSoundPan(voice.alias, pan);
+    ::PlaySound(voice.alias);
+    stats.plays++;
+}
+
+void SoundMixer::ReleaseVoice(Voice& voice) {
+    StopSound(voice.alias);
+    UnloadSoundAlias(voice.alias);
+    voice.alias = (Sound){ 0 };
+    voice.key = NO_SYMBOL;
+    pinsDirty = true;
+}
+
+void SoundMixer::Play(Symbol soundName, float gain, float pan, int priority) {
+    PROFILE_SCOPE("SoundMixer::Play");
+    ResourceManager* resources = ResourceManager::GetInstance();
+    Symbol key = resources->SoundKey(soundName);
+
+    Sound source = resources->GetSound(key);
+    if (source.frameCount == 0) {
+        // Sin precargar (o aún en los workers): se dispara al llegar
+        PendingPlay play = { resources->RequestSound(soundName), gain, pan, priority, 0.0f };
+        pending.push_back(play);
+        stats.delayed++;
+        return;
+    }
+
+    Voice* voice = AcquireVoice(key, priority);
+    if (voice != nullptr) {
+        Start(*voice, key, source, gain, pan, priority);
+    }
+    if (pinsDirty) {
+        PublishPins();
+    }
+}
+
+void SoundMixer::StopAll() {
+    for (Voice& voice : voices) {
+        if (voice.key != NO_SYMBOL) {
+            StopSound(voice.alias);
+        }
+    }
+    for (const PendingPlay& play : pending) {
+        ResourceManager::GetInstance()->CancelRequest(play.handle);
+    }
+    pending.clear();
+}
+
+void SoundMixer::SetVolume(float newVolume) {
+    // Afecta a los disparos siguientes; las voces que suenan acaban como empezaron
+    volume = newVolume;
+}
+
+void SoundMixer::Update(float deltaTime) {
+    PROFILE_SCOPE("SoundMixer::Update");
+    for (Voice& voice : voices) {
+        // Terminada: se suelta el alias para que el sonido pueda expulsarse
+        if (voice.key != NO_SYMBOL && !IsSoundPlaying(voice.alias) &&
+            std::find(chapterSounds.begin(), chapterSounds.end(), voice.key) == chapterSounds.end()) {
+            ReleaseVoice(voice);
+        }
+    }
+
+    for (size_t i = 0; i < pending.size();) {
+        PendingPlay& play = pending[i];
+        play.age += deltaTime;
+        if (!play.handle->IsDone()) {
+            if (play.age * 1000.0f > MAX_DELAY_MS) {
+                stats.dropped++;
+                ResourceManager::GetInstance()->CancelRequest(play.handle);
+                pending.erase(pending.begin() + i);
+                continue;
+            }
+            i++;
+            continue;
+        }
+
+        if (play.handle->IsReady() && play.age * 1000.0f <= MAX_DELAY_MS) {
+            Voice* voice = AcquireVoice(play.handle->key, play.priority);
+            if (voice != nullptr) {
+                Start(*voice, play.handle->key, play.handle->sound, play.volume, play.pan, play.priority);
+            }
+        } else {
+            stats.dropped++;
+        }
+        pending.erase(pending.begin() + i);
+    }
+
+    if (pinsDirty) {
+        PublishPins();
+    }
+}
+
+void SoundMixer::PublishPins() {
+    // Los del capítulo y los que tiene alguna voz (un alias no puede quedarse sin su PCM)
+    std::vector<Symbol> keys(chapterSounds);
+    for (const Voice& voice : voices) {
+        if (voice.key != NO_SYMBOL &&
+            std::find(keys.begin(), keys.end(), voice.key) == keys.end()) {
+            keys.push_back(voice.key);
+        }
+    }
+    ResourceManager::GetInstance()->SetPinnedKeys(PinGroup::SOUNDS, keys);
+    pinsDirty = false;
+}
+
+SoundStats SoundMixer::GetStats() const {
+    SoundStats current = stats;
+    current.activeVoices = 0;
+    for (const Voice& voice : voices) {
+        if (voice.key != NO_SYMBOL && IsSoundPlaying(voice.alias)) {
+            current.activeVoices++;
+        }
+    }
+    return current;
+}
@@ -7,7 +7,7 @@
 
 SplashScreen::SplashScreen(const std::string& imagePath)
     : alpha(255.0f), loadingProgress(0.0f), elapsedTime(0.0f), 
-      totalLoadTime(3.0f), isFinished(false), showLoadingBar(true),
+      isFinished(false), showLoadingBar(true),
       texturePath(imagePath) {
     
     // Cargar la imagen si existe
@@ -20,10 +20,9 @@ void SplashScreen::Update(float deltaTime) {
     if (isFinished) return;
     
     elapsedTime += deltaTime;
-    loadingProgress = elapsedTime / totalLoadTime;
     
-    // Suavizar la barra con easing (Smooth Step)
-    if (loadingProgress > 1.0f) {
+    // Sin espera fija: en cuanto termina la carga se pasa al juego
+    if (loadingProgress >= 1.0f) {
         loadingProgress = 1.0f;
         isFinished = true;
     }
@@ -32,7 +31,7 @@ void SplashScreen::Update(float deltaTime) {
 void SplashScreen::Render(int screenWidth, int screenHeight) {
     if (isFinished) return;
     
-    BeginDrawing();
+    // El frame lo abre y lo cierra el bucle principal
     ClearBackground(WHITE);
     
     // Use render size to avoid issues when raylib downscales the final output
@@ -87,8 +86,6 @@ void SplashScreen::Render(int screenWidth, int screenHeight) {
             DrawText(loadingText, barX + (barWidth - textW) / 2, barY + barHeight + 8, 20, (Color){80, 80, 80, 255});
         }
     }
-    
-    EndDrawing();
 }
 
 void SplashScreen::Reset() {
@@ -98,10 +95,6 @@ void SplashScreen::Reset() {
     alpha = 255.0f;
 }
 
-void SplashScreen::SetLoadingTime(float totalTime) {
-    totalLoadTime = totalTime;
-}
-
 SplashScreen::~SplashScreen() {
     if (splashTexture.id > 0) {
         UnloadTexture(splashTexture);
@@ -0,0 +1,223 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "sprite_atlas.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+//------------------------------------------------------------------------------
+// SpriteAtlasIndex
+//------------------------------------------------------------------------------
+
+bool SpriteAtlasIndex::LoadFromText(const char* text) {
+    Clear();
+
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream fields(line);
+        std::string first;
+        fields >> first;
+
+        if (first == "page") {
+            std::string file;
+            fields >> file;
+            pages.push_back(file);
+            continue;
+        }
+
+        AtlasFrame frame;
+        std::string emotion;
+        fields >> emotion >> frame.source.x >> frame.source.y >> frame.source.width >> frame.source.height
+               >> frame.offset.x >> frame.offset.y >> frame.size.x >> frame.size.y;
+        if (fields.fail() || pages.empty()) {
+            std::cerr << "Warning: Invalid atlas line: " << line << std::endl;
+            continue;
+        }
+        frame.page = (int)pages.size() - 1;
+        frames[first + "/" + emotion] = frame;
+    }
+
+    return !frames.empty();
+}
+
+void SpriteAtlasIndex::Clear() {
+    pages.clear();
+    frames.clear();
+}
+
+bool SpriteAtlasIndex::Find(const std::string& character, const std::string& emotion,
+                            AtlasFrame& out) const {
+    if (frames.empty()) return false;
+
+    auto it = frames.find(character + "/" + emotion);
+    if (it == frames.end()) return false;
+    out = it->second;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// SpriteAtlasBuilder
+//------------------------------------------------------------------------------
+
+SpriteAtlasBuilder::SpriteAtlasBuilder(int maxPageSize, int spritePadding)
+    : pageSize(maxPageSize), padding(spritePadding) {
+}
+
+SpriteAtlasBuilder::~SpriteAtlasBuilder() {
+    for (auto& input : inputs) {
+        UnloadImage(input.image);
+    }
+}
+
+bool SpriteAtlasBuilder::Add(const std::string& character, const std::string& emotion,
+                             const std::string& path) {
+    Image image = LoadImage(path.c_str());
+    if (image.data == nullptr) {
+        std::cerr << "Warning: Could not load sprite: " << path << std::endl;
+        return false;
+    }
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    Input input;
+    input.character = character;
+    input.emotion = emotion;
+    input.size = (Vector2){ (float)image.width, (float)image.height };
+
+    // Recortar el borde totalmente transparente
+    Rectangle border = GetImageAlphaBorder(image, 0.0f);
+    if (border.width <= 0 || border.height <= 0) {
+        border = (Rectangle){ 0, 0, 1, 1 };
+    }
+    input.offset = (Vector2){ border.x, border.y };
+    input.image = ImageFromImage(image, border);
+    UnloadImage(image);
+
+    if (input.image.width + padding > pageSize || input.image.height + padding > pageSize) {
+        std::cerr << "Warning: Sprite larger than atlas page: " << path << std::endl;
+        UnloadImage(input.image);
+        return false;
+    }
+
+    input.page = 0;
+    input.position = (Vector2){ 0, 0 };
+    inputs.push_back(input);
+    return true;
+}
+
+bool SpriteAtlasBuilder::Build(const std::string& outputDir, const std::string& name) {
+    if (inputs.empty()) return false;
+
+    // Empaquetado por estantes, personaje a personaje y cada uno por altura
+    // descendente: sus sprites quedan juntos, así cambiar de emoción no
+    // cambia de página (salvo personajes que no caben en una sola)
+    std::vector<size_t> order(inputs.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        if (inputs[a].character != inputs[b].character) {
+            return inputs[a].character < inputs[b].character;
+        }
+        return inputs[a].image.height > inputs[b].image.height;
+    });
+
+    struct Shelf {
+        int page;
+        int x, y, height;
+    };
+    // Sitio para un sprite de w x h desde el cursor (nuevo estante o página si
+    // no cabe); deja el cursor detrás de él
+    auto place = [this](Shelf& shelf, int w, int h) {
+        if (shelf.x + w > pageSize) {
+            shelf.y += shelf.height;
+            shelf.x = 0;
+            shelf.height = 0;
+        }
+        if (shelf.y + h > pageSize) {
+            shelf.page++;
+            shelf.x = shelf.y = shelf.height = 0;
+        }
+        Vector2 position = { (float)shelf.x, (float)shelf.y };
+        shelf.x += w;
+        shelf.height = std::max(shelf.height, h);
+        return position;
+    };
+
+    Shelf shelf = { 0, 0, 0, 0 };
+    std::vector<int> pageHeights(1, 0);
+    std::vector<int> pageWidths(1, 0);
+
+    for (size_t first = 0; first < order.size();) {
+        size_t last = first;
+        while (last < order.size() && inputs[order[last]].character == inputs[order[first]].character) {
+            last++;
+        }
+
+        // Si el personaje no cabe en lo que queda de página pero sí en una
+        // vacía, empieza en la siguiente en vez de partirse entre dos
+        auto endPage = [&](Shelf start) {
+            for (size_t i = first; i < last; i++) {
+                place(start, inputs[order[i]].image.width + padding, inputs[order[i]].image.height + padding);
+            }
+            return start.page;
+        };
+        Shelf fresh = { shelf.page + 1, 0, 0, 0 };
+        if ((shelf.x > 0 || shelf.y > 0) && endPage(shelf) > shelf.page && endPage(fresh) == fresh.page) {
+            shelf = fresh;
+        }
+
+        for (size_t i = first; i < last; i++) {
+            Input& input = inputs[order[i]];
+            int h = input.image.height + padding;
+            input.position = place(shelf, input.image.width + padding, h);
+            input.page = shelf.page;
+            while ((int)pageWidths.size() <= shelf.page) {
+                pageHeights.push_back(0);
+                pageWidths.push_back(0);
+            }
+            pageWidths[shelf.page] = std::max(pageWidths[shelf.page], shelf.x);
+            pageHeights[shelf.page] = std::max(pageHeights[shelf.page], (int)input.position.y + h);
+        }
+        first = last;
+    }
+    int page = shelf.page;
+
+    std::ofstream index(outputDir + "/" + name + ".atlas");
+    if (!index.is_open()) {
+        std::cerr << "Error: Could not write atlas index in: " << outputDir << std::endl;
+        return false;
+    }
+    index << "# pagina / personaje emocion x y ancho alto offsetX offsetY anchoOriginal altoOriginal\n";
+
+    for (int p = 0; p <= page; p++) {
+        Image atlas = GenImageColor(pageWidths[p], pageHeights[p], BLANK);
+        std::string pageFile = name + "_" + std::to_string(p) + ".png";
+        index << "page " << pageFile << "\n";
+
+        for (const auto& input : inputs) {
+            if (input.page != p) continue;
+            Rectangle src = { 0, 0, (float)input.image.width, (float)input.image.height };
+            Rectangle dst = { input.position.x, input.position.y, src.width, src.height };
+            ImageDraw(&atlas, input.image, src, dst, WHITE);
+
+            index << input.character << " " << input.emotion << " "
+                  << dst.x << " " << dst.y << " " << dst.width << " " << dst.height << " "
+                  << input.offset.x << " " << input.offset.y << " "
+                  << input.size.x << " " << input.size.y << "\n";
+        }
+
+        bool ok = ExportImage(atlas, (outputDir + "/" + pageFile).c_str());
+        UnloadImage(atlas);
+        if (!ok) return false;
+
+        std::cout << pageFile << ": " << pageWidths[p] << "x" << pageHeights[p] << std::endl;
+    }
+
+    return true;
+}
@@ -0,0 +1,43 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "string_interner.h"
+
+StringInterner::StringInterner() {
+    // El id 0 es siempre "" (NO_SYMBOL)
+    strings.emplace_back();
+    ids.emplace(std::string_view(strings.back()), NO_SYMBOL);
+}
+
+StringInterner* StringInterner::GetInstance() {
+    // Estático local, como el Profiler: los workers del cargador y de los
+    // capítulos de destino internan sin que nadie lo cree antes
+    static StringInterner interner;
+    return &interner;
+}
+
+Symbol StringInterner::Intern(std::string_view str) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = ids.find(str);
+    if (it != ids.end()) {
+        return it->second;
+    }
+
+    Symbol id = (Symbol)strings.size();
+    strings.emplace_back(str);
+    ids.emplace(std::string_view(strings.back()), id);
+    return id;
+}
+
+const std::string& StringInterner::GetString(Symbol id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return (id < strings.size()) ? strings[id] : strings[NO_SYMBOL];
+}
+
+size_t StringInterner::GetCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return strings.size();
+}
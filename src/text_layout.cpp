@@ -0,0 +1,144 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "profiler.h"
+#include "text_layout.h"
+#include <algorithm>
+
+TextLayout::TextLayout() : height(0.0f) {
+    fontTexture = (Texture2D){ 0 };
+}
+
+void TextLayout::Build(std::string_view text, const Font& font, float fontSize, float spacing,
+                       float lineSpacing, float maxWidth) {
+    PROFILE_SCOPE("TextLayout::Build");
+    glyphs.clear();
+    fontTexture = font.texture;
+    height = 0.0f;
+
+    float scale = fontSize / (float)font.baseSize;
+    float padding = (float)font.glyphPadding;
+    float lineHeight = fontSize + lineSpacing;
+
+    auto Advance = [&](int index) {
+        float advance = (font.glyphs[index].advanceX != 0) ? (float)font.glyphs[index].advanceX
+                                                           : font.recs[index].width;
+        return advance * scale + spacing;
+    };
+    float spaceAdvance = Advance(GetGlyphIndex(font, ' '));
+
+    // Palabra en construcción (x relativa al inicio de la palabra)
+    std::vector<LayoutGlyph> word;
+    float wordAdvance = 0.0f;
+
+    float lineX = 0.0f;
+    float lineY = 0.0f;
+    bool lineEmpty = true;
+
+    auto CommitWord = [&]() {
+        if (word.empty()) return;
+
+        float startX = 0.0f;
+        if (!lineEmpty) {
+            // El ancho de la palabra no incluye el espaciado tras su último glifo
+            startX = lineX + spaceAdvance;
+            if (startX + wordAdvance - spacing > maxWidth) {
+                lineY += lineHeight;
+                startX = 0.0f;
+            }
+        }
+
+        for (auto& glyph : word) {
+            glyph.dest.x += startX;
+            glyph.dest.y += lineY;
+            glyphs.push_back(glyph);
+        }
+        lineX = startX + wordAdvance;
+        lineEmpty = false;
+        word.clear();
+        wordAdvance = 0.0f;
+    };
+
+    size_t i = 0;
+    uint32_t codepointIndex = 0;
+    while (i < text.size()) {
+        int size = 0;
+        int codepoint = GetCodepointNext(text.data() + i, &size);
+        if (size <= 0) size = 1;
+
+        if (codepoint == ' ') {
+            CommitWord();
+        } else if (codepoint == '\n') {
+            CommitWord();
+            if (!lineEmpty) {
+                lineY += lineHeight;
+                lineX = 0.0f;
+                lineEmpty = true;
+            }
+        } else {
+            int index = GetGlyphIndex(font, codepoint);
+            const Rectangle& rec = font.recs[index];
+
+            // Mismos rectángulos que DrawTextCodepoint, calculados una sola vez
+            LayoutGlyph glyph;
+            glyph.source = (Rectangle){ rec.x - padding, rec.y - padding,
+                                        rec.width + 2.0f * padding, rec.height + 2.0f * padding };
+            glyph.dest = (Rectangle){ wordAdvance + (font.glyphs[index].offsetX - padding) * scale,
+                                      (font.glyphs[index].offsetY - padding) * scale,
+                                      glyph.source.width * scale, glyph.source.height * scale };
+            glyph.textIndex = codepointIndex;
+            word.push_back(glyph);
+            wordAdvance += Advance(index);
+        }
+
+        i += size;
+        codepointIndex++;
+    }
+    CommitWord();
+
+    if (!glyphs.empty()) {
+        height = lineY + lineHeight;
+    }
+}
+
+size_t TextLayout::CountGlyphsBefore(size_t codepoints) const {
+    auto it = std::lower_bound(glyphs.begin(), glyphs.end(), codepoints,
+        [](const LayoutGlyph& glyph, size_t count) { return glyph.textIndex < count; });
+    return (size_t)(it - glyphs.begin());
+}
+
+void TextLayout::Draw(Vector2 position, size_t glyphCount, Color tint) const {
+    size_t count = std::min(glyphCount, glyphs.size());
+    for (size_t i = 0; i < count; i++) {
+        const LayoutGlyph& glyph = glyphs[i];
+        Rectangle dest = { position.x + glyph.dest.x, position.y + glyph.dest.y,
+                           glyph.dest.width, glyph.dest.height };
+        DrawTexturePro(fontTexture, glyph.source, dest, (Vector2){ 0, 0 }, 0.0f, tint);
+    }
+}
+
+TextLayoutCache::TextLayoutCache(size_t maxLayouts) : capacity(maxLayouts) {
+}
+
+const TextLayout& TextLayoutCache::Get(uint32_t textId, std::string_view text, const Font& font,
+                                       float fontSize, float spacing, float lineSpacing,
+                                       float maxWidth) {
+    Key key = { textId, font.texture.id, (int)(fontSize * 100.0f), (int)maxWidth };
+
+    auto it = layouts.find(key);
+    if (it != layouts.end()) {
+        return it->second;
+    }
+
+    // Un capítulo solo necesita las líneas cercanas; al llenarse se empieza de cero
+    if (layouts.size() >= capacity) {
+        layouts.clear();
+    }
+
+    TextLayout& layout = layouts[key];
+    layout.Build(text, font, fontSize, spacing, lineSpacing, maxWidth);
+    return layout;
+}
@@ -0,0 +1,210 @@
+#include "engine.h"
+#include "splash_screen.h"
+#include "dialogue_system.h"
+#include "scene_manager.h"
+#include "dialogue_parser.h"
+#include "resource_manager.h"
+#include "profiler.h"
+#include "voice_player.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+VoicePlayer::VoicePlayer(size_t lines)
+    : lookahead(lines), chapterGeneration(0), looseVoices(false), shownLine(NO_LINE), waiting(false),
+      waitTime(0.0f), stats{} {
+}
+
+VoicePlayer::~VoicePlayer() {
+    // Los streams se cierran en Reset, con el dispositivo de audio aún abierto;
+    // las lecturas en marcha sueltan su clip al terminar
+}
+
+bool VoicePlayer::IsRead(const VoiceClip& clip) {
+    return !clip.read.valid() ||
+           clip.read.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+VoicePlayer::VoiceClip* VoicePlayer::Find(size_t line) {
+    for (auto& clip : clips) {
+        if (clip->line == line) {
+            return clip.get();
+        }
+    }
+    return nullptr;
+}
+
+bool VoicePlayer::IsSilent(size_t line) const {
+    return line < silent.size() && silent[line];
+}
+
+void VoicePlayer::MarkSilent(size_t line) {
+    if (line >= silent.size()) {
+        silent.resize(line + 1, false);
+    }
+    silent[line] = true;
+}
+
+void VoicePlayer::Start(size_t line) {
+    ResourceManager* resources = ResourceManager::GetInstance();
+    PackEntry entry;
+    bool packed = resources->FindPackedAsset(resources->GetVoicePackKey(chapterName, line), entry);
+    if (!packed && !looseVoices) {
+        MarkSilent(line);
+        return;
+    }
+
+    std::shared_ptr<VoiceClip> clip = std::make_shared<VoiceClip>();
+    clip->line = line;
+    clip->entry = { nullptr, 0, nullptr };
+    clip->music = (Music){ 0 };
+    clip->packed = packed;
+
+    if (packed) {
+        // Ya mapeado: se abre sin leer nada
+        clip->entry = entry;
+        clip->fileType = entry.fileType;
+    } else {
+        // Las rutas se resuelven aquí; el worker no toca el ResourceManager
+        std::vector<std::string> candidates = resources->GetVoiceCandidates(chapterName, line);
+        auto read = std::make_shared<std::packaged_task<bool()>>([clip, candidates]() {
+            PROFILE_SCOPE("VoicePlayer::Read");
+            for (const std::string& path : candidates) {
+                std::ifstream file(path, std::ios::binary);
+                if (!file.is_open()) {
+                    continue;
+                }
+                clip->bytes.assign((std::istreambuf_iterator<char>(file)),
+                                   std::istreambuf_iterator<char>());
+                clip->fileType = path.substr(path.find_last_of('.'));
+                return !clip->bytes.empty();
+            }
+            return false;
+        });
+        clip->read = read->get_future();
+        resources->RunInBackground([read]() { (*read)(); });
+    }
+    clips.push_back(clip);
+}
+
+bool VoicePlayer::Open(VoiceClip& clip) {
+    if (clip.read.valid() && !clip.read.get()) {
+        // Línea sin voz: no hay archivo
+        return false;
+    }
+
+    // El stream decodifica de estos bytes mientras suena: viven tanto como él
+    const unsigned char* data = clip.packed ? clip.entry.data : clip.bytes.data();
+    size_t size = clip.packed ? clip.entry.size : clip.bytes.size();
+    clip.music = LoadMusicStreamFromMemory(clip.fileType.c_str(), data, (int)size);
+    if (clip.music.ctxType == 0) {
+        std::cerr << "Warning: Could not open voice clip for line " << clip.line + 1
+                  << " of " << chapterName << std::endl;
+        return false;
+    }
+    clip.music.looping = false;
+    return true;
+}
+
+void VoicePlayer::Close(VoiceClip& clip) {
+    if (clip.music.ctxType != 0) {
+        UnloadMusicStream(clip.music);
+        clip.music = (Music){ 0 };
+    }
+}
+
+void VoicePlayer::CloseAll(SceneManager& scene) {
+    scene.StopVoice();
+    for (auto& clip : clips) {
+        Close(*clip);
+    }
+    clips.clear();
+    shownLine = NO_LINE;
+    waiting = false;
+}
+
+void VoicePlayer::Update(const DialogueSystem& dialogue, const std::string& chapter, SceneManager& scene,
+                         float deltaTime) {
+    PROFILE_SCOPE("VoicePlayer::Update");
+    if (chapter != chapterName || dialogue.GetChapterGeneration() != chapterGeneration) {
+        CloseAll(scene);
+        chapterName = chapter;
+        chapterGeneration = dialogue.GetChapterGeneration();
+        looseVoices = !chapterName.empty() && ResourceManager::GetInstance()->HasLooseVoices(chapterName);
+        silent.clear();
+    }
+
+    // Al cambiar de línea la voz anterior se corta antes de cerrar su clip
+    size_t current = dialogue.GetCurrentLineIndex();
+    if (current != shownLine) {
+        scene.StopVoice();
+        shownLine = current;
+        waiting = true;
+        waitTime = 0.0f;
+    }
+
+    // Ventana: la línea actual y las lookahead siguientes
+    size_t last = current + lookahead;
+    for (auto it = clips.begin(); it != clips.end();) {
+        VoiceClip& clip = **it;
+        if (clip.line >= current && clip.line <= last) {
+            ++it;
+            continue;
+        }
+        Close(clip);
+        it = clips.erase(it);
+    }
+    for (size_t line = current; line <= last && line < dialogue.GetTotalLines(); line++) {
+        if (!IsSilent(line) && Find(line) == nullptr) {
+            Start(line);
+        }
+    }
+
+    // Lo que ya se leyó se abre ahora (solo las cabeceras: el audio se decodifica al sonar)
+    for (auto it = clips.begin(); it != clips.end();) {
+        VoiceClip& clip = **it;
+        if (clip.music.ctxType != 0 || !IsRead(clip) || Open(clip)) {
+            ++it;
+            continue;
+        }
+        MarkSilent(clip.line);
+        it = clips.erase(it);
+    }
+
+    if (waiting) {
+        VoiceClip* clip = Find(current);
+        if (clip == nullptr) {
+            waiting = false;
+        } else if (clip->music.ctxType != 0) {
+            scene.PlayVoice(clip->music);
+            stats.played++;
+            waiting = false;
+        } else {
+            // Suelto y aún leyéndose (se llegó de golpe a esta línea)
+            waitTime += deltaTime;
+            if (waitTime * 1000.0f > MAX_WAIT_MS) {
+                stats.late++;
+                waiting = false;
+            }
+        }
+    }
+}
+
+void VoicePlayer::Reset(SceneManager& scene) {
+    CloseAll(scene);
+    chapterName.clear();
+}
+
+VoiceStats VoicePlayer::GetStats() const {
+    VoiceStats current = stats;
+    current.windowClips = 0;
+    current.windowBytes = 0;
+    for (const auto& clip : clips) {
+        // Los que aún se leen no cuentan (el worker sigue escribiendo en bytes)
+        if (clip->music.ctxType != 0) {
+            current.windowClips++;
+            current.windowBytes += clip->packed ? clip->entry.size : clip->bytes.size();
+        }
+    }
+    return current;
+}
@@ -0,0 +1,67 @@
+#include "alloc_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Sustituye todas las formas de operator new/delete: así cada new tiene su
+// delete correspondiente y GCC no ve un free sobre memoria de otro operator new
+
+static std::atomic<size_t> allocationCount(0);
+static thread_local bool countAllocations = false;
+
+void SetCountAllocations(bool enabled) {
+    countAllocations = enabled;
+}
+
+size_t GetAllocationCount() {
+    return allocationCount.load();
+}
+
+static void* Allocate(std::size_t size) {
+    if (countAllocations) allocationCount++;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new(std::size_t size) {
+    void* ptr = Allocate(size);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](std::size_t size) {
+    void* ptr = Allocate(size);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,12 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+
+// Contador de asignaciones para los benchmarks (alloc_counter.cpp sustituye
+// operator new/delete en el ejecutable que lo enlaza). Solo se cuentan las
+// del hilo que activa el conteo.
+void SetCountAllocations(bool enabled);
+size_t GetAllocationCount();
+
+#endif // ALLOC_COUNTER_H
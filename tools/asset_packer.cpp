@@ -0,0 +1,116 @@
+#include "asset_pack.h"
+#include <filesystem>
+#include <iostream>
+
+// nxpack: empaqueta resources/ en un único resources.pak
+// Uso: nxpack <directorio de recursos> <salida.pak>
+//
+// Las claves son las mismas que resuelve el ResourceManager, y cuando hay
+// varias extensiones se respeta su orden de fallback (tabla AssetFolder).
+
+namespace fs = std::filesystem;
+
+static void AddDirectory(AssetPackWriter& writer, const fs::path& dir, const std::string& prefix,
+                         const std::vector<std::string>& extensions) {
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) return;
+    
+    // Una pasada por extensión para que la preferida se añada primero
+    for (const auto& ext : extensions) {
+        for (const auto& entry : fs::directory_iterator(dir, ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ext) {
+                writer.Add(prefix + entry.path().stem().string(), entry.path().string());
+            }
+        }
+    }
+}
+
+static void AddAssets(AssetPackWriter& writer, const fs::path& root, const AssetFolder& type) {
+    std::vector<std::string> extensions;
+    for (const char* extension : type.extensions) {
+        if (extension != nullptr) extensions.push_back(extension);
+    }
+    AddDirectory(writer, root / type.folder, type.keyPrefix, extensions);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Uso: nxpack <directorio de recursos> <salida.pak>" << std::endl;
+        return 1;
+    }
+    
+    fs::path root(argv[1]);
+    AssetPackWriter writer;
+    std::error_code ec;
+    
+    AddAssets(writer, root, BACKGROUND_ASSETS);
+    AddAssets(writer, root, CG_ASSETS);
+    AddAssets(writer, root, MUSIC_ASSETS);
+    AddAssets(writer, root, SOUND_ASSETS);
+    AddAssets(writer, root, GUI_ASSETS);
+    
+    // atlases/characters_<n>.png -> atlas_characters_<n>, atlases/*.atlas -> atlas/<archivo>
+    bool hasAtlas = fs::is_regular_file(root / "atlases" / "characters.atlas", ec);
+    if (hasAtlas) {
+        AddDirectory(writer, root / "atlases", "atlas_", { ".png" });
+        writer.Add("atlas/characters.atlas", (root / "atlases" / "characters.atlas").string());
+    }
+    
+    // characters/<personaje>/<emocion>.png -> <personaje>/<emocion>
+    // (si hay atlas los sprites ya van en sus páginas)
+    if (!hasAtlas && fs::is_directory(root / "characters", ec)) {
+        for (const auto& character : fs::directory_iterator(root / "characters", ec)) {
+            if (character.is_directory()) {
+                AddDirectory(writer, character.path(),
+                             character.path().filename().string() + "/", { ".png" });
+            }
+        }
+    }
+    
+    // fonts/<archivo> -> font/<archivo> (con extensión, como LoadFont)
+    if (fs::is_directory(root / "fonts", ec)) {
+        for (const auto& font : fs::directory_iterator(root / "fonts", ec)) {
+            if (font.is_regular_file()) {
+                writer.Add("font/" + font.path().filename().string(), font.path().string());
+            }
+        }
+    }
+    
+    // dialogues/<idioma>/*.nxb y *.manifest -> dialogue/<idioma>/<archivo> (ejecutar antes 'make scripts')
+    if (fs::is_directory(root / "dialogues", ec)) {
+        for (const auto& language : fs::directory_iterator(root / "dialogues", ec)) {
+            if (!language.is_directory()) continue;
+            for (const auto& script : fs::directory_iterator(language.path(), ec)) {
+                std::string extension = script.path().extension().string();
+                if (script.is_regular_file() && (extension == ".nxb" || extension == ".manifest")) {
+                    writer.Add("dialogue/" + language.path().filename().string() + "/" +
+                               script.path().filename().string(), script.path().string());
+                }
+            }
+        }
+    }
+    
+    // voice/<idioma>/<capitulo>/<linea>.ogg -> voice/<idioma>/<capitulo>/<linea>
+    if (fs::is_directory(root / VOICE_ASSETS.folder, ec)) {
+        std::vector<std::string> extensions;
+        for (const char* extension : VOICE_ASSETS.extensions) {
+            if (extension != nullptr) extensions.push_back(extension);
+        }
+        for (const auto& language : fs::directory_iterator(root / VOICE_ASSETS.folder, ec)) {
+            if (!language.is_directory()) continue;
+            for (const auto& chapter : fs::directory_iterator(language.path(), ec)) {
+                if (!chapter.is_directory()) continue;
+                AddDirectory(writer, chapter.path(),
+                             std::string(VOICE_ASSETS.keyPrefix) + language.path().filename().string() + "/" +
+                             chapter.path().filename().string() + "/", extensions);
+            }
+        }
+    }
+    
+    if (!writer.Write(argv[2])) {
+        return 1;
+    }
+    
+    std::cout << argv[2] << ": " << writer.GetEntryCount() << " recursos" << std::endl;
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "sprite_atlas.h"
+#include <filesystem>
+#include <iostream>
+#include <cstdlib>
+
+// nxatlas: agrupa los sprites de personajes en páginas de atlas recortadas
+// Uso: nxatlas <directorio de personajes> <directorio de salida> [tamaño de página]
+//
+// Genera <salida>/characters_<n>.png y <salida>/characters.atlas, que el
+// ResourceManager usa en lugar de los sprites sueltos.
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Uso: nxatlas <directorio de personajes> <directorio de salida> [tamaño de página]" << std::endl;
+        return 1;
+    }
+    
+    int pageSize = (argc > 3) ? std::atoi(argv[3]) : 4096;
+    if (pageSize <= 0) {
+        std::cerr << "Error: Invalid page size: " << argv[3] << std::endl;
+        return 1;
+    }
+    
+    SetTraceLogLevel(LOG_WARNING);
+    
+    SpriteAtlasBuilder builder(pageSize);
+    std::error_code ec;
+    int added = 0;
+    
+    // characters/<personaje>/<emocion>.png
+    for (const auto& character : fs::directory_iterator(argv[1], ec)) {
+        if (!character.is_directory()) continue;
+        for (const auto& sprite : fs::directory_iterator(character.path(), ec)) {
+            if (sprite.is_regular_file() && sprite.path().extension() == ".png") {
+                if (builder.Add(character.path().filename().string(), sprite.path().stem().string(),
+                                sprite.path().string())) {
+                    added++;
+                }
+            }
+        }
+    }
+    
+    if (added == 0) {
+        std::cerr << "Error: No sprites found in: " << argv[1] << std::endl;
+        return 1;
+    }
+    
+    fs::create_directories(argv[2], ec);
+    if (!builder.Build(argv[2], "characters")) {
+        return 1;
+    }
+    
+    std::cout << added << " sprites" << std::endl;
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "dialogue_system.h"
+#include "dialogue_parser.h"
+#include "script_bytecode.h"
+#include "alloc_counter.h"
+#include <chrono>
+#include <iostream>
+
+// dialogue_bench: mide el coste por frame del estado de diálogo
+// Uso: dialogue_bench [capitulo.txt]
+//
+// Reproduce el capítulo (o uno sintético con texto UTF-8 largo) a 60 fps
+// simulados y cuenta las asignaciones de memoria de Update + Render. El
+// primer frame de cada línea (comandos de escena, layout) se cuenta aparte.
+
+static void BuildSyntheticChapter(DialogueSystem& dialogue) {
+    const char* texts[] = {
+        "¡Hola! ¿Qué tal estás hoy? El niño comió piñata en el jardín mientras la música sonaba.",
+        "Era una mañana tranquila de otoño, y las hojas caían lentamente sobre el camino que "
+        "llevaba a la escuela. Nadie imaginaba lo que estaba a punto de ocurrir aquel día.",
+        "…y entonces, sin previo aviso, todo cambió. ¿Acaso era un sueño? No, era demasiado real.",
+    };
+    for (int i = 0; i < 300; i++) {
+        dialogue.AddLine((i % 2) ? "Sayori" : "", texts[i % 3], "neutral", WHITE);
+    }
+}
+
+int main(int argc, char** argv) {
+    SetTraceLogLevel(LOG_WARNING);
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(1280, 720, "dialogue_bench");
+
+    {
+        DialogueSystem dialogue;
+        if (argc > 1) {
+            DialogueParser parser(nullptr);
+            ScriptChapter chapter;
+            if (!parser.CompileDialogueFile(argv[1], chapter)) {
+                CloseWindow();
+                return 1;
+            }
+            dialogue.LoadChapter(std::move(chapter));
+        } else {
+            BuildSyntheticChapter(dialogue);
+        }
+
+        const float frameTime = 1.0f / 60.0f;
+        size_t frames = 0, revealFrames = 0, revealAllocations = 0, framesWithAllocations = 0;
+        size_t lineStartAllocations = 0;
+        double revealSeconds = 0.0;
+
+        for (size_t line = 0; line < dialogue.GetTotalLines(); line++) {
+            bool firstFrame = true;
+            do {
+                SetCountAllocations(true);
+                size_t before = GetAllocationCount();
+                auto start = std::chrono::steady_clock::now();
+
+                dialogue.Update(frameTime);
+                BeginDrawing();
+                ClearBackground(BLACK);
+                dialogue.Render(1280, 720);
+
+                auto end = std::chrono::steady_clock::now();
+                size_t allocations = GetAllocationCount() - before;
+                SetCountAllocations(false);
+                EndDrawing();
+
+                if (firstFrame) {
+                    lineStartAllocations += allocations;
+                    firstFrame = false;
+                } else {
+                    revealFrames++;
+                    revealAllocations += allocations;
+                    revealSeconds += std::chrono::duration<double>(end - start).count();
+                    if (allocations > 0) framesWithAllocations++;
+                }
+                frames++;
+            } while (!dialogue.IsLineFinished());
+
+            dialogue.NextLine();
+        }
+
+        std::cout << "Lineas: " << dialogue.GetTotalLines() << " | frames: " << frames << std::endl;
+        std::cout << "Frames revelando texto: " << revealFrames
+                  << " | asignaciones: " << revealAllocations
+                  << " | frames con asignaciones: " << framesWithAllocations << std::endl;
+        std::cout << "Asignaciones al empezar linea: " << lineStartAllocations << std::endl;
+        if (revealFrames > 0) {
+            std::cout << "Update + Render: " << (revealSeconds / revealFrames) * 1e6
+                      << " us/frame" << std::endl;
+        }
+    }
+
+    CloseWindow();
+    return 0;
+}
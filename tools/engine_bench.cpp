@@ -0,0 +1,323 @@
+#include "dialogue_system.h"
+#include "dialogue_parser.h"
+#include "scene_manager.h"
+#include "resource_manager.h"
+#include "script_bytecode.h"
+#include "profiler.h"
+#include "alloc_counter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+// nxbench: benchmark de CPU sin ventana (se enlaza con null_backend.cpp)
+// Uso: nxbench [directorio de recursos] [--frames N] [--gate-p99-us X] [--trace archivo.json]
+//
+// Para cada capítulo de <recursos>/dialogues/*/*.txt:
+//   - Velocidad del parser (compilar a bytecode) y de la carga del bytecode
+//   - N frames simulados de lectura normal, avance rápido y retroceso con el
+//     SceneManager, el ResourceManager y el DialogueSystem reales
+// Con --gate-p99-us termina con error si el p99 de algún capítulo lo supera.
+// Además comprueba que retroceder tras una opción reconstruye la escena que se vio.
+// Con --trace guarda las zonas del profiler en formato Chrome/Perfetto.
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+struct ReplayResult {
+    std::vector<double> frameMicros;
+    size_t allocations;
+    size_t framesWithAllocations;
+    size_t linesShown;
+    int layerCompositions;
+};
+
+static double Seconds(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double>(end - start).count();
+}
+
+static double Percentile(std::vector<double>& values, double p) {
+    if (values.empty()) return 0.0;
+    size_t index = (size_t)(p * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+// Compila el capítulo repetidamente durante al menos 200 ms
+static double MeasureParse(DialogueParser& parser, const std::string& path, ScriptChapter& chapter) {
+    size_t lines = 0;
+    auto start = Clock::now();
+    do {
+        ScriptChapter compiled;
+        if (!parser.CompileDialogueFile(path, compiled)) return 0.0;
+        lines += compiled.GetLineCount();
+        chapter = std::move(compiled);
+    } while (Seconds(start, Clock::now()) < 0.2);
+    return lines / Seconds(start, Clock::now());
+}
+
+static double MeasureBytecodeLoad(const ScriptChapter& chapter) {
+    std::string temp = (fs::temp_directory_path() / "nxbench.nxb").string();
+    if (!chapter.SaveToFile(temp)) return 0.0;
+
+    int size = 0;
+    unsigned char* data = LoadFileData(temp.c_str(), &size);
+    fs::remove(temp);
+    if (data == nullptr) return 0.0;
+
+    size_t lines = 0;
+    auto start = Clock::now();
+    do {
+        ScriptChapter loaded;
+        if (!loaded.LoadFromMemory(data, (size_t)size)) break;
+        lines += loaded.GetLineCount();
+    } while (Seconds(start, Clock::now()) < 0.2);
+    double elapsed = Seconds(start, Clock::now());
+    UnloadFileData(data);
+    return lines / elapsed;
+}
+
+// Repite el patrón del jugador: leer unas líneas, avance rápido, retroceder
+static ReplayResult Replay(const ScriptChapter& chapter, int frames) {
+    ReplayResult result = { {}, 0, 0, 0, 0 };
+    result.frameMicros.reserve(frames);
+
+    SceneManager scene;
+    DialogueSystem dialogue;
+    dialogue.SetSceneManager(&scene);
+    dialogue.LoadFonts("GenJyuuGothicX-Bold.ttf");
+    dialogue.SetTextSpeed(40.0f);
+    dialogue.SetPrefetchDistance(8);
+
+    ScriptChapter copy = chapter;
+    dialogue.LoadChapter(std::move(copy));
+
+    const float deltaTime = 1.0f / 60.0f;
+    unsigned int seed = 12345;
+    int dwell = 0;
+    int skipFrames = 0;
+    size_t lastLine = (size_t)-1;
+
+    for (int frame = 0; frame < frames; frame++) {
+        Profiler::GetInstance()->BeginFrame();
+        // Solo se cuentan las asignaciones del hilo principal dentro de un frame
+        SetCountAllocations(true);
+        size_t before = GetAllocationCount();
+        auto start = Clock::now();
+
+        ResourceManager::GetInstance()->ProcessUploads();
+        scene.Update(deltaTime);
+        dialogue.Update(deltaTime);
+
+        // Entrada simulada (misma lógica que main.cpp)
+        if (skipFrames > 0) {
+            skipFrames--;
+            if (dialogue.IsLineFinished()) dialogue.NextLine();
+            else dialogue.SkipToEnd();
+        } else if (dialogue.IsLineFinished() && ++dwell > 30) {
+            dwell = 0;
+            seed = seed * 1103515245 + 12345;
+            unsigned int roll = (seed >> 16) % 100;
+            if (roll < 10) {
+                // Avance rápido: de golpe sobre lo leído, si no línea a línea
+                if (!dialogue.SkipReadLines()) skipFrames = 90;
+            } else if (roll < 15) {
+                for (int i = 0; i < 3; i++) dialogue.PreviousLine();
+            } else {
+                dialogue.NextLine();
+            }
+        }
+
+        BeginDrawing();
+        scene.RenderScene(1280, 720);
+        dialogue.Render(1280, 720);
+        EndDrawing();
+
+        auto end = Clock::now();
+        SetCountAllocations(false);
+        Profiler::GetInstance()->EndFrame();
+
+        size_t allocations = GetAllocationCount() - before;
+        result.allocations += allocations;
+        if (allocations > 0) result.framesWithAllocations++;
+        result.frameMicros.push_back(Seconds(start, end) * 1e6);
+
+        if (dialogue.GetCurrentLineIndex() != lastLine) {
+            lastLine = dialogue.GetCurrentLineIndex();
+            result.linesShown++;
+        }
+
+        // Al llegar al final se vuelve a empezar el capítulo
+        if (dialogue.GetCurrentLineIndex() + 1 >= dialogue.GetTotalLines() && dialogue.IsLineFinished()) {
+            ScriptChapter again = chapter;
+            dialogue.LoadChapter(std::move(again));
+        }
+    }
+
+    result.layerCompositions = scene.GetLayerCompositions();
+    return result;
+}
+
+static bool SameScene(const SceneState& a, const SceneState& b) {
+    if (a.background != b.background || a.music != b.music || a.characters.size() != b.characters.size()) {
+        return false;
+    }
+    for (const auto& entry : a.characters) {
+        bool found = false;
+        for (const auto& other : b.characters) {
+            if (other.name == entry.name) {
+                found = other.emotion == entry.emotion && other.position == entry.position;
+                break;
+            }
+        }
+        if (!found) return false;
+    }
+    return true;
+}
+
+// Opción en la línea 10: la rama A (11-30) pone su fondo y su personaje, la
+// B (31-69) no. Se elige B, se avanza hasta el final y se retrocede hasta el
+// principio: cada línea tiene que mostrar la escena con la que se leyó.
+// Devuelve la primera línea distinta (o -1)
+static int CheckBranchRewind() {
+    ScriptChapter chapter;
+    for (int i = 0; i < 70; i++) {
+        if (i == 11) chapter.EmitLabel("a");
+        if (i == 31) chapter.EmitLabel("b");
+        if (i == 0 || i == 11 || i == 50) chapter.EmitBackground("bg" + std::to_string(i));
+        if (i == 12) chapter.EmitCharacter("A", "neutral", CharacterPosition::RIGHT);
+        if (i % 5 == 0) chapter.EmitCharacter("B", "e" + std::to_string(i), CharacterPosition::LEFT);
+        chapter.EmitLine("B", "t" + std::to_string(i), "neutral", WHITE);
+        if (i == 10) {
+            chapter.EmitChoice("A", "", "a");
+            chapter.EmitChoice("B", "", "b");
+        }
+        if (i == 30) chapter.EmitJump("", "b");
+    }
+
+    SceneManager scene;
+    DialogueSystem dialogue;
+    dialogue.SetSceneManager(&scene);
+    dialogue.LoadChapter(std::move(chapter));
+
+    std::vector<SceneState> shown(70);
+    while (true) {
+        dialogue.Update(0.0f);
+        dialogue.SkipToEnd();
+        dialogue.Update(0.0f);
+        size_t line = dialogue.GetCurrentLineIndex();
+        scene.CaptureState(shown[line]);
+        if (line + 1 == shown.size()) break;
+        if (dialogue.IsChoosing()) dialogue.Choose(1);
+        else dialogue.NextLine();
+    }
+
+    while (dialogue.GetCurrentLineIndex() > 0) {
+        dialogue.PreviousLine();
+        dialogue.Update(0.0f);
+        size_t line = dialogue.GetCurrentLineIndex();
+        SceneState state;
+        scene.CaptureState(state);
+        if (!SameScene(state, shown[line])) return (int)line;
+    }
+    return -1;
+}
+
+int main(int argc, char** argv) {
+    std::string resources = "resources";
+    int frames = 20000;
+    double gateMicros = 0.0;
+    std::string tracePath;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--gate-p99-us") == 0 && i + 1 < argc) {
+            gateMicros = std::atof(argv[++i]);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else {
+            resources = argv[i];
+        }
+    }
+
+    Profiler::GetInstance()->SetThreadName("Principal");
+    ResourceManager::GetInstance()->Initialize(resources);
+    DialogueParser parser(nullptr);
+
+    std::vector<fs::path> chapters;
+    std::error_code ec;
+    for (const auto& language : fs::directory_iterator(fs::path(resources) / "dialogues", ec)) {
+        if (!language.is_directory()) continue;
+        for (const auto& script : fs::directory_iterator(language.path(), ec)) {
+            if (script.is_regular_file() && script.path().extension() == ".txt") {
+                chapters.push_back(script.path());
+            }
+        }
+    }
+    std::sort(chapters.begin(), chapters.end());
+
+    if (chapters.empty()) {
+        std::cerr << "Error: No chapters found in: " << resources << "/dialogues" << std::endl;
+        ResourceManager::Destroy();
+        return 1;
+    }
+
+    bool gateFailed = false;
+    for (const auto& path : chapters) {
+        ScriptChapter chapter;
+        double parseRate = MeasureParse(parser, path.string(), chapter);
+        if (chapter.GetLineCount() == 0) {
+            std::cerr << "Warning: Empty chapter: " << path.string() << std::endl;
+            continue;
+        }
+        double loadRate = MeasureBytecodeLoad(chapter);
+
+        ReplayResult replay = Replay(chapter, frames);
+        double p50 = Percentile(replay.frameMicros, 0.50);
+        double p90 = Percentile(replay.frameMicros, 0.90);
+        double p99 = Percentile(replay.frameMicros, 0.99);
+        double worst = Percentile(replay.frameMicros, 1.0);
+
+        std::cout << path.string() << " (" << chapter.GetLineCount() << " lineas)" << std::endl;
+        std::cout << "  parser: " << (size_t)parseRate << " lineas/s | bytecode: "
+                  << (size_t)loadRate << " lineas/s" << std::endl;
+        std::cout << "  frames: " << frames << " | lineas mostradas: " << replay.linesShown
+                  << " | capa de escena compuesta: " << replay.layerCompositions << std::endl;
+        std::cout << "  frame (us): p50 " << p50 << " | p90 " << p90 << " | p99 " << p99
+                  << " | max " << worst << std::endl;
+        std::cout << "  asignaciones: " << replay.allocations << " ("
+                  << (double)replay.allocations / frames << "/frame, "
+                  << replay.framesWithAllocations << " frames con asignaciones)" << std::endl;
+
+        if (gateMicros > 0.0 && p99 > gateMicros) {
+            std::cout << "  FALLO: p99 supera " << gateMicros << " us" << std::endl;
+            gateFailed = true;
+        }
+    }
+
+    int wrongLine = CheckBranchRewind();
+    if (wrongLine >= 0) {
+        std::cout << "FALLO: escena distinta al retroceder tras una opcion (linea " << wrongLine + 1 << ")"
+                  << std::endl;
+        gateFailed = true;
+    } else {
+        std::cout << "Escena al retroceder tras una opcion: OK" << std::endl;
+    }
+
+    for (int i = 0; i < (int)CacheClass::COUNT; i++) {
+        CacheStats stats = ResourceManager::GetInstance()->GetCacheStats((CacheClass)i);
+        std::cout << "Cache " << i << ": hits " << stats.hits << " | miss " << stats.misses
+                  << " | expulsados " << stats.evictions << std::endl;
+    }
+
+    if (!tracePath.empty() && Profiler::GetInstance()->ExportChromeTrace(tracePath)) {
+        std::cout << "Traza: " << tracePath << std::endl;
+    }
+
+    ResourceManager::Destroy();
+    return gateFailed ? 1 : 0;
+}
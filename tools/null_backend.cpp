@@ -0,0 +1,425 @@
+#include "raylib.h"
+#include "rlgl.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+
+// Backend nulo de raylib para ejecutar el motor sin ventana ni GPU ni audio
+//
+// Se enlaza en lugar de libraylib (make bench). Implementa solo la parte de
+// la API que usa el motor:
+//   - Archivos, UTF-8 y búsqueda de glifos: implementación real (son CPU)
+//   - Imágenes y audio: solo metadatos (dimensiones de la cabecera PNG,
+//     duración estimada); los datos de píxeles/muestras no se decodifican
+//   - Texturas: ids crecientes con sus dimensiones
+//   - Dibujo, ventana y reproducción: no hacen nada
+
+namespace {
+
+unsigned int nextTextureId = 2;   // 1 es la fuente por defecto
+
+double Now() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Imagen sin píxeles reales: UnloadImage libera el marcador
+Image PlaceholderImage(int width, int height, int format) {
+    Image image = { 0 };
+    if (width <= 0 || height <= 0) return image;
+    image.data = std::calloc(4, 1);
+    image.width = width;
+    image.height = height;
+    image.mipmaps = 1;
+    image.format = format;
+    return image;
+}
+
+// Dimensiones de la cabecera IHDR de un PNG; otros formatos se asumen 256x256
+Image ImageFromHeader(const unsigned char* data, size_t size) {
+    static const unsigned char PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (data == nullptr || size == 0) return (Image){ 0 };
+
+    if (size >= 24 && memcmp(data, PNG_SIGNATURE, 8) == 0) {
+        int width = (data[16] << 24) | (data[17] << 16) | (data[18] << 8) | data[19];
+        int height = (data[20] << 24) | (data[21] << 16) | (data[22] << 8) | data[23];
+        return PlaceholderImage(width, height, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+    return PlaceholderImage(256, 256, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+}
+
+long FileSize(const char* fileName) {
+    struct stat info;
+    if (fileName == nullptr || stat(fileName, &info) != 0) return -1;
+    return (long)info.st_size;
+}
+
+// Audio comprimido ~10:1 respecto a PCM estéreo de 16 bits a 44.1 kHz
+Wave WaveFromSize(long bytes) {
+    Wave wave = { 0 };
+    if (bytes <= 0) return wave;
+    wave.frameCount = (unsigned int)(bytes * 10 / 4);
+    wave.sampleRate = 44100;
+    wave.sampleSize = 16;
+    wave.channels = 2;
+    wave.data = std::calloc(4, 1);
+    return wave;
+}
+
+AudioStream NullStream() {
+    AudioStream stream = { 0 };
+    stream.sampleRate = 44100;
+    stream.sampleSize = 16;
+    stream.channels = 2;
+    return stream;
+}
+
+Music MusicFromSize(long bytes) {
+    Music music = { 0 };
+    if (bytes <= 0) return music;
+    music.stream = NullStream();
+    music.frameCount = (unsigned int)(bytes * 10 / 4);
+    music.looping = true;
+    music.ctxType = 1;
+    return music;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// Ventana y frame
+//------------------------------------------------------------------------------
+
+void InitWindow(int, int, const char*) {}
+void CloseWindow(void) {}
+bool WindowShouldClose(void) { return false; }
+bool IsWindowReady(void) { return true; }
+void SetConfigFlags(unsigned int) {}
+void SetTargetFPS(int) {}
+void ToggleBorderlessWindowed(void) {}
+int GetRenderWidth(void) { return 1280; }
+int GetRenderHeight(void) { return 720; }
+void SetTraceLogLevel(int) {}
+void BeginDrawing(void) {}
+void EndDrawing(void) {}
+void ClearBackground(Color) {}
+double GetTime(void) { return Now(); }
+
+//------------------------------------------------------------------------------
+// Dibujo
+//------------------------------------------------------------------------------
+
+void DrawRectangle(int, int, int, int, Color) {}
+void DrawRectangleLines(int, int, int, int, Color) {}
+void DrawRectangleRec(Rectangle, Color) {}
+void DrawRectangleLinesEx(Rectangle, float, Color) {}
+void DrawText(const char*, int, int, int, Color) {}
+void DrawTextEx(Font, const char*, Vector2, float, float, Color) {}
+void DrawTexturePro(Texture2D, Rectangle, Rectangle, Vector2, float, Color) {}
+
+Color Fade(Color color, float alpha) {
+    if (alpha < 0.0f) alpha = 0.0f;
+    if (alpha > 1.0f) alpha = 1.0f;
+    color.a = (unsigned char)(255.0f * alpha);
+    return color;
+}
+
+//------------------------------------------------------------------------------
+// Archivos y memoria
+//------------------------------------------------------------------------------
+
+void* MemAlloc(unsigned int size) { return std::calloc(size, 1); }
+void MemFree(void* ptr) { std::free(ptr); }
+
+bool FileExists(const char* fileName) {
+    return FileSize(fileName) >= 0;
+}
+
+bool DirectoryExists(const char* dirPath) {
+    struct stat info;
+    return dirPath != nullptr && stat(dirPath, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+long GetFileModTime(const char* fileName) {
+    struct stat info;
+    if (fileName == nullptr || stat(fileName, &info) != 0) return 0;
+    return (long)info.st_mtime;
+}
+
+unsigned char* LoadFileData(const char* fileName, int* dataSize) {
+    *dataSize = 0;
+    FILE* file = fopen(fileName, "rb");
+    if (file == nullptr) return nullptr;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char* data = (unsigned char*)std::malloc(size > 0 ? size : 1);
+    size_t read = fread(data, 1, (size_t)size, file);
+    fclose(file);
+    *dataSize = (int)read;
+    return data;
+}
+
+void UnloadFileData(unsigned char* data) { std::free(data); }
+
+char* LoadFileText(const char* fileName) {
+    int size = 0;
+    unsigned char* data = LoadFileData(fileName, &size);
+    if (data == nullptr) return nullptr;
+
+    char* text = (char*)std::realloc(data, (size_t)size + 1);
+    text[size] = '\0';
+    return text;
+}
+
+void UnloadFileText(char* text) { std::free(text); }
+
+//------------------------------------------------------------------------------
+// Texto (misma lógica que raylib)
+//------------------------------------------------------------------------------
+
+int GetCodepointNext(const char* text, int* codepointSize) {
+    const unsigned char* ptr = (const unsigned char*)text;
+    *codepointSize = 1;
+    if (ptr[0] < 0x80) return ptr[0];
+
+    if ((ptr[0] & 0xE0) == 0xC0 && (ptr[1] & 0xC0) == 0x80) {
+        *codepointSize = 2;
+        return ((ptr[0] & 0x1F) << 6) | (ptr[1] & 0x3F);
+    }
+    if ((ptr[0] & 0xF0) == 0xE0 && (ptr[1] & 0xC0) == 0x80 && (ptr[2] & 0xC0) == 0x80) {
+        *codepointSize = 3;
+        return ((ptr[0] & 0x0F) << 12) | ((ptr[1] & 0x3F) << 6) | (ptr[2] & 0x3F);
+    }
+    if ((ptr[0] & 0xF8) == 0xF0 && (ptr[1] & 0xC0) == 0x80 && (ptr[2] & 0xC0) == 0x80 &&
+        (ptr[3] & 0xC0) == 0x80) {
+        *codepointSize = 4;
+        return ((ptr[0] & 0x07) << 18) | ((ptr[1] & 0x3F) << 12) | ((ptr[2] & 0x3F) << 6) | (ptr[3] & 0x3F);
+    }
+    return 0x3F;   // '?'
+}
+
+int GetCodepointCount(const char* text) {
+    int count = 0;
+    while (*text != '\0') {
+        int size = 0;
+        GetCodepointNext(text, &size);
+        text += size;
+        count++;
+    }
+    return count;
+}
+
+int GetGlyphIndex(Font font, int codepoint) {
+    int fallback = 0;
+    for (int i = 0; i < font.glyphCount; i++) {
+        if (font.glyphs[i].value == codepoint) return i;
+        if (font.glyphs[i].value == '?') fallback = i;
+    }
+    return fallback;
+}
+
+Font GetFontDefault(void) {
+    // ASCII imprimible, 10px, 6px de avance
+    static GlyphInfo glyphs[95];
+    static Rectangle recs[95];
+    static Font font = { 0 };
+    if (font.glyphCount == 0) {
+        for (int i = 0; i < 95; i++) {
+            glyphs[i].value = 32 + i;
+            glyphs[i].advanceX = 6;
+            recs[i] = (Rectangle){ (float)(i % 16) * 8, (float)(i / 16) * 12, 6, 10 };
+        }
+        font.baseSize = 10;
+        font.glyphCount = 95;
+        font.texture = (Texture2D){ 1, 128, 128, 1, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA };
+        font.recs = recs;
+        font.glyphs = glyphs;
+    }
+    return font;
+}
+
+int MeasureText(const char* text, int fontSize) {
+    return GetCodepointCount(text) * fontSize * 6 / 10;
+}
+
+Vector2 MeasureTextEx(Font, const char* text, float fontSize, float spacing) {
+    int count = GetCodepointCount(text);
+    return (Vector2){ count * (fontSize * 0.6f + spacing), fontSize };
+}
+
+bool CheckCollisionPointRec(Vector2 point, Rectangle rec) {
+    return point.x >= rec.x && point.x < rec.x + rec.width &&
+           point.y >= rec.y && point.y < rec.y + rec.height;
+}
+
+GlyphInfo* LoadFontData(const unsigned char* fileData, int, int fontSize, int* codepoints,
+                        int codepointCount, int) {
+    if (fileData == nullptr || codepointCount <= 0) return nullptr;
+
+    // Glifos sintéticos de media anchura para ejercitar el atlas de la GlyphCache
+    GlyphInfo* glyphs = (GlyphInfo*)std::calloc((size_t)codepointCount, sizeof(GlyphInfo));
+    int width = fontSize / 2;
+    for (int i = 0; i < codepointCount; i++) {
+        glyphs[i].value = codepoints[i];
+        glyphs[i].advanceX = width;
+        glyphs[i].image.width = width;
+        glyphs[i].image.height = fontSize;
+        glyphs[i].image.mipmaps = 1;
+        glyphs[i].image.format = PIXELFORMAT_UNCOMPRESSED_GRAYSCALE;
+        glyphs[i].image.data = std::calloc((size_t)width * fontSize, 1);
+    }
+    return glyphs;
+}
+
+void UnloadFontData(GlyphInfo* glyphs, int glyphCount) {
+    if (glyphs == nullptr) return;
+    for (int i = 0; i < glyphCount; i++) {
+        std::free(glyphs[i].image.data);
+    }
+    std::free(glyphs);
+}
+
+//------------------------------------------------------------------------------
+// Imágenes y texturas
+//------------------------------------------------------------------------------
+
+int GetPixelDataSize(int width, int height, int format) {
+    int bytesPerPixel = 4;
+    switch (format) {
+        case PIXELFORMAT_UNCOMPRESSED_GRAYSCALE: bytesPerPixel = 1; break;
+        case PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA: bytesPerPixel = 2; break;
+        case PIXELFORMAT_UNCOMPRESSED_R8G8B8: bytesPerPixel = 3; break;
+        default: break;
+    }
+    return width * height * bytesPerPixel;
+}
+
+Image LoadImage(const char* fileName) {
+    unsigned char header[24] = { 0 };
+    FILE* file = fopen(fileName, "rb");
+    if (file == nullptr) return (Image){ 0 };
+    size_t read = fread(header, 1, sizeof(header), file);
+    fclose(file);
+    return ImageFromHeader(header, read);
+}
+
+Image LoadImageFromMemory(const char*, const unsigned char* fileData, int dataSize) {
+    return ImageFromHeader(fileData, (size_t)dataSize);
+}
+
+void UnloadImage(Image image) { std::free(image.data); }
+
+Image GenImageColor(int width, int height, Color) {
+    return PlaceholderImage(width, height, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+}
+
+void ImageDraw(Image*, Image, Rectangle, Rectangle, Color) {}
+void ImageFormat(Image* image, int newFormat) { image->format = newFormat; }
+
+Image ImageFromImage(Image image, Rectangle rec) {
+    return PlaceholderImage((int)rec.width, (int)rec.height, image.format);
+}
+
+Rectangle GetImageAlphaBorder(Image image, float) {
+    return (Rectangle){ 0, 0, (float)image.width, (float)image.height };
+}
+
+bool ExportImage(Image, const char*) { return false; }
+unsigned char* ExportImageToMemory(Image, const char*, int* fileSize) {
+    if (fileSize != nullptr) *fileSize = 0;
+    return nullptr;
+}
+void ImageFlipVertical(Image*) {}
+
+Image LoadImageFromTexture(Texture2D texture) {
+    return PlaceholderImage(texture.width, texture.height, texture.format);
+}
+
+Texture2D LoadTextureFromImage(Image image) {
+    Texture2D texture = { 0 };
+    if (image.data == nullptr) return texture;
+    texture.id = nextTextureId++;
+    texture.width = image.width;
+    texture.height = image.height;
+    texture.mipmaps = 1;
+    texture.format = image.format;
+    return texture;
+}
+
+Texture2D LoadTexture(const char* fileName) {
+    Image image = LoadImage(fileName);
+    Texture2D texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    return texture;
+}
+
+void UnloadTexture(Texture2D) {}
+void UpdateTexture(Texture2D, const void*) {}
+
+RenderTexture2D LoadRenderTexture(int width, int height) {
+    RenderTexture2D target = { 0 };
+    if (width <= 0 || height <= 0) return target;
+    target.id = nextTextureId++;
+    target.texture.id = nextTextureId++;
+    target.texture.width = width;
+    target.texture.height = height;
+    target.texture.mipmaps = 1;
+    target.texture.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    return target;
+}
+
+void UnloadRenderTexture(RenderTexture2D) {}
+void BeginTextureMode(RenderTexture2D) {}
+void EndTextureMode(void) {}
+void rlDrawRenderBatchActive(void) {}
+void rlEnableColorBlend(void) {}
+void rlDisableColorBlend(void) {}
+
+//------------------------------------------------------------------------------
+// Audio
+//------------------------------------------------------------------------------
+
+Wave LoadWave(const char* fileName) { return WaveFromSize(FileSize(fileName)); }
+Wave LoadWaveFromMemory(const char*, const unsigned char*, int dataSize) { return WaveFromSize(dataSize); }
+void UnloadWave(Wave wave) { std::free(wave.data); }
+
+Sound LoadSoundFromWave(Wave wave) {
+    Sound sound = { 0 };
+    if (wave.data == nullptr) return sound;
+    sound.stream = NullStream();
+    sound.frameCount = wave.frameCount;
+    return sound;
+}
+
+Sound LoadSound(const char* fileName) {
+    Wave wave = LoadWave(fileName);
+    Sound sound = LoadSoundFromWave(wave);
+    UnloadWave(wave);
+    return sound;
+}
+
+void UnloadSound(Sound) {}
+void PlaySound(Sound) {}
+Sound LoadSoundAlias(Sound source) { return source; }
+void UnloadSoundAlias(Sound) {}
+void StopSound(Sound) {}
+bool IsSoundPlaying(Sound) { return false; }
+void SetSoundVolume(Sound, float) {}
+void SetSoundPan(Sound, float) {}
+
+Music LoadMusicStream(const char* fileName) { return MusicFromSize(FileSize(fileName)); }
+Music LoadMusicStreamFromMemory(const char*, const unsigned char*, int dataSize) { return MusicFromSize(dataSize); }
+void UnloadMusicStream(Music) {}
+void PlayMusicStream(Music) {}
+bool IsMusicStreamPlaying(Music) { return false; }
+void StopMusicStream(Music) {}
+void UpdateMusicStream(Music) {}
+void SetMusicVolume(Music, float) {}
+void SeekMusicStream(Music, float) {}
+float GetMusicTimePlayed(Music) { return 0.0f; }
+void SetAudioStreamBufferSizeDefault(int) {}
@@ -0,0 +1,65 @@
+#include "dialogue_parser.h"
+#include "script_bytecode.h"
+#include "chapter_manifest.h"
+#include <filesystem>
+#include <iostream>
+
+// nxbc: compilador offline de capítulos (ch*.txt -> ch*.nxb + ch*.manifest)
+// Uso: nxbc <archivo.txt | directorio> [...]
+// Con un directorio se compilan recursivamente todos los .txt que contiene.
+// El .manifest lista los recursos del capítulo para la pantalla de carga.
+
+namespace fs = std::filesystem;
+
+static bool CompileScript(DialogueParser& parser, const fs::path& input) {
+    ScriptChapter chapter;
+    if (!parser.CompileDialogueFile(input.string(), chapter)) {
+        return false;
+    }
+    
+    std::string output = ScriptChapter::GetCompiledPath(input.string());
+    if (!chapter.SaveToFile(output)) {
+        return false;
+    }
+    
+    ChapterManifest manifest;
+    manifest.CollectFrom(chapter);
+    if (!manifest.SaveToFile(ChapterManifest::GetManifestPath(input.string()))) {
+        return false;
+    }
+    
+    std::cout << input.string() << " -> " << output
+              << " (" << chapter.GetLineCount() << " lineas, "
+              << chapter.GetStringCount() << " strings, "
+              << chapter.GetCodeSize() << " bytes de codigo, "
+              << manifest.Size() << " recursos)" << std::endl;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Uso: nxbc <archivo.txt | directorio> [...]" << std::endl;
+        return 1;
+    }
+    
+    // Sin SceneManager: solo compila, no ejecuta comandos de escena
+    DialogueParser parser(nullptr);
+    int failed = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        fs::path input(argv[i]);
+        std::error_code ec;
+        
+        if (fs::is_directory(input, ec)) {
+            for (const auto& entry : fs::recursive_directory_iterator(input, ec)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+                    if (!CompileScript(parser, entry.path())) failed++;
+                }
+            }
+        } else if (!CompileScript(parser, input)) {
+            failed++;
+        }
+    }
+    
+    return failed == 0 ? 0 : 1;
+}
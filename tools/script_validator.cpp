@@ -0,0 +1,513 @@
+#include "dialogue_parser.h"
+#include "asset_pack.h"
+#include "sprite_atlas.h"
+#include "script_stream.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <algorithm>
+#include <cstdlib>
+
+// nxcheck: validador de capítulos y recursos de todos los idiomas
+// Uso: nxcheck <directorio de recursos> [--pack <archivo.pak>] [--manifest <directorio>] [--jobs <n>]
+//
+// Parsea cada capítulo (dialogues/<idioma>/*.txt) con DialogueParser::ParseLine,
+// repartidos entre todos los núcleos, comprueba que los @jump y @choice
+// lleven a capítulos y etiquetas que existen y que exista cada recurso que
+// referencia con las mismas reglas que ResourceManager: atlas o sprite suelto
+// para los personajes y la tabla AssetFolder (extensiones en orden de
+// fallback) para fondos, música y sfx. Con --pack se valida contra el pack,
+// como el juego en release, en lugar de los archivos sueltos.
+//
+// Los diagnósticos salen como <archivo>:<línea>:<columna>: y el código de
+// salida es 1 si hay algún error (los avisos no cuentan). Con --manifest se
+// escribe <directorio>/<idioma>.manifest con los recursos que usa cada idioma.
+
+namespace fs = std::filesystem;
+
+enum class Severity {
+    WARNING,
+    ERROR
+};
+
+struct Diagnostic {
+    size_t line;
+    size_t column;
+    Severity severity;
+    std::string message;
+};
+
+// Recurso referenciado por un capítulo y dónde lo encontraría el juego
+struct AssetReference {
+    std::string kind;     // bg, music, sfx, sprite
+    std::string name;
+    std::string source;   // Archivo relativo o clave del pack ("" si no existe)
+
+    bool operator<(const AssetReference& other) const {
+        if (kind != other.kind) return kind < other.kind;
+        return name < other.name;
+    }
+};
+
+// Destino de un @jump o @choice; se comprueba al terminar todos los
+// capítulos, cuando ya se conocen las etiquetas de cada uno
+struct BranchReference {
+    std::string chapter;  // "" si es el mismo capítulo
+    std::string label;    // "" si es el inicio del capítulo
+    size_t line;
+    size_t column;
+};
+
+struct ScriptReport {
+    fs::path path;
+    std::string language;
+    size_t lines;
+    std::vector<Diagnostic> diagnostics;
+    std::vector<AssetReference> assets;
+    std::map<std::string, size_t> labels;   // Etiqueta -> línea del script
+    std::vector<BranchReference> branches;
+};
+
+// Qué recursos existen. Se construye una vez antes de lanzar los hilos y
+// después solo se consulta, así que no necesita sincronización.
+class AssetCatalog {
+private:
+    AssetPack pack;
+    bool usePack;
+    SpriteAtlasIndex atlas;
+    // Rutas relativas ('/' como separador) de todos los archivos sueltos.
+    // Se comparan exactas también en Windows, donde el disco no distingue
+    // mayúsculas pero el pack sí.
+    std::unordered_set<std::string> files;
+
+    bool Exists(const std::string& relativePath) const {
+        return files.count(relativePath) != 0;
+    }
+
+public:
+    AssetCatalog() : usePack(false) {}
+
+    bool Load(const fs::path& root, const std::string& packPath) {
+        std::error_code ec;
+        if (!packPath.empty()) {
+            if (!pack.Open(packPath)) {
+                return false;
+            }
+            usePack = true;
+            PackEntry entry;
+            if (pack.Find("atlas/characters.atlas", entry)) {
+                atlas.LoadFromText(std::string((const char*)entry.data, entry.size).c_str());
+            }
+            return true;
+        }
+
+        for (auto it = fs::recursive_directory_iterator(root, ec);
+             it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            if (it->is_regular_file(ec)) {
+                files.insert(it->path().lexically_relative(root).generic_string());
+            }
+        }
+
+        std::ifstream index(root / "atlases" / "characters.atlas", std::ios::binary);
+        if (index) {
+            std::stringstream text;
+            text << index.rdbuf();
+            atlas.LoadFromText(text.str().c_str());
+        }
+        return true;
+    }
+
+    // Rutas (o clave) que probaría ResourceManager, para los mensajes
+    std::string DescribeCandidates(const AssetFolder& type, std::string_view name) const {
+        if (usePack) {
+            return std::string("pack: ") + type.keyPrefix + std::string(name);
+        }
+        std::string candidates;
+        for (const char* extension : type.extensions) {
+            if (extension == nullptr) continue;
+            if (!candidates.empty()) candidates += ", ";
+            candidates += std::string(type.folder) + "/" + std::string(name) + extension;
+        }
+        return candidates;
+    }
+
+    std::string Resolve(const AssetFolder& type, std::string_view name) const {
+        if (usePack) {
+            std::string key = type.keyPrefix + std::string(name);
+            PackEntry entry;
+            return pack.Find(key, entry) ? key : std::string();
+        }
+        for (const char* extension : type.extensions) {
+            if (extension == nullptr) continue;
+            std::string path = std::string(type.folder) + "/" + std::string(name) + extension;
+            if (Exists(path)) {
+                return path;
+            }
+        }
+        return std::string();
+    }
+
+    // Igual que ResourceManager::ResolveSprite: si el atlas lo contiene se
+    // usa su página (y tiene que existir), si no el sprite suelto
+    std::string ResolveSprite(std::string_view character, std::string_view emotion) const {
+        AtlasFrame frame;
+        if (atlas.Find(std::string(character), std::string(emotion), frame)) {
+            const std::string& page = atlas.GetPageName(frame.page);
+            if (usePack) {
+                std::string key = "atlas_" + page.substr(0, page.find_last_of('.'));
+                PackEntry entry;
+                return pack.Find(key, entry) ? key : std::string();
+            }
+            std::string path = "atlases/" + page;
+            return Exists(path) ? path : std::string();
+        }
+
+        if (usePack) {
+            std::string key = std::string(character) + "/" + std::string(emotion);
+            PackEntry entry;
+            return pack.Find(key, entry) ? key : std::string();
+        }
+        std::string path = "characters/" + std::string(character) + "/" + std::string(emotion) + ".png";
+        return Exists(path) ? path : std::string();
+    }
+
+    std::string DescribeSprite(std::string_view character, std::string_view emotion) const {
+        AtlasFrame frame;
+        if (atlas.Find(std::string(character), std::string(emotion), frame)) {
+            return "atlas: " + atlas.GetPageName(frame.page);
+        }
+        if (usePack) {
+            return "pack: " + std::string(character) + "/" + std::string(emotion);
+        }
+        return "characters/" + std::string(character) + "/" + std::string(emotion) + ".png";
+    }
+};
+
+static void Report(ScriptReport& report, size_t line, size_t column, Severity severity,
+                   const std::string& message) {
+    report.diagnostics.push_back({ line, column, severity, message });
+}
+
+static void CheckAsset(ScriptReport& report, const AssetCatalog& catalog, const AssetFolder& type,
+                       const char* kind, const char* missing, std::string_view name,
+                       size_t line, size_t column) {
+    AssetReference reference;
+    reference.kind = kind;
+    reference.name = std::string(name);
+    reference.source = catalog.Resolve(type, name);
+    if (reference.source.empty()) {
+        Report(report, line, column, Severity::ERROR,
+               std::string(missing) + " '" + reference.name + "' (" +
+               catalog.DescribeCandidates(type, name) + ")");
+    }
+    report.assets.push_back(reference);
+}
+
+static void ValidateScript(DialogueParser& parser, const AssetCatalog& catalog, ScriptReport& report) {
+    // Las mismas líneas que compila el motor (mapeo, BOM, archivo vacío)
+    ScriptStream stream;
+    if (!stream.Open(report.path.string())) {
+        Report(report, 0, 0, Severity::ERROR, "no se pudo abrir el archivo");
+        return;
+    }
+
+    size_t lineNumber = 0;
+    bool hasDialogue = false;     // Los saltos y opciones salen de la última línea de diálogo
+    CommandType lineExit = CommandType::NONE;
+    std::string_view line;
+    while (stream.NextLine(line)) {
+        lineNumber++;
+
+        // Los valores de ParsedCommand son vistas sobre la línea: su
+        // posición dentro de ella es la columna (en bytes, desde 1)
+        auto column = [&line](std::string_view part) {
+            return (size_t)(part.data() - line.data()) + 1;
+        };
+
+        ParsedCommand cmd = parser.ParseLine(line);
+        switch (cmd.type) {
+            case CommandType::BACKGROUND:
+                CheckAsset(report, catalog, BACKGROUND_ASSETS, "bg", "Falta el fondo",
+                           cmd.value1, lineNumber, column(cmd.value1));
+                break;
+
+            case CommandType::MUSIC:
+                CheckAsset(report, catalog, MUSIC_ASSETS, "music", "Falta la musica",
+                           cmd.value1, lineNumber, column(cmd.value1));
+                break;
+
+            case CommandType::SFX:
+                CheckAsset(report, catalog, SOUND_ASSETS, "sfx", "Falta el sonido",
+                           cmd.value1, lineNumber, column(cmd.value1));
+                break;
+
+            case CommandType::CHARACTER: {
+                AssetReference reference;
+                reference.kind = "sprite";
+                reference.name = std::string(cmd.value1) + "/" + std::string(cmd.value2);
+                reference.source = catalog.ResolveSprite(cmd.value1, cmd.value2);
+                if (reference.source.empty()) {
+                    Report(report, lineNumber, column(cmd.value2), Severity::ERROR,
+                           "Falta el sprite '" + reference.name + "' (" +
+                           catalog.DescribeSprite(cmd.value1, cmd.value2) + ")");
+                }
+                report.assets.push_back(reference);
+
+                CharacterPosition position;
+                if (!DialogueParser::TryParsePosition(cmd.value3, position)) {
+                    Report(report, lineNumber, column(cmd.value3), Severity::WARNING,
+                           "Posicion desconocida '" + std::string(cmd.value3) + "' (se usa center)");
+                }
+                break;
+            }
+
+            case CommandType::LABEL: {
+                std::string label(cmd.value1);
+                auto defined = report.labels.find(label);
+                if (defined != report.labels.end()) {
+                    Report(report, lineNumber, column(cmd.value1), Severity::ERROR,
+                           "Etiqueta '" + label + "' repetida (definida en la linea " +
+                           std::to_string(defined->second) + ")");
+                } else {
+                    report.labels[label] = lineNumber;
+                }
+                break;
+            }
+
+            case CommandType::JUMP:
+            case CommandType::CHOICE: {
+                bool isJump = cmd.type == CommandType::JUMP;
+                std::string_view chapter = isJump ? cmd.value1 : cmd.value2;
+                std::string_view label = isJump ? cmd.value2 : cmd.value3;
+                size_t targetColumn = column(!chapter.empty() ? chapter : label);
+                if (!hasDialogue) {
+                    Report(report, lineNumber, targetColumn, Severity::ERROR,
+                           "Salto u opcion antes de la primera linea de dialogo (se ignora)");
+                    break;
+                }
+                // Una línea tiene un salto o un menú, no los dos
+                if (lineExit == CommandType::JUMP || (isJump && lineExit == CommandType::CHOICE)) {
+                    Report(report, lineNumber, targetColumn, Severity::WARNING,
+                           "La linea anterior ya tiene salida (se ignora)");
+                    break;
+                }
+                lineExit = cmd.type;
+                report.branches.push_back({ std::string(chapter), std::string(label),
+                                            lineNumber, targetColumn });
+                break;
+            }
+
+            case CommandType::DIALOGUE:
+            case CommandType::NARRATION: {
+                hasDialogue = true;
+                lineExit = CommandType::NONE;
+                // Sin comilla de cierre ParseLine deja el texto sin asignar
+                std::string_view text = (cmd.type == CommandType::DIALOGUE) ? cmd.value2 : cmd.value1;
+                if (text.data() == nullptr) {
+                    Report(report, lineNumber, line.find('"') + 1, Severity::WARNING,
+                           "Comillas sin cerrar (la linea se muestra vacia)");
+                }
+                break;
+            }
+
+            case CommandType::NONE: {
+                size_t first = line.find_first_not_of(" \t\r\n");
+                if (first == std::string_view::npos) {
+                    break;   // Línea vacía
+                }
+                if (line[first] == '@') {
+                    size_t end = line.find_first_of(" \t\r\n", first);
+                    std::string_view command = line.substr(first, end == std::string_view::npos ?
+                                                                  std::string_view::npos : end - first);
+                    Report(report, lineNumber, first + 1, Severity::ERROR,
+                           "Comando desconocido o sin valor: '" + std::string(command) + "'");
+                } else {
+                    Report(report, lineNumber, first + 1, Severity::WARNING,
+                           "Linea no reconocida (se ignora)");
+                }
+                break;
+            }
+
+            case CommandType::COMMENT:
+                break;
+        }
+    }
+    report.lines = lineNumber;
+}
+
+static bool WriteManifest(const fs::path& path, const std::string& language,
+                          const std::set<AssetReference>& assets) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Error: No se pudo escribir " << path.string() << std::endl;
+        return false;
+    }
+    out << "# nxcheck: recursos de dialogues/" << language << " (tipo nombre origen)\n";
+    for (const AssetReference& asset : assets) {
+        out << asset.kind << " " << asset.name << " "
+            << (asset.source.empty() ? "-" : asset.source) << "\n";
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Uso: nxcheck <directorio de recursos> [--pack <archivo.pak>] "
+                     "[--manifest <directorio>] [--jobs <n>]" << std::endl;
+        return 1;
+    }
+
+    fs::path root(argv[1]);
+    std::string packPath;
+    fs::path manifestDir;
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--pack") {
+            packPath = argv[i + 1];
+        } else if (option == "--manifest") {
+            manifestDir = argv[i + 1];
+        } else if (option == "--jobs") {
+            jobs = (unsigned)std::max(1, atoi(argv[i + 1]));
+        } else {
+            std::cerr << "Opcion desconocida: " << option << std::endl;
+            return 1;
+        }
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    AssetCatalog catalog;
+    if (!catalog.Load(root, packPath)) {
+        std::cerr << "Error: No se pudo abrir el pack " << packPath << std::endl;
+        return 1;
+    }
+
+    // Un trabajo por capítulo de cada idioma
+    std::vector<ScriptReport> reports;
+    std::map<std::string, std::set<std::string>> chapters;   // Idioma -> capítulos
+    std::error_code ec;
+    for (const auto& language : fs::directory_iterator(root / "dialogues", ec)) {
+        if (!language.is_directory()) continue;
+        std::string languageName = language.path().filename().string();
+        chapters[languageName];
+        for (const auto& script : fs::directory_iterator(language.path(), ec)) {
+            if (script.is_regular_file() && script.path().extension() == ".txt") {
+                ScriptReport report;
+                report.path = script.path();
+                report.language = languageName;
+                report.lines = 0;
+                reports.push_back(report);
+                chapters[languageName].insert(script.path().filename().string());
+            }
+        }
+    }
+    if (chapters.empty()) {
+        std::cerr << "Error: No hay idiomas en " << (root / "dialogues").string() << std::endl;
+        return 1;
+    }
+    std::sort(reports.begin(), reports.end(), [](const ScriptReport& a, const ScriptReport& b) {
+        return a.path < b.path;
+    });
+
+    // Reparto dinámico: los capítulos largos no dejan hilos parados
+    jobs = std::min<unsigned>(jobs, (unsigned)std::max<size_t>(1, reports.size()));
+    std::atomic<size_t> nextReport(0);
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < jobs; i++) {
+        workers.emplace_back([&]() {
+            // Sin SceneManager: solo parsea
+            DialogueParser parser(nullptr);
+            size_t index;
+            while ((index = nextReport.fetch_add(1)) < reports.size()) {
+                ValidateScript(parser, catalog, reports[index]);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    // Destinos de saltos y opciones: capítulo del mismo idioma y etiqueta definida
+    std::map<std::pair<std::string, std::string>, const ScriptReport*> chapterReports;
+    for (const ScriptReport& report : reports) {
+        chapterReports[{ report.language, report.path.filename().string() }] = &report;
+    }
+    for (ScriptReport& report : reports) {
+        for (const BranchReference& branch : report.branches) {
+            const ScriptReport* target = &report;
+            if (!branch.chapter.empty()) {
+                auto found = chapterReports.find({ report.language, branch.chapter });
+                if (found == chapterReports.end()) {
+                    Report(report, branch.line, branch.column, Severity::ERROR,
+                           "Falta el capitulo '" + branch.chapter + "' (dialogues/" +
+                           report.language + ")");
+                    continue;
+                }
+                target = found->second;
+            }
+            if (!branch.label.empty() && target->labels.count(branch.label) == 0) {
+                Report(report, branch.line, branch.column, Severity::ERROR,
+                       "Etiqueta no definida '" + branch.label + "'" +
+                       (branch.chapter.empty() ? std::string() : " en " + branch.chapter));
+            }
+        }
+    }
+
+    size_t errors = 0;
+    size_t warnings = 0;
+    size_t totalLines = 0;
+    std::map<std::string, std::set<AssetReference>> manifests;
+    for (ScriptReport& report : reports) {
+        totalLines += report.lines;
+        std::stable_sort(report.diagnostics.begin(), report.diagnostics.end(),
+                         [](const Diagnostic& a, const Diagnostic& b) { return a.line < b.line; });
+        for (const Diagnostic& diagnostic : report.diagnostics) {
+            bool isError = diagnostic.severity == Severity::ERROR;
+            (isError ? errors : warnings)++;
+            std::cout << report.path.string() << ":" << diagnostic.line << ":" << diagnostic.column
+                      << ": " << (isError ? "error" : "aviso") << ": " << diagnostic.message << "\n";
+        }
+        manifests[report.language].insert(report.assets.begin(), report.assets.end());
+    }
+
+    // Todos los idiomas deben tener los mismos capítulos
+    std::set<std::string> allChapters;
+    for (const auto& language : chapters) {
+        allChapters.insert(language.second.begin(), language.second.end());
+    }
+    for (const auto& language : chapters) {
+        for (const std::string& chapter : allChapters) {
+            if (language.second.count(chapter) == 0) {
+                warnings++;
+                std::cout << (root / "dialogues" / language.first).string()
+                          << ": aviso: Falta " << chapter << " (existe en otro idioma)\n";
+            }
+        }
+    }
+
+    if (!manifestDir.empty()) {
+        fs::create_directories(manifestDir, ec);
+        for (const auto& language : chapters) {
+            if (!WriteManifest(manifestDir / (language.first + ".manifest"), language.first,
+                               manifests[language.first])) {
+                errors++;
+            }
+        }
+    }
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - startTime).count();
+    std::cout << reports.size() << " capitulos en " << chapters.size() << " idiomas, "
+              << totalLines << " lineas: " << errors << " errores, " << warnings << " avisos ("
+              << jobs << " hilos, " << (int)elapsedMs << " ms)" << std::endl;
+
+    return errors == 0 ? 0 : 1;
+}